@@ -0,0 +1,510 @@
+#pragma once
+#include "bits.h"
+#include "simd.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+namespace detail {
+
+enum class BitOp {
+    AND,
+    OR,
+    XOR,
+};
+
+namespace scalar {
+
+inline size_t CountBits(const uint64_t* words, size_t count) noexcept
+{
+    size_t bits = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        bits += PopCount(words[i]);
+    }
+    return bits;
+}
+
+// Число единиц в первых num_bits битах
+inline size_t CountBitsBefore(const uint64_t* words, size_t num_bits) noexcept
+{
+    const size_t full_words = num_bits / 64;
+    size_t bits = CountBits(words, full_words);
+    if (const size_t offset = num_bits % 64)
+    {
+        bits += PopCount(words[full_words] & ~(~uint64_t{0} << offset));
+    }
+    return bits;
+}
+
+// Номер слова с единицей номер rank (с нуля). rank уменьшается на число единиц
+// в предыдущих словах. Такая единица должна существовать
+inline size_t FindWordOfOne(const uint64_t* words, size_t& rank) noexcept
+{
+    for (size_t i = 0;; ++i)
+    {
+        const size_t ones = PopCount(words[i]);
+        if (rank < ones)
+        {
+            return i;
+        }
+        rank -= ones;
+    }
+}
+
+template <BitOp OP>
+void CombineBits(uint64_t* dst, const uint64_t* src, size_t count) noexcept
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        dst[i] = OP == BitOp::AND ? dst[i] & src[i] : OP == BitOp::OR ? dst[i] | src[i] : dst[i] ^ src[i];
+    }
+}
+
+}  // namespace scalar
+
+#if VECTOR_SIMD_X86
+// Те же циклы, собранные с инструкцией popcnt: встроенные в них функции scalar
+// компилируются под цель вызывающей функции
+namespace popcnt {
+
+VECTOR_TARGET_POPCNT inline size_t CountBits(const uint64_t* words, size_t count) noexcept
+{
+    return scalar::CountBits(words, count);
+}
+
+VECTOR_TARGET_POPCNT inline size_t CountBitsBefore(const uint64_t* words, size_t num_bits) noexcept
+{
+    return scalar::CountBitsBefore(words, num_bits);
+}
+
+VECTOR_TARGET_POPCNT inline size_t FindWordOfOne(const uint64_t* words, size_t& rank) noexcept
+{
+    return scalar::FindWordOfOne(words, rank);
+}
+
+}  // namespace popcnt
+
+namespace avx2 {
+
+// Подсчёт битов по тетрадам через таблицу в регистре (pshufb), суммы байтов - через psadbw
+VECTOR_TARGET_AVX2 inline size_t CountBits(const uint64_t* words, size_t count) noexcept
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0F);
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+        const __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(chunk, low_mask));
+        const __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(chunk, 4), low_mask));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+    }
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + scalar::CountBits(words + i, count - i);
+}
+
+template <BitOp OP>
+VECTOR_TARGET_AVX2 void CombineBits(uint64_t* dst, const uint64_t* src, size_t count) noexcept
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m256i lhs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        const __m256i rhs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i result = OP == BitOp::AND ? _mm256_and_si256(lhs, rhs)
+            : OP == BitOp::OR                   ? _mm256_or_si256(lhs, rhs)
+                                                : _mm256_xor_si256(lhs, rhs);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), result);
+    }
+    scalar::CombineBits<OP>(dst + i, src + i, count - i);
+}
+
+}  // namespace avx2
+#endif
+
+inline size_t CountBits(const uint64_t* words, size_t count, SimdLevel level) noexcept
+{
+#if VECTOR_SIMD_X86
+    if (ClampSimdLevel(level) == SimdLevel::AVX2)
+    {
+        return avx2::CountBits(words, count);
+    }
+    if (DetectPopCount())
+    {
+        return popcnt::CountBits(words, count);
+    }
+#endif
+    (void)level;
+    return scalar::CountBits(words, count);
+}
+
+inline size_t CountBitsBefore(const uint64_t* words, size_t num_bits) noexcept
+{
+#if VECTOR_SIMD_X86
+    if (DetectPopCount())
+    {
+        return popcnt::CountBitsBefore(words, num_bits);
+    }
+#endif
+    return scalar::CountBitsBefore(words, num_bits);
+}
+
+inline size_t FindWordOfOne(const uint64_t* words, size_t& rank) noexcept
+{
+#if VECTOR_SIMD_X86
+    if (DetectPopCount())
+    {
+        return popcnt::FindWordOfOne(words, rank);
+    }
+#endif
+    return scalar::FindWordOfOne(words, rank);
+}
+
+template <BitOp OP>
+void CombineBits(uint64_t* dst, const uint64_t* src, size_t count, SimdLevel level) noexcept
+{
+#if VECTOR_SIMD_X86
+    if (ClampSimdLevel(level) == SimdLevel::AVX2)
+    {
+        avx2::CombineBits<OP>(dst, src, count);
+        return;
+    }
+#endif
+    (void)level;
+    scalar::CombineBits<OP>(dst, src, count);
+}
+
+}  // namespace detail
+
+// Вектор битов, упакованных по 64 в слово RawMemory<uint64_t>. Растёт и владеет памятью
+// так же, как Vector. Биты последнего слова за пределами Size() всегда нулевые, поэтому
+// подсчёт и поиск работают целыми словами
+class BitVector {
+public:
+    static constexpr size_t BITS_PER_WORD = 64;
+
+    BitVector() = default;
+
+    explicit BitVector(size_t size, bool value = false)
+        : words_(WordCount(size))
+        , size_(size)
+    {
+        std::fill_n(words_.GetAddress(), WordCount(size), value ? ~uint64_t{0} : 0);
+        ClearTail();
+    }
+
+    BitVector(const BitVector& other)
+        : words_(WordCount(other.size_))
+        , size_(other.size_)
+    {
+        CopyWords(other.words_.GetAddress(), WordCount(size_), words_.GetAddress());
+    }
+
+    BitVector(BitVector&& other) noexcept
+    {
+        Swap(other);
+    }
+
+    BitVector& operator=(const BitVector& rhs)
+    {
+        if (this != &rhs)
+        {
+            if (WordCount(rhs.size_) <= words_.Capacity())
+            {
+                CopyWords(rhs.words_.GetAddress(), WordCount(rhs.size_), words_.GetAddress());
+                size_ = rhs.size_;
+            }
+            else
+            {
+                BitVector rhs_copy(rhs);
+                Swap(rhs_copy);
+            }
+        }
+        return *this;
+    }
+
+    BitVector& operator=(BitVector&& rhs) noexcept
+    {
+        Swap(rhs);
+        return *this;
+    }
+
+    void Swap(BitVector& other) noexcept
+    {
+        words_.Swap(other.words_);
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    bool Empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    // Ёмкость в битах
+    size_t Capacity() const noexcept
+    {
+        return words_.Capacity() * BITS_PER_WORD;
+    }
+
+    // Число слов, занятых битами
+    size_t WordCount() const noexcept
+    {
+        return WordCount(size_);
+    }
+
+    const uint64_t* Data() const noexcept
+    {
+        return words_.GetAddress();
+    }
+
+    void Reserve(size_t new_capacity)
+    {
+        if (WordCount(new_capacity) > words_.Capacity())
+        {
+            Reallocate(WordCount(new_capacity));
+        }
+    }
+
+    void Resize(size_t new_size, bool value = false)
+    {
+        if (new_size > size_)
+        {
+            Reserve(new_size);
+            const size_t old_words = WordCount(size_);
+            const size_t new_words = WordCount(new_size);
+            const uint64_t fill = value ? ~uint64_t{0} : 0;
+            if (value && size_ % BITS_PER_WORD != 0)
+            {
+                words_[old_words - 1] |= fill << (size_ % BITS_PER_WORD);
+            }
+            std::fill(words_ + old_words, words_ + new_words, fill);
+        }
+        size_ = new_size;
+        ClearTail();
+    }
+
+    void PushBack(bool value)
+    {
+        if (size_ == Capacity())
+        {
+            Reallocate(words_.Capacity() ? words_.Capacity() * 2 : 1);
+        }
+        if (size_ % BITS_PER_WORD == 0)
+        {
+            words_[size_ / BITS_PER_WORD] = 0;
+        }
+        words_[size_ / BITS_PER_WORD] |= uint64_t{value} << (size_ % BITS_PER_WORD);
+        ++size_;
+    }
+
+    void PopBack() noexcept
+    {
+        assert(size_ > 0);
+        --size_;
+        ClearTail();
+    }
+
+    bool Test(size_t index) const noexcept
+    {
+        assert(index < size_);
+        return (words_[index / BITS_PER_WORD] >> (index % BITS_PER_WORD)) & 1;
+    }
+
+    void Set(size_t index, bool value = true) noexcept
+    {
+        assert(index < size_);
+        uint64_t& word = words_[index / BITS_PER_WORD];
+        const uint64_t mask = uint64_t{1} << (index % BITS_PER_WORD);
+        word = value ? word | mask : word & ~mask;
+    }
+
+    void Reset(size_t index) noexcept
+    {
+        Set(index, false);
+    }
+
+    // Число установленных битов
+    size_t Count(SimdLevel level = DetectSimdLevel()) const noexcept
+    {
+        return detail::CountBits(words_.GetAddress(), WordCount(), level);
+    }
+
+    // Позиция первого установленного бита или Size(), если таких нет
+    size_t FindFirst() const noexcept
+    {
+        return FindFromWord(0);
+    }
+
+    // Позиция первого установленного бита после position или Size()
+    size_t FindNext(size_t position) const noexcept
+    {
+        const size_t next = position + 1;
+        if (next >= size_)
+        {
+            return size_;
+        }
+        const size_t word_index = next / BITS_PER_WORD;
+        const uint64_t word = words_[word_index] & (~uint64_t{0} << (next % BITS_PER_WORD));
+        if (word != 0)
+        {
+            return word_index * BITS_PER_WORD + detail::CountTrailingZeros(word);
+        }
+        return FindFromWord(word_index + 1);
+    }
+
+    // Поразрядные операции с вектором того же размера
+    BitVector& And(const BitVector& other, SimdLevel level = DetectSimdLevel()) noexcept
+    {
+        return Combine<detail::BitOp::AND>(other, level);
+    }
+
+    BitVector& Or(const BitVector& other, SimdLevel level = DetectSimdLevel()) noexcept
+    {
+        return Combine<detail::BitOp::OR>(other, level);
+    }
+
+    BitVector& Xor(const BitVector& other, SimdLevel level = DetectSimdLevel()) noexcept
+    {
+        return Combine<detail::BitOp::XOR>(other, level);
+    }
+
+private:
+    static size_t WordCount(size_t bits) noexcept
+    {
+        return (bits + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    }
+
+    static void CopyWords(const uint64_t* src, size_t count, uint64_t* dst) noexcept
+    {
+        if (count > 0)
+        {
+            std::memcpy(dst, src, count * sizeof(uint64_t));
+        }
+    }
+
+    void Reallocate(size_t new_word_capacity)
+    {
+        RawMemory<uint64_t> new_words(new_word_capacity);
+        CopyWords(words_.GetAddress(), WordCount(), new_words.GetAddress());
+        words_.Swap(new_words);
+    }
+
+    // Обнуляет биты последнего слова за пределами размера
+    void ClearTail() noexcept
+    {
+        if (size_ % BITS_PER_WORD != 0)
+        {
+            words_[size_ / BITS_PER_WORD] &= ~(~uint64_t{0} << (size_ % BITS_PER_WORD));
+        }
+    }
+
+    size_t FindFromWord(size_t word_index) const noexcept
+    {
+        const size_t word_count = WordCount();
+        for (; word_index < word_count; ++word_index)
+        {
+            if (words_[word_index] != 0)
+            {
+                return word_index * BITS_PER_WORD + detail::CountTrailingZeros(words_[word_index]);
+            }
+        }
+        return size_;
+    }
+
+    template <detail::BitOp OP>
+    BitVector& Combine(const BitVector& other, SimdLevel level) noexcept
+    {
+        assert(size_ == other.size_);
+        detail::CombineBits<OP>(words_.GetAddress(), other.words_.GetAddress(), WordCount(), level);
+        return *this;
+    }
+
+    RawMemory<uint64_t> words_;
+    size_t size_ = 0;
+};
+
+// Индекс для Rank и Select над BitVector: число единиц перед каждым блоком из 512 битов
+// и номер блока для каждой SELECT_SAMPLE-й единицы. Занимает около 1/8 объёма вектора
+// и становится недействительным при его изменении
+class BitRankSelect {
+public:
+    explicit BitRankSelect(const BitVector& bits)
+        : bits_(&bits)
+        , ranks_((bits.WordCount() + WORDS_PER_BLOCK - 1) / WORDS_PER_BLOCK + 1)
+    {
+        const uint64_t* words = bits.Data();
+        uint64_t ones = 0;
+        for (size_t block = 0; block + 1 < ranks_.Size(); ++block)
+        {
+            ranks_[block] = ones;
+            const size_t begin = block * WORDS_PER_BLOCK;
+            const size_t end = std::min(bits.WordCount(), begin + WORDS_PER_BLOCK);
+            ones += detail::CountBits(words + begin, end - begin, SimdLevel::SSE2);
+        }
+        ranks_[ranks_.Size() - 1] = ones;
+
+        // Блок, в котором лежит каждая SELECT_SAMPLE-я единица, сужает двоичный поиск в Select
+        select_samples_.Reserve(ones / SELECT_SAMPLE + 2);
+        for (size_t block = 0; block + 1 < ranks_.Size(); ++block)
+        {
+            while (select_samples_.Size() * SELECT_SAMPLE < ranks_[block + 1])
+            {
+                select_samples_.PushBack(block);
+            }
+        }
+        select_samples_.PushBack(ranks_.Size() - 2);
+    }
+
+    // Число единиц во всём векторе
+    size_t CountOnes() const noexcept
+    {
+        return ranks_[ranks_.Size() - 1];
+    }
+
+    // Число единиц в позициях [0, position)
+    size_t Rank(size_t position) const noexcept
+    {
+        assert(position <= bits_->Size());
+        const size_t block = position / BitVector::BITS_PER_WORD / WORDS_PER_BLOCK;
+        const size_t block_begin = block * WORDS_PER_BLOCK * BitVector::BITS_PER_WORD;
+        return ranks_[block] + detail::CountBitsBefore(bits_->Data() + block * WORDS_PER_BLOCK, position - block_begin);
+    }
+
+    // Позиция единицы с номером rank (с нуля) или Size(), если единиц меньше
+    size_t Select(size_t rank) const noexcept
+    {
+        if (rank >= CountOnes())
+        {
+            return bits_->Size();
+        }
+        // Последний блок, перед которым не больше rank единиц
+        const uint64_t* first = ranks_.begin() + select_samples_[rank / SELECT_SAMPLE];
+        const uint64_t* last = ranks_.begin() + select_samples_[rank / SELECT_SAMPLE + 1] + 1;
+        const size_t block = static_cast<size_t>(std::upper_bound(first, last, rank) - ranks_.begin()) - 1;
+        size_t remaining = rank - ranks_[block];
+        const uint64_t* words = bits_->Data();
+        const size_t word_index = block * WORDS_PER_BLOCK + detail::FindWordOfOne(words + block * WORDS_PER_BLOCK, remaining);
+        return word_index * BitVector::BITS_PER_WORD
+            + detail::SelectInWord(words[word_index], static_cast<unsigned>(remaining));
+    }
+
+private:
+    static constexpr size_t WORDS_PER_BLOCK = 8;
+    static constexpr size_t SELECT_SAMPLE = 4096;
+
+    const BitVector* bits_;
+    Vector<uint64_t> ranks_;
+    Vector<size_t> select_samples_;
+};
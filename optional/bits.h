@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace detail {
+
+// Номер младшего установленного бита. word не должен быть нулевым
+inline unsigned CountTrailingZeros(uint64_t word) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+// Число установленных битов
+inline unsigned PopCount(uint64_t word) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return static_cast<unsigned>(__popcnt64(word));
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+// Число значащих битов: 0 для нуля, иначе номер старшего установленного бита плюс один
+inline unsigned BitWidth(uint64_t word) noexcept
+{
+    if (word == 0)
+    {
+        return 0;
+    }
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse64(&index, word);
+    return index + 1;
+#else
+    return 64 - __builtin_clzll(word);
+#endif
+}
+
+// Позиция установленного бита с номером rank (с нуля). В word должно быть больше rank единиц.
+// Накопленные суммы единиц по байтам дают нужный байт без цикла по битам
+inline unsigned SelectInWord(uint64_t word, unsigned rank) noexcept
+{
+    uint64_t counts = word - ((word >> 1) & 0x5555555555555555ull);
+    counts = (counts & 0x3333333333333333ull) + ((counts >> 2) & 0x3333333333333333ull);
+    counts = ((counts + (counts >> 4)) & 0x0F0F0F0F0F0F0F0Full) * 0x0101010101010101ull;
+    unsigned byte = 0;
+    while (((counts >> (byte * 8)) & 0xFF) <= rank)
+    {
+        ++byte;
+    }
+    if (byte > 0)
+    {
+        rank -= static_cast<unsigned>((counts >> ((byte - 1) * 8)) & 0xFF);
+    }
+    uint64_t bits = (word >> (byte * 8)) & 0xFF;
+    for (; rank > 0; --rank)
+    {
+        bits &= bits - 1;
+    }
+    return byte * 8 + CountTrailingZeros(bits);
+}
+
+}  // namespace detail
@@ -0,0 +1,395 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Вектор размером в один указатель. Размер и ёмкость хранятся в заголовке в начале того же
+// блока памяти, что и элементы, а вектор без выделенной памяти хранит nullptr. Подходит для
+// больших массивов коротких, чаще всего пустых последовательностей. Рост и перенос элементов
+// устроены так же, как в Vector
+template <typename T>
+class CompactVector {
+    struct Header {
+        size_t size;
+        size_t capacity;
+    };
+
+public:
+    // Размер заголовка перед элементами с учётом выравнивания T
+    static constexpr size_t HEADER_SIZE = (sizeof(Header) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+private:
+    // Владеет блоком памяти с заголовком. Элементы не конструирует и не разрушает
+    class Buffer {
+    public:
+        Buffer() = default;
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+
+        explicit Buffer(size_t capacity)
+            : data_(Allocate(capacity))
+        {}
+
+        Buffer(Buffer&& other) noexcept
+        {
+            Swap(other);
+        }
+
+        Buffer& operator=(Buffer&& rhs) noexcept
+        {
+            Swap(rhs);
+            return *this;
+        }
+
+        ~Buffer()
+        {
+            Deallocate(data_);
+        }
+
+        void Swap(Buffer& other) noexcept
+        {
+            std::swap(data_, other.data_);
+        }
+
+        T* GetAddress() const noexcept
+        {
+            return data_;
+        }
+
+        size_t Size() const noexcept
+        {
+            return data_ ? GetHeader()->size : 0;
+        }
+
+        void SetSize(size_t size) noexcept
+        {
+            assert(size <= Capacity());
+            if (data_)
+            {
+                GetHeader()->size = size;
+            }
+        }
+
+        size_t Capacity() const noexcept
+        {
+            return data_ ? GetHeader()->capacity : 0;
+        }
+
+    private:
+        static constexpr size_t ALIGNMENT = alignof(T) > alignof(Header) ? alignof(T) : alignof(Header);
+        static constexpr bool OVER_ALIGNED = ALIGNMENT > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+        Header* GetHeader() const noexcept
+        {
+            return std::launder(reinterpret_cast<Header*>(reinterpret_cast<char*>(data_) - HEADER_SIZE));
+        }
+
+        // Выделяет блок под заголовок и capacity элементов и возвращает адрес первого элемента
+        static T* Allocate(size_t capacity)
+        {
+            if (capacity == 0)
+            {
+                return nullptr;
+            }
+            const size_t bytes = HEADER_SIZE + capacity * sizeof(T);
+            void* block = nullptr;
+            if constexpr (OVER_ALIGNED)
+            {
+                block = operator new(bytes, std::align_val_t(ALIGNMENT));
+            }
+            else
+            {
+                block = operator new(bytes);
+            }
+            new (block) Header{0, capacity};
+            return reinterpret_cast<T*>(static_cast<char*>(block) + HEADER_SIZE);
+        }
+
+        static void Deallocate(T* data) noexcept
+        {
+            if (!data)
+            {
+                return;
+            }
+            void* block = reinterpret_cast<char*>(data) - HEADER_SIZE;
+            if constexpr (OVER_ALIGNED)
+            {
+                operator delete(block, std::align_val_t(ALIGNMENT));
+            }
+            else
+            {
+                operator delete(block);
+            }
+        }
+
+        T* data_ = nullptr;
+    };
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    CompactVector() = default;
+
+    explicit CompactVector(size_t size)
+        : data_(size)
+    {
+        std::uninitialized_value_construct_n(data_.GetAddress(), size);
+        data_.SetSize(size);
+    }
+
+    CompactVector(const CompactVector& other)
+        : data_(other.Size())
+    {
+        std::uninitialized_copy_n(other.begin(), other.Size(), data_.GetAddress());
+        data_.SetSize(other.Size());
+    }
+
+    CompactVector(CompactVector&& other) noexcept
+    {
+        Swap(other);
+    }
+
+    ~CompactVector()
+    {
+        std::destroy_n(data_.GetAddress(), Size());
+    }
+
+    CompactVector& operator=(CompactVector&& rhs) noexcept
+    {
+        Swap(rhs);
+        return *this;
+    }
+
+    CompactVector& operator=(const CompactVector& rhs)
+    {
+        if (this != &rhs)
+        {
+            const size_t size = Size();
+            if (rhs.Size() > Capacity())
+            {
+                CompactVector rhs_copy(rhs);
+                Swap(rhs_copy);
+            }
+            else if (rhs.Size() < size)
+            {
+                std::copy_n(rhs.begin(), rhs.Size(), begin());
+                std::destroy_n(begin() + rhs.Size(), size - rhs.Size());
+                data_.SetSize(rhs.Size());
+            }
+            else
+            {
+                std::copy_n(rhs.begin(), size, begin());
+                std::uninitialized_copy_n(rhs.begin() + size, rhs.Size() - size, begin() + size);
+                data_.SetSize(rhs.Size());
+            }
+        }
+        return *this;
+    }
+
+    void Swap(CompactVector& other) noexcept
+    {
+        data_.Swap(other.data_);
+    }
+
+    iterator begin() noexcept
+    {
+        return data_.GetAddress();
+    }
+
+    iterator end() noexcept
+    {
+        return data_.GetAddress() + Size();
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return data_.GetAddress();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return data_.GetAddress() + Size();
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    size_t Size() const noexcept
+    {
+        return data_.Size();
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return data_.Capacity();
+    }
+
+    const T& operator[](size_t index) const noexcept
+    {
+        return const_cast<CompactVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept
+    {
+        assert(index < Size());
+        return data_.GetAddress()[index];
+    }
+
+    void Reserve(size_t new_capacity)
+    {
+        if (new_capacity <= Capacity())
+        {
+            return;
+        }
+        Buffer new_data(new_capacity);
+        Relocate(begin(), Size(), new_data.GetAddress());
+        SwapData(new_data);
+    }
+
+    void Resize(size_t new_size)
+    {
+        const size_t size = Size();
+        if (new_size < size)
+        {
+            std::destroy_n(begin() + new_size, size - new_size);
+        }
+        else
+        {
+            Reserve(new_size);
+            std::uninitialized_value_construct_n(begin() + size, new_size - size);
+        }
+        data_.SetSize(new_size);
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args)
+    {
+        const size_t size = Size();
+        const size_t shift = pos - cbegin();
+        assert(shift <= size);
+        if (size < Capacity())
+        {
+            iterator p = begin() + shift;
+            if (shift == size)
+            {
+                new (p) T(std::forward<Args>(args)...);
+            }
+            else
+            {
+                T tmp(std::forward<Args>(args)...);
+                new (end()) T(std::move(*(end() - 1)));
+                std::move_backward(p, end() - 1, end());
+                *p = std::move(tmp);
+            }
+        }
+        else
+        {
+            // Новый элемент конструируется до переноса старых, так как аргументы могут на них ссылаться
+            Buffer new_data(size ? size * 2 : 1);
+            T* inserted = new (new_data.GetAddress() + shift) T(std::forward<Args>(args)...);
+            try
+            {
+                Relocate(begin(), shift, new_data.GetAddress());
+            }
+            catch (...)
+            {
+                std::destroy_at(inserted);
+                throw;
+            }
+            try
+            {
+                Relocate(begin() + shift, size - shift, inserted + 1);
+            }
+            catch (...)
+            {
+                std::destroy_n(new_data.GetAddress(), shift + 1);
+                throw;
+            }
+            SwapData(new_data);
+        }
+        data_.SetSize(size + 1);
+        return begin() + shift;
+    }
+
+    iterator Insert(const_iterator pos, const T& value)
+    {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value)
+    {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Erase(const_iterator pos)
+    {
+        const size_t shift = pos - cbegin();
+        assert(shift < Size());
+        iterator p = begin() + shift;
+        std::move(p + 1, end(), p);
+        std::destroy_at(end() - 1);
+        data_.SetSize(Size() - 1);
+        return p;
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args)
+    {
+        return *Emplace(cend(), std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T& value)
+    {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value)
+    {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept
+    {
+        assert(Size() > 0);
+        std::destroy_at(end() - 1);
+        data_.SetSize(Size() - 1);
+    }
+
+private:
+    // Переносит count элементов в неинициализированную память. Копирование вместо
+    // перемещения - только если перемещение может бросить, а копирование доступно
+    static void Relocate(T* from, size_t count, T* to)
+    {
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+        {
+            std::uninitialized_move_n(from, count, to);
+        }
+        else
+        {
+            std::uninitialized_copy_n(from, count, to);
+        }
+    }
+
+    // Принимает новый буфер с уже перенесёнными элементами и разрушает старые
+    void SwapData(Buffer& new_data) noexcept
+    {
+        const size_t size = Size();
+        std::destroy_n(begin(), size);
+        data_.Swap(new_data);
+        data_.SetSize(size);
+    }
+
+    Buffer data_;
+};
@@ -0,0 +1,250 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <cassert>
+#include <utility>
+
+// Вектор с копированием при записи. Копии CowVector разделяют один буфер со счётчиком
+// ссылок, и копирование стоит одного атомарного инкремента. Первая изменяющая операция
+// над разделяемым буфером копирует его, после чего копия принадлежит только этому вектору.
+// Счётчик атомарный, поэтому копии можно передавать в другие потоки. Сам CowVector, как и
+// Vector, нельзя одновременно изменять из нескольких потоков.
+// Неконстантные operator[], begin(), end() и вставки выдают ссылки в буфер, через которые
+// его можно изменить и позже. Поэтому такой буфер больше не разделяется: следующее копирование
+// копирует элементы. Для чтения без этого используйте константный доступ: std::as_const, cbegin()
+// и cend()
+template <typename T>
+class CowVector {
+    struct Shared {
+        Shared() = default;
+
+        explicit Shared(Vector<T> values)
+            : values(std::move(values))
+        {}
+
+        std::atomic<size_t> refs = 1;
+        // Выдана неконстантная ссылка или итератор. Меняется только единственным владельцем
+        bool unshareable = false;
+        Vector<T> values;
+    };
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    CowVector() = default;
+
+    explicit CowVector(Vector<T> values)
+        : shared_(new Shared(std::move(values)))
+    {}
+
+    CowVector(const CowVector& other)
+    {
+        if (!other.shared_)
+        {
+            return;
+        }
+        if (other.shared_->unshareable)
+        {
+            shared_ = new Shared(other.shared_->values);
+        }
+        else
+        {
+            shared_ = other.shared_;
+            shared_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    CowVector(CowVector&& other) noexcept
+    {
+        Swap(other);
+    }
+
+    CowVector& operator=(const CowVector& rhs)
+    {
+        CowVector rhs_copy(rhs);
+        Swap(rhs_copy);
+        return *this;
+    }
+
+    CowVector& operator=(CowVector&& rhs) noexcept
+    {
+        Swap(rhs);
+        return *this;
+    }
+
+    ~CowVector()
+    {
+        Release();
+    }
+
+    void Swap(CowVector& other) noexcept
+    {
+        std::swap(shared_, other.shared_);
+    }
+
+    size_t Size() const noexcept
+    {
+        return shared_ ? shared_->values.Size() : 0;
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return shared_ ? shared_->values.Capacity() : 0;
+    }
+
+    // Число CowVector, разделяющих буфер
+    size_t UseCount() const noexcept
+    {
+        return shared_ ? shared_->refs.load(std::memory_order_relaxed) : 0;
+    }
+
+    const T& operator[](size_t index) const noexcept
+    {
+        assert(index < Size());
+        return shared_->values[index];
+    }
+
+    // Неконстантный доступ отделяет буфер от других копий и запрещает его разделять
+    T& operator[](size_t index)
+    {
+        assert(index < Size());
+        return DetachMutable(Size())[index];
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return shared_ ? shared_->values.begin() : nullptr;
+    }
+
+    const_iterator end() const noexcept
+    {
+        return shared_ ? shared_->values.end() : nullptr;
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    // Обход только для чтения не должен вызывать эти перегрузки: for (const T& x : std::as_const(v))
+    iterator begin()
+    {
+        return shared_ ? DetachMutable(Size()).begin() : nullptr;
+    }
+
+    iterator end()
+    {
+        return shared_ ? DetachMutable(Size()).end() : nullptr;
+    }
+
+    void Reserve(size_t capacity)
+    {
+        Detach(capacity).Reserve(capacity);
+    }
+
+    void Resize(size_t new_size)
+    {
+        Detach(new_size).Resize(new_size);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args)
+    {
+        // Копия буфера сразу получает место под новый элемент. Аргументы могут ссылаться
+        // на элементы старого буфера, который остаётся жив у других копий
+        return DetachMutable(Size() + 1).EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    // В отличие от EmplaceBack, ссылку не выдаёт и разделение буфера не запрещает
+    void PushBack(const T& value)
+    {
+        Detach(Size() + 1).EmplaceBack(value);
+    }
+
+    void PushBack(T&& value)
+    {
+        Detach(Size() + 1).EmplaceBack(std::move(value));
+    }
+
+    void PopBack()
+    {
+        assert(Size() > 0);
+        Detach(Size()).PopBack();
+    }
+
+    // Позиция pos может указывать в разделяемый буфер, поэтому сначала вычисляется индекс
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args)
+    {
+        const size_t index = pos - cbegin();
+        Vector<T>& values = DetachMutable(Size() + 1);
+        return values.Emplace(values.cbegin() + index, std::forward<Args>(args)...);
+    }
+
+    iterator Insert(const_iterator pos, const T& value)
+    {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value)
+    {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Erase(const_iterator pos)
+    {
+        const size_t index = pos - cbegin();
+        assert(index < Size());
+        Vector<T>& values = DetachMutable(Size());
+        return values.Erase(values.cbegin() + index);
+    }
+
+private:
+    // Делает буфер единоличным и возвращает его. Копия получает ёмкость не меньше capacity
+    Vector<T>& Detach(size_t capacity)
+    {
+        if (!shared_)
+        {
+            shared_ = new Shared();
+        }
+        else if (shared_->refs.load(std::memory_order_acquire) != 1)
+        {
+            Vector<T> values;
+            values.Reserve(capacity > Size() ? capacity : Size());
+            for (const T& value : shared_->values)
+            {
+                values.PushBack(value);
+            }
+            Shared* unique = new Shared(std::move(values));
+            Release();
+            shared_ = unique;
+        }
+        return shared_->values;
+    }
+
+    // Detach для операций, которые выдают наружу неконстантную ссылку или итератор
+    Vector<T>& DetachMutable(size_t capacity)
+    {
+        Vector<T>& values = Detach(capacity);
+        shared_->unshareable = true;
+        return values;
+    }
+
+    void Release() noexcept
+    {
+        if (shared_ && shared_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            delete shared_;
+        }
+        shared_ = nullptr;
+    }
+
+    Shared* shared_ = nullptr;
+};
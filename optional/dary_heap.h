@@ -0,0 +1,358 @@
+#pragma once
+#include "optional.h"
+#include "vector.h"
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Номер элемента в индексированной куче. Действителен, пока элемент в куче
+using HeapHandle = uint32_t;
+
+// Очередь с приоритетом на D-арной куче в Vector. Вершина - наименьший элемент
+// в смысле Compare. Высота кучи в log2(D) раз меньше, чем у двоичной.
+// Буфер выровнен по строке кэша, а вершина сдвинута от его начала на D - 1 элементов,
+// поэтому потомки каждого узла начинаются с адреса, кратного D * sizeof(T). Если это
+// произведение делит CACHE_LINE_SIZE, как у D = 4 или 8 для 8-байтовых T, все потомки
+// узла лежат в одной строке кэша. Копия кучи получает выровненный буфер при росте.
+// При INDEXED = true куча поддерживает карту позиций элементов: Push возвращает
+// HeapHandle, по которому работает DecreaseKey
+template <typename T, size_t D = 4, typename Compare = std::less<T>, bool INDEXED = false>
+class DaryHeap {
+    static_assert(D >= 2, "DaryHeap requires at least two children per node");
+    static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>,
+                  "DaryHeap moves elements through a hole and requires nothrow moves");
+
+public:
+    DaryHeap() = default;
+
+    explicit DaryHeap(Compare less)
+        : less_(std::move(less))
+    {}
+
+    explicit DaryHeap(Vector<T> items, Compare less = Compare())
+        : less_(std::move(less))
+    {
+        Heapify(std::move(items));
+    }
+
+    size_t Size() const noexcept
+    {
+        return values_.Size();
+    }
+
+    bool Empty() const noexcept
+    {
+        return values_.Size() == 0;
+    }
+
+    void Reserve(size_t capacity)
+    {
+        if (capacity > values_.Capacity())
+        {
+            Reallocate(capacity);
+        }
+        if constexpr (INDEXED)
+        {
+            handles_.Reserve(capacity);
+        }
+    }
+
+    // Указатель на вершину или nullptr, если куча пуста
+    const T* Top() const noexcept
+    {
+        return Empty() ? nullptr : values_.begin();
+    }
+
+    // Заменяет содержимое кучи элементами items за O(n). В индексированной куче
+    // элемент items[i] получает HeapHandle, равный i
+    void Heapify(Vector<T> items)
+    {
+        Vector<T> values = AllocateValues(items.Size());
+        for (T& item : items)
+        {
+            values.PushBack(std::move(item));
+        }
+        if constexpr (INDEXED)
+        {
+            assert(items.Size() < NO_HANDLE);
+            Vector<HeapHandle> handles(items.Size());
+            for (size_t i = 0; i < items.Size(); ++i)
+            {
+                handles[i] = static_cast<HeapHandle>(i);
+            }
+            Vector<uint32_t> positions(handles);
+            handles_.Swap(handles);
+            positions_.Swap(positions);
+            free_head_ = NO_HANDLE;
+        }
+        values_.Swap(values);
+        // Просеивание вниз всех внутренних узлов, начиная с последнего
+        for (size_t i = values_.Size() > 1 ? (values_.Size() - 2) / D + 1 : 0; i-- > 0;)
+        {
+            SiftDown(i, std::move(values_[i]), HandleAt(i));
+        }
+    }
+
+    // В индексированной куче возвращает HeapHandle нового элемента
+    auto Push(T value)
+    {
+        if (values_.Size() == values_.Capacity())
+        {
+            Reallocate(values_.Size() > D ? values_.Size() * 2 : 2 * D);
+        }
+        HeapHandle handle = 0;
+        if constexpr (INDEXED)
+        {
+            handle = AcquireHandle();
+            try
+            {
+                handles_.PushBack(handle);
+            }
+            catch (...)
+            {
+                ReleaseHandle(handle);
+                throw;
+            }
+            try
+            {
+                values_.PushBack(std::move(value));
+            }
+            catch (...)
+            {
+                handles_.PopBack();
+                ReleaseHandle(handle);
+                throw;
+            }
+        }
+        else
+        {
+            values_.PushBack(std::move(value));
+        }
+        const size_t last = values_.Size() - 1;
+        SiftUp(last, std::move(values_[last]), handle);
+        if constexpr (INDEXED)
+        {
+            return handle;
+        }
+    }
+
+    // Извлекает вершину. Для пустой кучи возвращает пустой Optional
+    Optional<T> Pop()
+    {
+        if (Empty())
+        {
+            return {};
+        }
+        Optional<T> top(std::move(values_[0]));
+        if constexpr (INDEXED)
+        {
+            ReleaseHandle(handles_[0]);
+        }
+        // Последний элемент занимает место вершины. Он обычно принадлежит нижним уровням,
+        // поэтому в двоичной куче дырка сначала спускается до листа без сравнений с ним.
+        // При D > 2 лишние сравнения потомков на каждом уровне обходятся дороже
+        const size_t last = values_.Size() - 1;
+        T last_value(std::move(values_[last]));
+        const HeapHandle last_handle = HandleAt(last);
+        values_.PopBack();
+        if constexpr (INDEXED)
+        {
+            handles_.PopBack();
+        }
+        if (last == 0)
+        {
+            return top;
+        }
+        if constexpr (D == 2)
+        {
+            SiftUp(MoveHoleToLeaf(0), std::move(last_value), last_handle);
+        }
+        else
+        {
+            SiftDown(0, std::move(last_value), last_handle);
+        }
+        return top;
+    }
+
+    bool Contains(HeapHandle handle) const noexcept
+    {
+        static_assert(INDEXED, "Contains requires an indexed DaryHeap");
+        return handle < positions_.Size() && positions_[handle] < handles_.Size()
+            && handles_[positions_[handle]] == handle;
+    }
+
+    // Значение элемента по HeapHandle
+    const T& Get(HeapHandle handle) const noexcept
+    {
+        static_assert(INDEXED, "Get requires an indexed DaryHeap");
+        assert(Contains(handle));
+        return values_[positions_[handle]];
+    }
+
+    // Заменяет значение элемента на не большее в смысле Compare и поднимает его к вершине
+    void DecreaseKey(HeapHandle handle, T value)
+    {
+        static_assert(INDEXED, "DecreaseKey requires an indexed DaryHeap");
+        assert(Contains(handle));
+        const size_t position = positions_[handle];
+        assert(!less_(values_[position], value));
+        SiftUp(position, std::move(value), handle);
+    }
+
+private:
+    static constexpr uint32_t NO_HANDLE = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t ROOT_OFFSET = D - 1;
+    static constexpr size_t VALUES_ALIGNMENT = alignof(T) > CACHE_LINE_SIZE ? alignof(T) : CACHE_LINE_SIZE;
+
+    // Пустой вектор на capacity элементов в выровненном буфере со сдвинутой вершиной
+    static Vector<T> AllocateValues(size_t capacity)
+    {
+        if (capacity == 0)
+        {
+            return {};
+        }
+        void* memory = operator new((capacity + ROOT_OFFSET) * sizeof(T), std::align_val_t(VALUES_ALIGNMENT));
+        try
+        {
+            return Vector<T>::Adopt(static_cast<T*>(memory) + ROOT_OFFSET, 0, capacity, &FreeValues);
+        }
+        catch (...)
+        {
+            operator delete(memory, std::align_val_t(VALUES_ALIGNMENT));
+            throw;
+        }
+    }
+
+    static void FreeValues(void* buffer, void*) noexcept
+    {
+        operator delete(static_cast<T*>(buffer) - ROOT_OFFSET, std::align_val_t(VALUES_ALIGNMENT));
+    }
+
+    // Переносит элементы в новый буфер. Сам Vector при росте выравнивание не сохранил бы
+    void Reallocate(size_t capacity)
+    {
+        Vector<T> values = AllocateValues(capacity);
+        for (T& value : values_)
+        {
+            values.PushBack(std::move(value));
+        }
+        values_.Swap(values);
+    }
+
+    HeapHandle HandleAt(size_t position) const noexcept
+    {
+        if constexpr (INDEXED)
+        {
+            return handles_[position];
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    // Кладёт значение в позицию-дырку и обновляет карту позиций
+    void Place(size_t position, T&& value, HeapHandle handle) noexcept
+    {
+        values_[position] = std::move(value);
+        if constexpr (INDEXED)
+        {
+            handles_[position] = handle;
+            positions_[handle] = static_cast<uint32_t>(position);
+        }
+    }
+
+    // Дырка в позиции hole поднимается, пока родитель больше value
+    void SiftUp(size_t hole, T value, HeapHandle handle)
+    {
+        while (hole > 0)
+        {
+            const size_t parent = (hole - 1) / D;
+            if (!less_(value, values_[parent]))
+            {
+                break;
+            }
+            Place(hole, std::move(values_[parent]), HandleAt(parent));
+            hole = parent;
+        }
+        Place(hole, std::move(value), handle);
+    }
+
+    // Наименьший потомок узла или size, если узел - лист
+    size_t BestChild(size_t position, size_t size) const
+    {
+        const size_t first = position * D + 1;
+        if (first >= size)
+        {
+            return size;
+        }
+        const size_t last = first + D < size ? first + D : size;
+        size_t best = first;
+        for (size_t child = first + 1; child < last; ++child)
+        {
+            best = less_(values_[child], values_[best]) ? child : best;
+        }
+        return best;
+    }
+
+    // Спускает дырку до листа, каждый раз поднимая наименьшего потомка
+    size_t MoveHoleToLeaf(size_t hole)
+    {
+        const size_t size = values_.Size();
+        for (size_t best = BestChild(hole, size); best != size; best = BestChild(hole, size))
+        {
+            Place(hole, std::move(values_[best]), HandleAt(best));
+            hole = best;
+        }
+        return hole;
+    }
+
+    // Дырка в позиции hole опускается, пока наименьший потомок меньше value
+    void SiftDown(size_t hole, T value, HeapHandle handle)
+    {
+        const size_t size = values_.Size();
+        for (;;)
+        {
+            const size_t best = BestChild(hole, size);
+            if (best == size || !less_(values_[best], value))
+            {
+                break;
+            }
+            Place(hole, std::move(values_[best]), HandleAt(best));
+            hole = best;
+        }
+        Place(hole, std::move(value), handle);
+    }
+
+    // Свободные HeapHandle связаны в список через positions_
+    HeapHandle AcquireHandle()
+    {
+        if (free_head_ != NO_HANDLE)
+        {
+            const HeapHandle handle = free_head_;
+            free_head_ = positions_[handle];
+            return handle;
+        }
+        assert(positions_.Size() < NO_HANDLE);
+        positions_.PushBack(NO_HANDLE);
+        return static_cast<HeapHandle>(positions_.Size() - 1);
+    }
+
+    void ReleaseHandle(HeapHandle handle) noexcept
+    {
+        positions_[handle] = free_head_;
+        free_head_ = handle;
+    }
+
+    Vector<T> values_;
+    // Только для INDEXED: владелец каждой позиции кучи и позиция каждого HeapHandle
+    Vector<HeapHandle> handles_;
+    Vector<uint32_t> positions_;
+    uint32_t free_head_ = NO_HANDLE;
+    Compare less_;
+};
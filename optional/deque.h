@@ -0,0 +1,516 @@
+#pragma once
+#include "vector.h"
+
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Число элементов в блоке Deque: степень двойки, блок занимает около 4 КБ,
+// но вмещает не меньше 16 элементов
+template <typename T>
+constexpr size_t DequeBlockSize() noexcept
+{
+    size_t size = 16;
+    while (size * 2 * sizeof(T) <= 4096)
+    {
+        size *= 2;
+    }
+    return size;
+}
+
+}  // namespace detail
+
+// Двусторонняя очередь из блоков RawMemory фиксированного размера. Указатели на блоки
+// хранятся в кольцевом буфере, который удваивается при нехватке места. Освободившиеся
+// блоки (до SPARE_BLOCKS штук) сохраняются для повторного использования, поэтому
+// скользящее окно в устойчивом режиме не выделяет память
+template <typename T, size_t BLOCK_SIZE = detail::DequeBlockSize<T>()>
+class Deque {
+    static_assert(BLOCK_SIZE > 0 && (BLOCK_SIZE & (BLOCK_SIZE - 1)) == 0, "BLOCK_SIZE must be a power of two");
+
+public:
+    static constexpr size_t SPARE_BLOCKS = 2;
+
+    template <typename Container, typename Value>
+    class BasicIterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_const_t<Value>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        BasicIterator() = default;
+
+        // iterator приводится к const_iterator
+        template <typename OtherContainer, typename OtherValue,
+                  typename = std::enable_if_t<std::is_const_v<Value> && !std::is_const_v<OtherValue>>>
+        BasicIterator(const BasicIterator<OtherContainer, OtherValue>& other) noexcept
+            : container_(other.container_)
+            , index_(other.index_)
+        {}
+
+        Value& operator*() const noexcept
+        {
+            return (*container_)[index_];
+        }
+
+        Value* operator->() const noexcept
+        {
+            return &**this;
+        }
+
+        Value& operator[](difference_type offset) const noexcept
+        {
+            return *(*this + offset);
+        }
+
+        BasicIterator& operator++() noexcept
+        {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept
+        {
+            BasicIterator copy(*this);
+            ++index_;
+            return copy;
+        }
+
+        BasicIterator& operator--() noexcept
+        {
+            --index_;
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept
+        {
+            BasicIterator copy(*this);
+            --index_;
+            return copy;
+        }
+
+        BasicIterator& operator+=(difference_type offset) noexcept
+        {
+            index_ += offset;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type offset) noexcept
+        {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept
+        {
+            return it += offset;
+        }
+
+        friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept
+        {
+            return it += offset;
+        }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept
+        {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend bool operator<(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend bool operator>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return !(lhs < rhs);
+        }
+
+    private:
+        friend class Deque;
+        template <typename, typename>
+        friend class BasicIterator;
+
+        BasicIterator(Container* container, size_t index) noexcept
+            : container_(container)
+            , index_(index)
+        {}
+
+        Container* container_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using iterator = BasicIterator<Deque, T>;
+    using const_iterator = BasicIterator<const Deque, const T>;
+
+    Deque() = default;
+
+    Deque(const Deque& other)
+    {
+        for (const T& value : other)
+        {
+            PushBack(value);
+        }
+    }
+
+    Deque(Deque&& other) noexcept
+    {
+        Swap(other);
+    }
+
+    Deque& operator=(const Deque& rhs)
+    {
+        if (this != &rhs)
+        {
+            Deque rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    Deque& operator=(Deque&& rhs) noexcept
+    {
+        Swap(rhs);
+        return *this;
+    }
+
+    ~Deque()
+    {
+        for (size_t i = 0; i < size_; ++i)
+        {
+            std::destroy_at(&(*this)[i]);
+        }
+    }
+
+    void Swap(Deque& other) noexcept
+    {
+        map_.Swap(other.map_);
+        for (size_t i = 0; i < SPARE_BLOCKS; ++i)
+        {
+            spare_[i].Swap(other.spare_[i]);
+        }
+        std::swap(spare_count_, other.spare_count_);
+        std::swap(first_block_, other.first_block_);
+        std::swap(block_count_, other.block_count_);
+        std::swap(front_begin_, other.front_begin_);
+        std::swap(front_, other.front_);
+        std::swap(back_, other.back_);
+        std::swap(back_end_, other.back_end_);
+        std::swap(size_, other.size_);
+        std::swap(block_allocations_, other.block_allocations_);
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    bool Empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    // Сколько раз за время жизни выделялась память под блок
+    size_t BlockAllocations() const noexcept
+    {
+        return block_allocations_;
+    }
+
+    T& operator[](size_t index) noexcept
+    {
+        assert(index < size_);
+        return *Slot(static_cast<size_t>(front_ - front_begin_) + index);
+    }
+
+    const T& operator[](size_t index) const noexcept
+    {
+        return const_cast<Deque&>(*this)[index];
+    }
+
+    T& Front() noexcept
+    {
+        assert(size_ > 0);
+        return *front_;
+    }
+
+    const T& Front() const noexcept
+    {
+        assert(size_ > 0);
+        return *front_;
+    }
+
+    T& Back() noexcept
+    {
+        assert(size_ > 0);
+        return back_[-1];
+    }
+
+    const T& Back() const noexcept
+    {
+        assert(size_ > 0);
+        return back_[-1];
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args)
+    {
+        const bool new_block = back_ == back_end_;
+        if (new_block)
+        {
+            AddBackBlock();
+        }
+        try
+        {
+            new (back_) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            if (new_block)
+            {
+                RemoveBackBlock();
+            }
+            throw;
+        }
+        ++size_;
+        return *back_++;
+    }
+
+    template <typename... Args>
+    T& EmplaceFront(Args&&... args)
+    {
+        const bool new_block = front_ == front_begin_;
+        if (new_block)
+        {
+            AddFrontBlock();
+        }
+        try
+        {
+            new (front_ - 1) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            if (new_block)
+            {
+                RemoveFrontBlock();
+            }
+            throw;
+        }
+        ++size_;
+        return *--front_;
+    }
+
+    void PushBack(const T& value)
+    {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value)
+    {
+        EmplaceBack(std::move(value));
+    }
+
+    void PushFront(const T& value)
+    {
+        EmplaceFront(value);
+    }
+
+    void PushFront(T&& value)
+    {
+        EmplaceFront(std::move(value));
+    }
+
+    void PopBack() noexcept
+    {
+        assert(size_ > 0);
+        std::destroy_at(--back_);
+        --size_;
+        if (back_ == back_end_ - BLOCK_SIZE)
+        {
+            RemoveBackBlock();
+        }
+    }
+
+    void PopFront() noexcept
+    {
+        assert(size_ > 0);
+        std::destroy_at(front_++);
+        --size_;
+        if (front_ == front_begin_ + BLOCK_SIZE)
+        {
+            RemoveFrontBlock();
+        }
+    }
+
+    iterator begin() noexcept
+    {
+        return {this, 0};
+    }
+
+    iterator end() noexcept
+    {
+        return {this, size_};
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return {this, 0};
+    }
+
+    const_iterator end() const noexcept
+    {
+        return {this, size_};
+    }
+
+private:
+    // Адрес элемента по смещению от начала первого блока
+    T* Slot(size_t position) noexcept
+    {
+        return BlockAt(position / BLOCK_SIZE) + position % BLOCK_SIZE;
+    }
+
+    RawMemory<T> AcquireBlock()
+    {
+        if (spare_count_ > 0)
+        {
+            return std::move(spare_[--spare_count_]);
+        }
+        RawMemory<T> block(BLOCK_SIZE);
+        ++block_allocations_;
+        return block;
+    }
+
+    void ReleaseBlock(RawMemory<T>& block) noexcept
+    {
+        if (spare_count_ < SPARE_BLOCKS)
+        {
+            spare_[spare_count_++].Swap(block);
+        }
+        RawMemory<T>().Swap(block);
+    }
+
+    // Удваивает кольцевой буфер блоков, если он заполнен. Блоки переносятся по порядку
+    void EnsureMapSlot()
+    {
+        if (block_count_ < map_.Size())
+        {
+            return;
+        }
+        Vector<RawMemory<T>> new_map(map_.Size() ? map_.Size() * 2 : 8);
+        for (size_t i = 0; i < block_count_; ++i)
+        {
+            new_map[i].Swap(map_[(first_block_ + i) & (map_.Size() - 1)]);
+        }
+        map_.Swap(new_map);
+        first_block_ = 0;
+    }
+
+    T* BlockAt(size_t index) noexcept
+    {
+        return map_[(first_block_ + index) & (map_.Size() - 1)].GetAddress();
+    }
+
+    void AddBackBlock()
+    {
+        EnsureMapSlot();
+        RawMemory<T> block = AcquireBlock();
+        back_ = block.GetAddress();
+        back_end_ = back_ + BLOCK_SIZE;
+        if (block_count_ == 0)
+        {
+            front_begin_ = front_ = back_;
+        }
+        map_[(first_block_ + block_count_) & (map_.Size() - 1)].Swap(block);
+        ++block_count_;
+    }
+
+    void AddFrontBlock()
+    {
+        EnsureMapSlot();
+        RawMemory<T> block = AcquireBlock();
+        front_begin_ = block.GetAddress();
+        front_ = front_begin_ + BLOCK_SIZE;
+        if (block_count_ == 0)
+        {
+            back_ = back_end_ = front_;
+        }
+        first_block_ = (first_block_ - 1) & (map_.Size() - 1);
+        map_[first_block_].Swap(block);
+        ++block_count_;
+    }
+
+    // Последний блок пуст. Если он же первый, очередь остаётся без блоков
+    void RemoveBackBlock() noexcept
+    {
+        --block_count_;
+        ReleaseBlock(map_[(first_block_ + block_count_) & (map_.Size() - 1)]);
+        if (block_count_ == 0)
+        {
+            front_begin_ = front_ = back_ = back_end_ = nullptr;
+        }
+        else
+        {
+            back_ = back_end_ = BlockAt(block_count_ - 1) + BLOCK_SIZE;
+        }
+    }
+
+    // Первый блок пуст. Если он же последний, очередь остаётся без блоков
+    void RemoveFrontBlock() noexcept
+    {
+        ReleaseBlock(map_[first_block_]);
+        first_block_ = (first_block_ + 1) & (map_.Size() - 1);
+        --block_count_;
+        if (block_count_ == 0)
+        {
+            front_begin_ = front_ = back_ = back_end_ = nullptr;
+        }
+        else
+        {
+            front_begin_ = front_ = BlockAt(0);
+        }
+    }
+
+    Vector<RawMemory<T>> map_;
+    RawMemory<T> spare_[SPARE_BLOCKS];
+    size_t spare_count_ = 0;
+    size_t first_block_ = 0;
+    size_t block_count_ = 0;
+    // Края очереди: начало первого блока, первый элемент, слот за последним элементом
+    // и конец последнего блока. Без блоков все четыре указателя нулевые
+    T* front_begin_ = nullptr;
+    T* front_ = nullptr;
+    T* back_ = nullptr;
+    T* back_end_ = nullptr;
+    size_t size_ = 0;
+    size_t block_allocations_ = 0;
+};
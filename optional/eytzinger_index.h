@@ -0,0 +1,151 @@
+#pragma once
+#include "bits.h"
+#include "parallel_policy.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <utility>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <xmmintrin.h>
+#endif
+
+namespace detail {
+
+inline void Prefetch(const void* address) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    __builtin_prefetch(address);
+#endif
+}
+
+}  // namespace detail
+
+// Неизменяемый индекс для поиска по отсортированному массиву ключей. Ключи
+// переложены в порядке Эйтцингера (обход двоичного дерева по уровням), поэтому
+// первые шаги всех запросов читают одни и те же строки кэша, а потомков узла
+// на несколько уровней вперёд можно загрузить заранее одной предвыборкой.
+// Кроме ключей индекс ничего не хранит: позиция ключа в исходном массиве
+// вычисляется по номеру узла. Ключ должен иметь конструктор по умолчанию
+template <typename K, typename Compare = std::less<K>>
+class EytzingerIndex {
+public:
+    EytzingerIndex() = default;
+
+    // Строит индекс по ключам, отсортированным в порядке less
+    explicit EytzingerIndex(const Vector<K>& sorted, Compare less = Compare())
+        : lines_(sorted.Size() / KEYS_PER_LINE + 1)
+        , size_(sorted.Size())
+        , height_(detail::BitWidth(sorted.Size()) - (sorted.Size() != 0))
+        , less_(std::move(less))
+    {
+        assert(std::is_sorted(sorted.begin(), sorted.end(), less_));
+        // На последнем уровне дерева может быть заполнена только часть узлов
+        last_level_ = size_ - ((size_t{1} << height_) - 1);
+        size_t rank = 0;
+        Build(sorted, 1, rank);
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    // Позиция в исходном массиве первого ключа, не меньшего key, или Size(),
+    // если такого ключа нет. Результат совпадает с std::lower_bound
+    size_t LowerBound(const K& key) const noexcept
+    {
+        const size_t node = FindNode(key);
+        return node != 0 ? RankOf(node) : Size();
+    }
+
+    // Указатель на первый ключ, не меньший key, или nullptr
+    const K* LowerBoundKey(const K& key) const noexcept
+    {
+        const size_t node = FindNode(key);
+        return node != 0 ? &KeyAt(node) : nullptr;
+    }
+
+    bool Contains(const K& key) const noexcept
+    {
+        const K* found = LowerBoundKey(key);
+        return found != nullptr && !less_(key, *found);
+    }
+
+private:
+    static constexpr size_t FloorPowerOfTwo(size_t value) noexcept
+    {
+        size_t power = 1;
+        while (power * 2 <= value)
+        {
+            power *= 2;
+        }
+        return power;
+    }
+
+    // Число ключей в строке кэша - степень двойки, чтобы потомки узла k на
+    // log2(KEYS_PER_LINE) уровней ниже начинались с k * KEYS_PER_LINE и занимали ровно одну строку
+    static constexpr size_t KEYS_PER_LINE = FloorPowerOfTwo(CACHE_LINE_SIZE / sizeof(K) > 0 ? CACHE_LINE_SIZE / sizeof(K) : 1);
+
+    // Выровненная строка кэша, поэтому одна предвыборка загружает всю группу потомков
+    struct alignas(CACHE_LINE_SIZE) KeyLine {
+        K keys[KEYS_PER_LINE];
+    };
+
+    K& KeyAt(size_t node) noexcept
+    {
+        return lines_[node / KEYS_PER_LINE].keys[node % KEYS_PER_LINE];
+    }
+
+    const K& KeyAt(size_t node) const noexcept
+    {
+        return lines_[node / KEYS_PER_LINE].keys[node % KEYS_PER_LINE];
+    }
+
+    void Build(const Vector<K>& sorted, size_t node, size_t& rank)
+    {
+        // Симметричный обход дерева выдаёт узлы в порядке возрастания ключей
+        if (node <= size_)
+        {
+            Build(sorted, 2 * node, rank);
+            KeyAt(node) = sorted[rank++];
+            Build(sorted, 2 * node + 1, rank);
+        }
+    }
+
+    // Позиция узла при симметричном обходе. В полном дереве высоты height_ она
+    // вычисляется по глубине узла и его номеру на уровне, а из неё вычитаются
+    // отсутствующие узлы последнего уровня, которые в полном дереве стоят левее
+    size_t RankOf(size_t node) const noexcept
+    {
+        const size_t depth = detail::BitWidth(node) - 1;
+        const size_t full_rank = ((2 * (node - (size_t{1} << depth)) + 1) << (height_ - depth)) - 1;
+        // Узлы последнего уровня занимают чётные позиции полного дерева
+        const size_t last_level_before = (full_rank + 1) / 2;
+        return full_rank - (last_level_before > last_level_ ? last_level_before - last_level_ : 0);
+    }
+
+    // Номер узла с ответом или 0, если все ключи меньше key
+    size_t FindNode(const K& key) const noexcept
+    {
+        size_t node = 1;
+        while (node <= size_)
+        {
+            detail::Prefetch(lines_.begin() + node);
+            node = 2 * node + less_(KeyAt(node), key);
+        }
+        // Младшие единицы пути - шаги вправо после последнего шага влево, который и ведёт к ответу
+        return node >> (detail::CountTrailingZeros(~static_cast<uint64_t>(node)) + 1);
+    }
+
+    // Узел k лежит в строке k / KEYS_PER_LINE, узел 0 не используется
+    Vector<KeyLine> lines_ = Vector<KeyLine>(1);
+    size_t size_ = 0;
+    size_t height_ = 0;
+    size_t last_level_ = 0;
+    Compare less_;
+};
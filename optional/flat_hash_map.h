@@ -0,0 +1,481 @@
+#pragma once
+#include "bits.h"
+#include "simd.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Управляющие байты таблицы: занятый слот хранит 7 младших битов хеша ключа,
+// свободный - EMPTY_CONTROL со старшим битом
+inline constexpr uint8_t EMPTY_CONTROL = 0x80;
+inline constexpr size_t GROUP_WIDTH = 16;
+
+// Маски совпадений для группы из GROUP_WIDTH управляющих байтов, начиная с ctrl
+struct ControlGroup {
+    explicit ControlGroup(const uint8_t* ctrl) noexcept
+    {
+#if VECTOR_SIMD_X86
+        bytes_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+        std::memcpy(bytes_, ctrl, GROUP_WIDTH);
+#endif
+    }
+
+    // Биты позиций, где управляющий байт равен h2
+    uint32_t Match(uint8_t h2) const noexcept
+    {
+#if VECTOR_SIMD_X86
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes_, _mm_set1_epi8(static_cast<char>(h2)))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP_WIDTH; ++i)
+        {
+            mask |= uint32_t{bytes_[i] == h2} << i;
+        }
+        return mask;
+#endif
+    }
+
+    // Биты свободных позиций
+    uint32_t MatchEmpty() const noexcept
+    {
+#if VECTOR_SIMD_X86
+        return static_cast<uint32_t>(_mm_movemask_epi8(bytes_));
+#else
+        return Match(EMPTY_CONTROL);
+#endif
+    }
+
+private:
+#if VECTOR_SIMD_X86
+    __m128i bytes_;
+#else
+    uint8_t bytes_[GROUP_WIDTH];
+#endif
+};
+
+// Перемешивает биты хеша: std::hash для целых чисел часто тождественен
+inline uint64_t MixHash(uint64_t hash) noexcept
+{
+    hash ^= hash >> 32;
+    hash *= 0x9E3779B97F4A7C15ull;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+}  // namespace detail
+
+// Хеш-таблица с открытой адресацией в духе SwissTable. Пары ключ-значение лежат
+// в RawMemory и конструируются на месте, а поиск сравнивает 16 управляющих байтов
+// за одну SSE2-инструкцию. Пробирование линейное, поэтому удаление сдвигает
+// последующие элементы назад и обходится без надгробий
+template <typename K, typename V, typename Hash = std::hash<K>, typename Equal = std::equal_to<K>>
+class FlatHashMap {
+    static_assert(std::is_nothrow_move_constructible_v<K> && std::is_nothrow_move_constructible_v<V>,
+                  "FlatHashMap relocates elements and requires nothrow movable keys and values");
+
+    using Slot = std::pair<K, V>;
+
+public:
+    // Доля заполнения, при превышении которой таблица удваивается
+    static constexpr size_t MAX_LOAD_NUMERATOR = 7;
+    static constexpr size_t MAX_LOAD_DENOMINATOR = 8;
+
+    template <typename Map, typename Value>
+    class BasicIterator {
+    public:
+        using value_type = std::pair<const K&, Value&>;
+
+        // Пара ссылок на ключ и значение
+        value_type operator*() const noexcept
+        {
+            auto& slot = map_->slots_[index_];
+            return {slot.first, slot.second};
+        }
+
+        BasicIterator& operator++() noexcept
+        {
+            ++index_;
+            SkipEmpty();
+            return *this;
+        }
+
+        bool operator==(const BasicIterator& other) const noexcept
+        {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const BasicIterator& other) const noexcept
+        {
+            return index_ != other.index_;
+        }
+
+    private:
+        friend class FlatHashMap;
+
+        BasicIterator(Map* map, size_t index) noexcept
+            : map_(map)
+            , index_(index)
+        {
+            SkipEmpty();
+        }
+
+        void SkipEmpty() noexcept
+        {
+            while (index_ < map_->Capacity() && map_->ctrl_[index_] == detail::EMPTY_CONTROL)
+            {
+                ++index_;
+            }
+        }
+
+        Map* map_;
+        size_t index_;
+    };
+
+    using iterator = BasicIterator<FlatHashMap, V>;
+    using const_iterator = BasicIterator<const FlatHashMap, const V>;
+
+    FlatHashMap() = default;
+
+    FlatHashMap(const FlatHashMap& other)
+        : hash_(other.hash_)
+        , equal_(other.equal_)
+    {
+        Reserve(other.size_);
+        for (auto [key, value] : other)
+        {
+            Emplace(key, value);
+        }
+    }
+
+    FlatHashMap(FlatHashMap&& other) noexcept
+    {
+        Swap(other);
+    }
+
+    FlatHashMap& operator=(const FlatHashMap& rhs)
+    {
+        if (this != &rhs)
+        {
+            FlatHashMap rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    FlatHashMap& operator=(FlatHashMap&& rhs) noexcept
+    {
+        Swap(rhs);
+        return *this;
+    }
+
+    ~FlatHashMap()
+    {
+        DestroySlots();
+    }
+
+    void Swap(FlatHashMap& other) noexcept
+    {
+        ctrl_.Swap(other.ctrl_);
+        slots_.Swap(other.slots_);
+        std::swap(size_, other.size_);
+        std::swap(hash_, other.hash_);
+        std::swap(equal_, other.equal_);
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    // Число слотов таблицы: 0 или степень двойки не меньше GROUP_WIDTH
+    size_t Capacity() const noexcept
+    {
+        return slots_.Capacity();
+    }
+
+    double LoadFactor() const noexcept
+    {
+        return Capacity() ? static_cast<double>(size_) / Capacity() : 0.0;
+    }
+
+    // Готовит таблицу к хранению count элементов без перехеширования. Пустая таблица
+    // при count == 0 так и остаётся без памяти
+    void Reserve(size_t count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        size_t capacity = detail::GROUP_WIDTH;
+        while (capacity * MAX_LOAD_NUMERATOR / MAX_LOAD_DENOMINATOR < count)
+        {
+            capacity *= 2;
+        }
+        if (capacity > Capacity())
+        {
+            Rehash(capacity);
+        }
+    }
+
+    // Указатель на значение или nullptr, если ключа нет
+    V* Find(const K& key) noexcept
+    {
+        if (size_ == 0)
+        {
+            return nullptr;
+        }
+        const uint64_t hash = HashOf(key);
+        const size_t index = FindIndex(key, hash);
+        return index != NOT_FOUND ? &slots_[index].second : nullptr;
+    }
+
+    const V* Find(const K& key) const noexcept
+    {
+        return const_cast<FlatHashMap&>(*this).Find(key);
+    }
+
+    bool Contains(const K& key) const noexcept
+    {
+        return Find(key) != nullptr;
+    }
+
+    // Вставляет значение, сконструированное из args, если ключа ещё нет.
+    // Возвращает значение по ключу и признак того, что вставка произошла.
+    // Ключ-rvalue перемещается в таблицу только при вставке
+    template <typename... Args>
+    std::pair<V*, bool> Emplace(const K& key, Args&&... args)
+    {
+        return EmplaceKey(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<V*, bool> Emplace(K&& key, Args&&... args)
+    {
+        return EmplaceKey(std::move(key), std::forward<Args>(args)...);
+    }
+
+    std::pair<V*, bool> Insert(const K& key, const V& value)
+    {
+        return Emplace(key, value);
+    }
+
+    std::pair<V*, bool> Insert(const K& key, V&& value)
+    {
+        return Emplace(key, std::move(value));
+    }
+
+    std::pair<V*, bool> Insert(K&& key, const V& value)
+    {
+        return Emplace(std::move(key), value);
+    }
+
+    std::pair<V*, bool> Insert(K&& key, V&& value)
+    {
+        return Emplace(std::move(key), std::move(value));
+    }
+
+    V& operator[](const K& key)
+    {
+        return *Emplace(key).first;
+    }
+
+    V& operator[](K&& key)
+    {
+        return *Emplace(std::move(key)).first;
+    }
+
+    bool Erase(const K& key) noexcept
+    {
+        if (size_ == 0)
+        {
+            return false;
+        }
+        size_t gap = FindIndex(key, HashOf(key));
+        if (gap == NOT_FOUND)
+        {
+            return false;
+        }
+        std::destroy_at(slots_ + gap);
+
+        // Обратный сдвиг: элемент переносится в освободившийся слот, если тот лежит
+        // между его домашней позицией и текущей. Цепочка заканчивается на свободном слоте
+        const size_t mask = Capacity() - 1;
+        for (size_t i = (gap + 1) & mask; ctrl_[i] != detail::EMPTY_CONTROL; i = (i + 1) & mask)
+        {
+            const size_t home = H1(HashOf(slots_[i].first)) & mask;
+            if (((i - home) & mask) >= ((i - gap) & mask))
+            {
+                new (slots_ + gap) Slot(std::move(slots_[i]));
+                std::destroy_at(slots_ + i);
+                SetControl(gap, ctrl_[i]);
+                gap = i;
+            }
+        }
+        SetControl(gap, detail::EMPTY_CONTROL);
+        --size_;
+        return true;
+    }
+
+    iterator begin() noexcept
+    {
+        return {this, 0};
+    }
+
+    iterator end() noexcept
+    {
+        return {this, Capacity()};
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return {this, 0};
+    }
+
+    const_iterator end() const noexcept
+    {
+        return {this, Capacity()};
+    }
+
+private:
+    static constexpr size_t NOT_FOUND = size_t(-1);
+
+    template <typename Key, typename... Args>
+    std::pair<V*, bool> EmplaceKey(Key&& key, Args&&... args)
+    {
+        if (V* existing = Find(key))
+        {
+            return {existing, false};
+        }
+        const uint64_t hash = HashOf(key);
+        size_t index = 0;
+        if ((size_ + 1) * MAX_LOAD_DENOMINATOR > Capacity() * MAX_LOAD_NUMERATOR)
+        {
+            // Пара создаётся до перехеширования, так как аргументы могут ссылаться на элементы таблицы
+            Slot slot(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)),
+                      std::forward_as_tuple(std::forward<Args>(args)...));
+            Rehash(Capacity() ? Capacity() * 2 : detail::GROUP_WIDTH);
+            index = FindEmptyIndex(hash);
+            new (slots_ + index) Slot(std::move(slot));
+        }
+        else
+        {
+            index = FindEmptyIndex(hash);
+            new (slots_ + index) Slot(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)),
+                                      std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+        SetControl(index, H2(hash));
+        ++size_;
+        return {&slots_[index].second, true};
+    }
+
+    uint64_t HashOf(const K& key) const noexcept
+    {
+        return detail::MixHash(static_cast<uint64_t>(hash_(key)));
+    }
+
+    // Старшие биты хеша задают домашнюю позицию, младшие 7 хранятся в управляющем байте
+    static size_t H1(uint64_t hash) noexcept
+    {
+        return static_cast<size_t>(hash >> 7);
+    }
+
+    static uint8_t H2(uint64_t hash) noexcept
+    {
+        return static_cast<uint8_t>(hash & 0x7F);
+    }
+
+    size_t FindIndex(const K& key, uint64_t hash) const noexcept
+    {
+        const size_t mask = Capacity() - 1;
+        for (size_t pos = H1(hash) & mask;; pos = (pos + detail::GROUP_WIDTH) & mask)
+        {
+            const detail::ControlGroup group(ctrl_.begin() + pos);
+            for (uint32_t match = group.Match(H2(hash)); match != 0; match &= match - 1)
+            {
+                const size_t index = (pos + detail::CountTrailingZeros(match)) & mask;
+                if (equal_(slots_[index].first, key))
+                {
+                    return index;
+                }
+            }
+            // Свободный слот обрывает цепочку: дальше ключа быть не может
+            if (group.MatchEmpty() != 0)
+            {
+                return NOT_FOUND;
+            }
+        }
+    }
+
+    size_t FindEmptyIndex(uint64_t hash) const noexcept
+    {
+        const size_t mask = Capacity() - 1;
+        for (size_t pos = H1(hash) & mask;; pos = (pos + detail::GROUP_WIDTH) & mask)
+        {
+            if (const uint32_t empty = detail::ControlGroup(ctrl_.begin() + pos).MatchEmpty())
+            {
+                return (pos + detail::CountTrailingZeros(empty)) & mask;
+            }
+        }
+    }
+
+    // Первые GROUP_WIDTH - 1 управляющих байтов продублированы после конца таблицы,
+    // чтобы группу можно было читать одной загрузкой с любой позиции
+    void SetControl(size_t index, uint8_t value) noexcept
+    {
+        ctrl_[index] = value;
+        if (index < detail::GROUP_WIDTH - 1)
+        {
+            ctrl_[Capacity() + index] = value;
+        }
+    }
+
+    // Переносит элементы в новую таблицу. Перемещение не бросает исключений,
+    // поэтому выделение памяти - единственное, что может прервать операцию
+    void Rehash(size_t new_capacity)
+    {
+        Vector<uint8_t> ctrl(new_capacity + detail::GROUP_WIDTH - 1);
+        std::fill(ctrl.begin(), ctrl.end(), detail::EMPTY_CONTROL);
+        RawMemory<Slot> slots(new_capacity);
+        ctrl_.Swap(ctrl);
+        slots_.Swap(slots);
+
+        // Теперь ctrl и slots описывают прежнюю таблицу
+        for (size_t i = 0; i < slots.Capacity(); ++i)
+        {
+            if (ctrl[i] != detail::EMPTY_CONTROL)
+            {
+                const uint64_t hash = HashOf(slots[i].first);
+                const size_t index = FindEmptyIndex(hash);
+                new (slots_ + index) Slot(std::move(slots[i]));
+                std::destroy_at(slots + i);
+                SetControl(index, H2(hash));
+            }
+        }
+    }
+
+    void DestroySlots() noexcept
+    {
+        for (size_t i = 0; i < Capacity(); ++i)
+        {
+            if (ctrl_[i] != detail::EMPTY_CONTROL)
+            {
+                std::destroy_at(slots_ + i);
+            }
+        }
+    }
+
+    Vector<uint8_t> ctrl_;
+    RawMemory<Slot> slots_;
+    size_t size_ = 0;
+    Hash hash_;
+    Equal equal_;
+};
@@ -0,0 +1,468 @@
+#pragma once
+#include "span.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Позиция первого элемента, не меньшего key. Шаг поиска не зависит от результата
+// сравнения, поэтому компилятор заменяет ветвление условной пересылкой
+template <typename K, typename Compare>
+size_t BranchlessLowerBound(const K* data, size_t size, const K& key, const Compare& less) noexcept
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+    const K* base = data;
+    while (size > 1)
+    {
+        const size_t half = size / 2;
+        base = less(base[half], key) ? base + half : base;
+        size -= half;
+    }
+    return static_cast<size_t>(base - data) + less(*base, key);
+}
+
+// Сортирует элементы и оставляет первый из каждой группы равных по ключу
+template <typename T, typename KeyOf, typename Compare>
+void SortUnique(Vector<T>& items, KeyOf key_of, const Compare& less)
+{
+    std::stable_sort(items.begin(), items.end(), [&](const T& lhs, const T& rhs) {
+        return less(key_of(lhs), key_of(rhs));
+    });
+    size_t size = 0;
+    for (size_t i = 0; i < items.Size(); ++i)
+    {
+        if (size == 0 || less(key_of(items[size - 1]), key_of(items[i])))
+        {
+            if (size != i)
+            {
+                items[size] = std::move(items[i]);
+            }
+            ++size;
+        }
+    }
+    while (items.Size() > size)
+    {
+        items.PopBack();
+    }
+}
+
+}  // namespace detail
+
+// Упорядоченное множество на отсортированном Vector. Поиск - двоичный без ветвлений,
+// вставка и удаление сдвигают хвост, поэтому подходит для редко меняющихся данных
+template <typename K, typename Compare = std::less<K>>
+class FlatSet {
+public:
+    using iterator = const K*;
+    using const_iterator = const K*;
+
+    FlatSet() = default;
+
+    // Строит множество из произвольного набора ключей: сортирует и удаляет повторы
+    explicit FlatSet(Vector<K> keys, Compare less = Compare())
+        : keys_(std::move(keys))
+        , less_(std::move(less))
+    {
+        detail::SortUnique(keys_, Identity, less_);
+    }
+
+    size_t Size() const noexcept
+    {
+        return keys_.Size();
+    }
+
+    bool Empty() const noexcept
+    {
+        return keys_.Size() == 0;
+    }
+
+    void Reserve(size_t capacity)
+    {
+        keys_.Reserve(capacity);
+    }
+
+    // Номер первого ключа, не меньшего key
+    size_t LowerBound(const K& key) const noexcept
+    {
+        return detail::BranchlessLowerBound(keys_.begin(), keys_.Size(), key, less_);
+    }
+
+    // Указатель на ключ или nullptr, если его нет
+    const K* Find(const K& key) const noexcept
+    {
+        const size_t index = LowerBound(key);
+        return index < keys_.Size() && !less_(key, keys_[index]) ? keys_.begin() + index : nullptr;
+    }
+
+    bool Contains(const K& key) const noexcept
+    {
+        return Find(key) != nullptr;
+    }
+
+    bool Insert(const K& key)
+    {
+        const size_t index = LowerBound(key);
+        if (index < keys_.Size() && !less_(key, keys_[index]))
+        {
+            return false;
+        }
+        keys_.Insert(keys_.begin() + index, key);
+        return true;
+    }
+
+    bool Erase(const K& key)
+    {
+        const K* found = Find(key);
+        if (found == nullptr)
+        {
+            return false;
+        }
+        keys_.Erase(found);
+        return true;
+    }
+
+    // Вставляет пачку ключей одним слиянием за O(n + k) вместо k сдвигов хвоста
+    void InsertMany(Vector<K> batch)
+    {
+        detail::SortUnique(batch, Identity, less_);
+        Vector<K> merged;
+        merged.Reserve(keys_.Size() + batch.Size());
+        size_t i = 0;
+        size_t j = 0;
+        while (i < keys_.Size() && j < batch.Size())
+        {
+            if (less_(batch[j], keys_[i]))
+            {
+                merged.PushBack(std::move(batch[j++]));
+            }
+            else
+            {
+                if (!less_(keys_[i], batch[j]))
+                {
+                    ++j;
+                }
+                merged.PushBack(std::move(keys_[i++]));
+            }
+        }
+        for (; i < keys_.Size(); ++i)
+        {
+            merged.PushBack(std::move(keys_[i]));
+        }
+        for (; j < batch.Size(); ++j)
+        {
+            merged.PushBack(std::move(batch[j]));
+        }
+        keys_.Swap(merged);
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return keys_.begin();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return keys_.end();
+    }
+
+    // Отсортированные ключи одним непрерывным диапазоном
+    Span<const K> Keys() const noexcept
+    {
+        return {keys_.begin(), keys_.Size()};
+    }
+
+private:
+    static const K& Identity(const K& key) noexcept
+    {
+        return key;
+    }
+
+    Vector<K> keys_;
+    Compare less_;
+};
+
+// Упорядоченный словарь на двух отсортированных Vector. Ключи хранятся отдельно
+// от значений, чтобы двоичный поиск читал только их
+template <typename K, typename V, typename Compare = std::less<K>>
+class FlatMap {
+public:
+    template <typename Map, typename Value>
+    class BasicIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const K&, Value&>;
+        using difference_type = std::ptrdiff_t;
+
+        BasicIterator() = default;
+
+        // Пара ссылок на ключ и значение
+        value_type operator*() const noexcept
+        {
+            return {map_->keys_[index_], map_->values_[index_]};
+        }
+
+        BasicIterator& operator++() noexcept
+        {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept
+        {
+            BasicIterator copy(*this);
+            ++index_;
+            return copy;
+        }
+
+        bool operator==(const BasicIterator& other) const noexcept
+        {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const BasicIterator& other) const noexcept
+        {
+            return index_ != other.index_;
+        }
+
+    private:
+        friend class FlatMap;
+
+        BasicIterator(Map* map, size_t index) noexcept
+            : map_(map)
+            , index_(index)
+        {}
+
+        Map* map_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using iterator = BasicIterator<FlatMap, V>;
+    using const_iterator = BasicIterator<const FlatMap, const V>;
+
+    FlatMap() = default;
+
+    // Строит словарь из произвольного набора пар. Из пар с равными ключами остаётся первая
+    explicit FlatMap(Vector<std::pair<K, V>> items, Compare less = Compare())
+        : less_(std::move(less))
+    {
+        detail::SortUnique(items, KeyOf, less_);
+        Assign(items);
+    }
+
+    size_t Size() const noexcept
+    {
+        return keys_.Size();
+    }
+
+    bool Empty() const noexcept
+    {
+        return keys_.Size() == 0;
+    }
+
+    void Reserve(size_t capacity)
+    {
+        keys_.Reserve(capacity);
+        values_.Reserve(capacity);
+    }
+
+    // Номер первого ключа, не меньшего key
+    size_t LowerBound(const K& key) const noexcept
+    {
+        return detail::BranchlessLowerBound(keys_.begin(), keys_.Size(), key, less_);
+    }
+
+    // Указатель на значение или nullptr, если ключа нет
+    V* Find(const K& key) noexcept
+    {
+        const size_t index = LowerBound(key);
+        return index < keys_.Size() && !less_(key, keys_[index]) ? values_.begin() + index : nullptr;
+    }
+
+    const V* Find(const K& key) const noexcept
+    {
+        return const_cast<FlatMap&>(*this).Find(key);
+    }
+
+    bool Contains(const K& key) const noexcept
+    {
+        return Find(key) != nullptr;
+    }
+
+    // Вставляет значение, сконструированное из args, если ключа ещё нет.
+    // Возвращает значение по ключу и признак того, что вставка произошла
+    template <typename... Args>
+    std::pair<V*, bool> Emplace(const K& key, Args&&... args)
+    {
+        const size_t index = LowerBound(key);
+        if (index < keys_.Size() && !less_(key, keys_[index]))
+        {
+            return {values_.begin() + index, false};
+        }
+        values_.Emplace(values_.begin() + index, std::forward<Args>(args)...);
+        try
+        {
+            keys_.Insert(keys_.begin() + index, key);
+        }
+        catch (...)
+        {
+            values_.Erase(values_.begin() + index);
+            throw;
+        }
+        return {values_.begin() + index, true};
+    }
+
+    std::pair<V*, bool> Insert(const K& key, const V& value)
+    {
+        return Emplace(key, value);
+    }
+
+    std::pair<V*, bool> Insert(const K& key, V&& value)
+    {
+        return Emplace(key, std::move(value));
+    }
+
+    V& operator[](const K& key)
+    {
+        return *Emplace(key).first;
+    }
+
+    bool Erase(const K& key)
+    {
+        const size_t index = LowerBound(key);
+        if (index == keys_.Size() || less_(key, keys_[index]))
+        {
+            return false;
+        }
+        keys_.Erase(keys_.begin() + index);
+        values_.Erase(values_.begin() + index);
+        return true;
+    }
+
+    // Вставляет пачку пар одним слиянием за O(n + k). Имеющиеся значения не заменяются.
+    // Слияние идёт сразу в новые столбцы. Прежние элементы перемещаются, только если ключ и
+    // значение перемещаются без исключений, иначе копируются, поэтому при исключении словарь
+    // остаётся прежним
+    void InsertMany(Vector<std::pair<K, V>> batch)
+    {
+        detail::SortUnique(batch, KeyOf, less_);
+        Vector<K> keys;
+        Vector<V> values;
+        keys.Reserve(keys_.Size() + batch.Size());
+        values.Reserve(keys_.Size() + batch.Size());
+        size_t i = 0;
+        size_t j = 0;
+        auto take_own = [&] {
+            if constexpr (std::is_nothrow_move_constructible_v<K> && std::is_nothrow_move_constructible_v<V>)
+            {
+                keys.PushBack(std::move(keys_[i]));
+                values.PushBack(std::move(values_[i]));
+            }
+            else
+            {
+                keys.PushBack(keys_[i]);
+                values.PushBack(values_[i]);
+            }
+            ++i;
+        };
+        auto take_batch = [&] {
+            keys.PushBack(std::move(batch[j].first));
+            values.PushBack(std::move(batch[j].second));
+            ++j;
+        };
+        while (i < keys_.Size() && j < batch.Size())
+        {
+            if (less_(batch[j].first, keys_[i]))
+            {
+                take_batch();
+            }
+            else
+            {
+                if (!less_(keys_[i], batch[j].first))
+                {
+                    ++j;
+                }
+                take_own();
+            }
+        }
+        while (i < keys_.Size())
+        {
+            take_own();
+        }
+        while (j < batch.Size())
+        {
+            take_batch();
+        }
+        keys_.Swap(keys);
+        values_.Swap(values);
+    }
+
+    iterator begin() noexcept
+    {
+        return {this, 0};
+    }
+
+    iterator end() noexcept
+    {
+        return {this, keys_.Size()};
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return {this, 0};
+    }
+
+    const_iterator end() const noexcept
+    {
+        return {this, keys_.Size()};
+    }
+
+    // Отсортированные ключи и соответствующие им значения
+    Span<const K> Keys() const noexcept
+    {
+        return {keys_.begin(), keys_.Size()};
+    }
+
+    Span<V> Values() noexcept
+    {
+        return {values_.begin(), values_.Size()};
+    }
+
+    Span<const V> Values() const noexcept
+    {
+        return {values_.begin(), values_.Size()};
+    }
+
+private:
+    static const K& KeyOf(const std::pair<K, V>& item) noexcept
+    {
+        return item.first;
+    }
+
+    // Раскладывает отсортированные пары по столбцам ключей и значений
+    void Assign(Vector<std::pair<K, V>>& items)
+    {
+        Vector<K> keys;
+        Vector<V> values;
+        keys.Reserve(items.Size());
+        values.Reserve(items.Size());
+        for (std::pair<K, V>& item : items)
+        {
+            keys.PushBack(std::move(item.first));
+            values.PushBack(std::move(item.second));
+        }
+        keys_.Swap(keys);
+        values_.Swap(values);
+    }
+
+    Vector<K> keys_;
+    Vector<V> values_;
+    Compare less_;
+};
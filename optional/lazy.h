@@ -0,0 +1,113 @@
+#pragma once
+#include "optional.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+// Значение, которое вычисляется factory() при первом обращении ровно один раз, даже если
+// первыми обращаются несколько потоков. Результат factory() конструируется прямо в Optional
+// без копирования. После инициализации Get() - одна атомарная загрузка с acquire, без
+// блокировок. Потоки, пришедшие во время инициализации, ждут её окончания. Если factory()
+// бросает исключение, значение остаётся неинициализированным и следующий Get() повторит попытку
+template <typename T, typename Factory = T (*)()>
+class Lazy {
+public:
+    explicit Lazy(Factory factory)
+        : factory_(std::move(factory))
+    {}
+
+    Lazy(const Lazy&) = delete;
+    Lazy& operator=(const Lazy&) = delete;
+
+    const T& Get() const
+    {
+        if (state_.load(std::memory_order_acquire) != READY)
+        {
+            Initialize();
+        }
+        return *value_;
+    }
+
+    const T& operator*() const
+    {
+        return Get();
+    }
+
+    const T* operator->() const
+    {
+        return &Get();
+    }
+
+    bool IsInitialized() const noexcept
+    {
+        return state_.load(std::memory_order_acquire) == READY;
+    }
+
+    // Разрушает значение, и следующий Get() снова вызовет factory(). Предназначен для тестов:
+    // вызывать одновременно с другими обращениями к Lazy нельзя
+    void Reset() noexcept
+    {
+        value_.Reset();
+        state_.store(EMPTY, std::memory_order_release);
+    }
+
+private:
+    enum State : uint8_t {
+        EMPTY,
+        RUNNING,
+        READY,
+    };
+
+    void Initialize() const
+    {
+        uint8_t state = EMPTY;
+        while (!state_.compare_exchange_strong(state, RUNNING, std::memory_order_acquire))
+        {
+            if (state == READY)
+            {
+                return;
+            }
+            // Инициализацию выполняет другой поток: ждём, пока он закончит или бросит исключение
+            std::unique_lock lock(mutex_);
+            initialized_.wait(lock, [this] {
+                return state_.load(std::memory_order_acquire) != RUNNING;
+            });
+            state = EMPTY;
+        }
+
+        try
+        {
+            value_.EmplaceFrom(factory_);
+        }
+        catch (...)
+        {
+            Publish(EMPTY);
+            throw;
+        }
+        Publish(READY);
+    }
+
+    // Смена состояния под мьютексом, чтобы ожидающий поток не пропустил уведомление
+    void Publish(State state) const
+    {
+        {
+            std::lock_guard lock(mutex_);
+            state_.store(state, std::memory_order_release);
+        }
+        initialized_.notify_all();
+    }
+
+    mutable std::atomic<uint8_t> state_{EMPTY};
+    mutable Optional<T> value_;
+    // Вызывается только потоком, который перевёл состояние в RUNNING
+    mutable Factory factory_;
+    mutable std::mutex mutex_;
+    mutable std::condition_variable initialized_;
+};
+
+template <typename F>
+Lazy(F) -> Lazy<std::invoke_result_t<F&>, F>;
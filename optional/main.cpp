@@ -309,14 +309,61 @@ int main() {
 #endif
 
 #if TEST_VECTOR
+#include "bit_vector.h"
+#include "compact_vector.h"
+#include "cow_vector.h"
+#include "dary_heap.h"
+#include "deque.h"
+#include "eytzinger_index.h"
+#include "flat_hash_map.h"
+#include "flat_map.h"
+#include "lazy.h"
+#include "log_duration.h"
+#include "optional_array.h"
+#include "packed_int_vector.h"
+#include "parallel.h"
+#include "persistent_vector.h"
+#include "radix_sort.h"
+#include "serialization.h"
+#include "simd.h"
+#include "slot_map.h"
+#include "soa_vector.h"
+#include "span.h"
+#include "static_vector.h"
+#include "tiered_vector.h"
 #include "vector.h"
+#include "views.h"
 
 #include <iostream>
 #include <stdexcept>
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
 #include <iostream>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#if VECTOR_POSIX_IO
+#include <sys/mman.h>
+#endif
 
 namespace {
 
@@ -429,6 +476,57 @@ struct Obj {
     static inline int num_move_assigned = 0;
 };
 
+// Аналог Obj для тестов, в которых объекты создаются и разрушаются из нескольких потоков
+struct ConcurrentObj {
+    ConcurrentObj() {
+        if (++num_construction_attempts == throw_on_construction) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_default_constructed;
+    }
+
+    ConcurrentObj(const ConcurrentObj& other)
+        : id(other.id)  //
+    {
+        ++num_copied;
+    }
+
+    ConcurrentObj(ConcurrentObj&& other) noexcept
+        : id(other.id)  //
+    {
+        ++num_moved;
+    }
+
+    ConcurrentObj& operator=(const ConcurrentObj& other) = default;
+    ConcurrentObj& operator=(ConcurrentObj&& other) = default;
+
+    ~ConcurrentObj() {
+        ++num_destroyed;
+    }
+
+    static int GetAliveObjectCount() {
+        return num_default_constructed + num_copied + num_moved - num_destroyed;
+    }
+
+    static void ResetCounters() {
+        throw_on_construction = 0;
+        num_construction_attempts = 0;
+        num_default_constructed = 0;
+        num_copied = 0;
+        num_moved = 0;
+        num_destroyed = 0;
+    }
+
+    int id = 0;
+
+    static inline std::atomic<int> throw_on_construction = 0;
+    static inline std::atomic<int> num_construction_attempts = 0;
+    static inline std::atomic<int> num_default_constructed = 0;
+    static inline std::atomic<int> num_copied = 0;
+    static inline std::atomic<int> num_moved = 0;
+    static inline std::atomic<int> num_destroyed = 0;
+};
+
 }  // namespace
 
 void Test1() {
@@ -912,87 +1010,4217 @@ void Test6() {
         assert(Obj::num_moved == 0);
         assert(Obj::GetAliveObjectCount() == SIZE - 1);
     }
+    {
+        // Вставка в конец непустого вектора без реаллокации
+        Obj::ResetCounters();
+        Vector<Obj> v{SIZE};
+        v.Reserve(SIZE * 2);
+        const int old_num_moved = Obj::num_moved;
+        auto* pos = v.Emplace(v.cend(), ID, "Ivan"s);
+        assert(v.Size() == SIZE + 1);
+        assert(&*pos == &v[SIZE]);
+        assert(v[SIZE].id == ID);
+        assert(v[SIZE].name == "Ivan");
+        assert(Obj::num_moved == old_num_moved);
+        assert(Obj::num_move_assigned == 0);
+        assert(Obj::GetAliveObjectCount() == SIZE + 1);
+    }
 }
 
-struct C {
-    C() noexcept {
-        ++def_ctor;
+
+void TestParallelAlgorithms() {
+    const size_t SIZE = 100'000;
+    // Маленький порог заставляет алгоритмы действительно делить работу между потоками
+    const ParallelPolicy policy{4, 1'000};
+    {
+        Vector<int> v(SIZE);
+        std::iota(v.begin(), v.end(), 0);
+        ParallelForEach(policy, v, [](int& x) {
+            x *= 2;
+        });
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i] == static_cast<int>(i * 2));
+        }
     }
-    C(const C& /*other*/) noexcept {
-        ++copy_ctor;
+    {
+        Vector<int> in(SIZE);
+        std::iota(in.begin(), in.end(), 0);
+        Vector<long long> out(SIZE);
+        ParallelTransform(policy, in, out, [](int x) {
+            return static_cast<long long>(x) * x;
+        });
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(out[i] == static_cast<long long>(i * i));
+        }
     }
-    C(C&& /*other*/) noexcept {
-        ++move_ctor;
+    {
+        Vector<int> v(SIZE);
+        std::iota(v.begin(), v.end(), 1);
+        assert(ParallelReduce(policy, v, 0LL) == static_cast<long long>(SIZE * (SIZE + 1) / 2));
+        assert(ParallelReduce(policy, v.begin(), v.begin() + 10, 5LL) == 60);
+        // Неперестановочная, но ассоциативная операция должна сохранять порядок частей
+        Vector<std::string> words(5'000);
+        for (size_t i = 0; i < words.Size(); ++i) {
+            words[i] = std::string(1, static_cast<char>('a' + i % 26));
+        }
+        const std::string expected = std::accumulate(words.begin(), words.end(), std::string(">"));
+        assert(ParallelReduce(ParallelPolicy{3, 100}, words, std::string(">")) == expected);
     }
-    C& operator=(const C& other) noexcept {
-        if (this != &other) {
-            ++copy_assign;
+    {
+        std::mt19937 generator(42);
+        Vector<int> v(SIZE);
+        for (int& x : v) {
+            x = static_cast<int>(generator() % 1'000);
         }
-        return *this;
+        std::vector<int> expected(v.begin(), v.end());
+        std::sort(expected.begin(), expected.end());
+        for (size_t threads : {1, 2, 3, 4, 7}) {
+            Vector<int> copy(v);
+            ParallelSort(ParallelPolicy{threads, 1'000}, copy);
+            assert(std::equal(copy.begin(), copy.end(), expected.begin(), expected.end()));
+        }
+        Vector<int> copy(v);
+        ParallelSort(policy, copy, std::greater<>());
+        assert(std::equal(copy.begin(), copy.end(), expected.rbegin(), expected.rend()));
     }
-    C& operator=(C&& /*other*/) noexcept {
-        ++move_assign;
-        return *this;
+    {
+        ConcurrentObj::ResetCounters();
+        {
+            Vector<ConcurrentObj> v(SIZE / 10);
+            for (size_t i = 0; i < v.Size(); ++i) {
+                v[i].id = static_cast<int>(v.Size() - i);
+            }
+            auto by_id = [](const ConcurrentObj& lhs, const ConcurrentObj& rhs) {
+                return lhs.id < rhs.id;
+            };
+            ParallelSort(policy, v, by_id);
+            assert(std::is_sorted(v.begin(), v.end(), by_id));
+            assert(ConcurrentObj::num_copied == 0);
+        }
+        assert(ConcurrentObj::GetAliveObjectCount() == 0);
     }
-    ~C() {
-        ++dtor;
+    {
+        // Исключение из comp при последнем слиянии не оставляет элементов во вспомогательном буфере.
+        // Элементы разных половин впервые сравниваются именно там
+        ConcurrentObj::ResetCounters();
+        {
+            Vector<ConcurrentObj> v(10'000);
+            const int half = static_cast<int>(v.Size() / 2);
+            for (size_t i = 0; i < v.Size(); ++i) {
+                v[i].id = static_cast<int>(v.Size() - i);
+            }
+            try {
+                ParallelSort(ParallelPolicy{4, 1'000}, v, [half](const ConcurrentObj& lhs, const ConcurrentObj& rhs) {
+                    if (std::abs(lhs.id - rhs.id) >= half) {
+                        throw std::runtime_error("comparison failed");
+                    }
+                    return lhs.id < rhs.id;
+                });
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(ConcurrentObj::GetAliveObjectCount() == static_cast<int>(v.Size()));
+        }
+        assert(ConcurrentObj::GetAliveObjectCount() == 0);
+    }
+    {
+        Vector<int> v(SIZE);
+        const int* last = &v[SIZE - 1];
+        try {
+            // Исключение из рабочего потока должно дойти до вызывающего
+            ParallelForEach(policy, v, [last](int& x) {
+                if (&x == last) {
+                    throw std::runtime_error("Oops");
+                }
+            });
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
     }
+}
 
-    static void Reset() {
-        def_ctor = 0;
-        copy_ctor = 0;
-        move_ctor = 0;
-        copy_assign = 0;
-        move_assign = 0;
-        dtor = 0;
+void TestParallelConstruction() {
+    const size_t SIZE = 100'000;
+    const ParallelPolicy policy{4, 1'000};
+    {
+        Vector<int> v(SIZE, policy);
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == SIZE);
+        assert(std::all_of(v.begin(), v.end(), [](int x) {
+            return x == 0;
+        }));
+        std::iota(v.begin(), v.end(), 0);
+        Vector<int> copy(v, policy);
+        assert(copy.Size() == SIZE);
+        assert(std::equal(v.begin(), v.end(), copy.begin(), copy.end()));
+        copy.Clear(policy);
+        assert(copy.Size() == 0);
+        assert(copy.Capacity() == SIZE);
+    }
+    ConcurrentObj::ResetCounters();
+    {
+        Vector<ConcurrentObj> v(SIZE, policy);
+        assert(ConcurrentObj::num_default_constructed == SIZE);
+        Vector<ConcurrentObj> copy(v, policy);
+        assert(ConcurrentObj::num_copied == SIZE);
+        assert(ConcurrentObj::GetAliveObjectCount() == 2 * SIZE);
+        v.Clear(policy);
+        assert(ConcurrentObj::GetAliveObjectCount() == SIZE);
+        // После Clear вектор остаётся пригодным к использованию
+        v.EmplaceBack();
+        assert(v.Size() == 1);
+    }
+    assert(ConcurrentObj::GetAliveObjectCount() == 0);
+    ConcurrentObj::ResetCounters();
+    {
+        ConcurrentObj::throw_on_construction = SIZE / 2;
+        try {
+            Vector<ConcurrentObj> v(SIZE, policy);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(ConcurrentObj::GetAliveObjectCount() == 0);
+    }
+    {
+        Vector<TestObj> v(SIZE, ParallelPolicy{3, 100});
+        const Vector<TestObj> copy(v, ParallelPolicy{3, 100});
+        assert(std::all_of(copy.begin(), copy.end(), [](const TestObj& obj) {
+            return obj.IsAlive();
+        }));
     }
+}
 
-    inline static size_t def_ctor = 0;
-    inline static size_t copy_ctor = 0;
-    inline static size_t move_ctor = 0;
-    inline static size_t copy_assign = 0;
-    inline static size_t move_assign = 0;
-    inline static size_t dtor = 0;
-};
+void TestRadixSort() {
+    const size_t SIZE = 50'000;
+    std::mt19937_64 generator(42);
+    auto check = [](auto& v, auto key_fn, const ParallelPolicy& policy) {
+        std::vector<std::decay_t<decltype(v[0])>> expected(v.begin(), v.end());
+        std::stable_sort(expected.begin(), expected.end(), [&key_fn](const auto& lhs, const auto& rhs) {
+            return key_fn(lhs) < key_fn(rhs);
+        });
+        RadixSort(policy, v, key_fn);
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+    };
+    const auto identity = [](auto x) {
+        return x;
+    };
+    for (const ParallelPolicy& policy : {ParallelPolicy{1}, ParallelPolicy{4, 1'000}}) {
+        {
+            Vector<uint64_t> v(SIZE);
+            for (auto& x : v) {
+                x = generator();
+            }
+            check(v, identity, policy);
+        }
+        {
+            // Старшие разряды у всех ключей нулевые, соответствующие проходы пропускаются
+            Vector<uint64_t> v(SIZE);
+            for (auto& x : v) {
+                x = generator() % 100'000;
+            }
+            check(v, identity, policy);
+        }
+        {
+            Vector<int32_t> v(SIZE);
+            for (auto& x : v) {
+                x = static_cast<int32_t>(generator());
+            }
+            check(v, identity, policy);
+        }
+        {
+            Vector<int8_t> v(SIZE);
+            for (auto& x : v) {
+                x = static_cast<int8_t>(generator());
+            }
+            check(v, identity, policy);
+        }
+        {
+            Vector<float> v(SIZE);
+            std::uniform_real_distribution<float> distribution(-1e6f, 1e6f);
+            for (auto& x : v) {
+                x = distribution(generator);
+            }
+            v[0] = -0.0f;
+            v[1] = 0.0f;
+            v[2] = std::numeric_limits<float>::infinity();
+            v[3] = -std::numeric_limits<float>::infinity();
+            check(v, identity, policy);
+        }
+        {
+            Vector<double> v(SIZE);
+            std::uniform_real_distribution<double> distribution(-1e12, 1e12);
+            for (auto& x : v) {
+                x = distribution(generator);
+            }
+            check(v, identity, policy);
+        }
+        {
+            // Сортировка структур по ключу устойчива
+            Vector<std::pair<int16_t, std::string>> v(SIZE);
+            for (size_t i = 0; i < SIZE; ++i) {
+                v[i].first = static_cast<int16_t>(generator() % 100) - 50;
+                v[i].second = std::to_string(i);
+            }
+            check(v, [](const auto& p) { return p.first; }, policy);
+        }
+        {
+            Vector<uint32_t> v(SIZE);
+            for (auto& x : v) {
+                x = 7;
+            }
+            check(v, identity, policy);
+        }
+    }
+    {
+        Vector<int> empty;
+        RadixSort(empty);
+        Vector<int> single(1);
+        RadixSort(single);
+        assert(single.Size() == 1 && single[0] == 0);
+    }
+    ConcurrentObj::ResetCounters();
+    {
+        Vector<ConcurrentObj> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(SIZE - i);
+        }
+        RadixSort(ParallelPolicy{4, 1'000}, v, [](const ConcurrentObj& obj) {
+            return obj.id;
+        });
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i].id == static_cast<int>(i + 1));
+        }
+        assert(ConcurrentObj::num_copied == 0);
+    }
+    assert(ConcurrentObj::GetAliveObjectCount() == 0);
+}
 
-void Dump() {
-    using namespace std;
-    cerr << "Def ctors: "sv << C::def_ctor              //
-         << ", Copy ctors: "sv << C::copy_ctor          //
-         << ", Move ctors: "sv << C::move_ctor          //
-         << ", Copy assignments: "sv << C::copy_assign  //
-         << ", Move assignments: "sv << C::move_assign  //
-         << ", Dtors: "sv << C::dtor << endl;
+void TestSimdKernels() {
+    std::mt19937 generator(42);
+    const SimdLevel levels[] = {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2};
+    {
+        Vector<int32_t> empty;
+        assert(Find(empty, 1) == empty.end());
+        assert(!Contains(empty, 1));
+        assert(Count(empty, 1) == 0);
+        assert(!Min(empty).HasValue());
+        assert(!Max(empty).HasValue());
+        assert(Sum(empty) == 0);
+    }
+    // Сравнение с последовательными версиями на случайных данных и размерах,
+    // включая хвосты, не кратные ширине регистра
+    for (int iteration = 0; iteration < 2'000; ++iteration) {
+        const size_t size = generator() % 300;
+        // Небольшой диапазон значений даёт много совпадений
+        const int32_t range = 1 + static_cast<int32_t>(generator() % 64);
+        Vector<int32_t> ints(size);
+        Vector<float> floats(size);
+        for (size_t i = 0; i < size; ++i) {
+            ints[i] = static_cast<int32_t>(generator() % (2 * range)) - range;
+            floats[i] = static_cast<float>(ints[i]) * 0.5f;
+        }
+        if (size > 0 && generator() % 4 == 0) {
+            ints[generator() % size] = std::numeric_limits<int32_t>::min();
+            ints[generator() % size] = std::numeric_limits<int32_t>::max();
+        }
+        const int32_t needle = static_cast<int32_t>(generator() % (2 * range)) - range;
+        const float float_needle = static_cast<float>(needle) * 0.5f;
+
+        for (SimdLevel level : levels) {
+            assert(Find(ints, needle, level) == std::find(ints.begin(), ints.end(), needle));
+            assert(Contains(ints, needle, level) == (std::find(ints.begin(), ints.end(), needle) != ints.end()));
+            assert(Count(ints, needle, level) == static_cast<size_t>(std::count(ints.begin(), ints.end(), needle)));
+            assert(Sum(ints, level) == std::accumulate(ints.begin(), ints.end(), int64_t{0}));
+
+            assert(Find(floats, float_needle, level) == std::find(floats.begin(), floats.end(), float_needle));
+            assert(Count(floats, float_needle, level)
+                   == static_cast<size_t>(std::count(floats.begin(), floats.end(), float_needle)));
+            // Слагаемые - небольшие полуцелые числа, поэтому сумма точна в любом порядке
+            assert(Sum(floats, level) == std::accumulate(floats.begin(), floats.end(), 0.0f));
+
+            if (size > 0) {
+                assert(*Min(ints, level) == *std::min_element(ints.begin(), ints.end()));
+                assert(*Max(ints, level) == *std::max_element(ints.begin(), ints.end()));
+                assert(*Min(floats, level) == *std::min_element(floats.begin(), floats.end()));
+                assert(*Max(floats, level) == *std::max_element(floats.begin(), floats.end()));
+            }
+        }
+    }
+    {
+        // Сумма int32_t не переполняется
+        Vector<int32_t> v(1'000);
+        for (auto& x : v) {
+            x = std::numeric_limits<int32_t>::max();
+        }
+        for (SimdLevel level : levels) {
+            assert(Sum(v, level) == int64_t{std::numeric_limits<int32_t>::max()} * 1'000);
+        }
+    }
 }
 
-void Benchmark() {
-    using namespace std;
-    try {
-        const size_t NUM = 10;
-        C c;
+void TestSoAVector() {
+    using namespace std::literals;
+    {
+        SoAVector<int, std::string, double> v;
+        assert(v.Size() == 0);
+        assert(v.Capacity() == 0);
+        for (int i = 0; i < 100; ++i) {
+            auto [id, name, weight] = v.EmplaceBack(i, std::to_string(i), i * 0.5);
+            assert(id == i);
+            assert(name == std::to_string(i));
+            assert(weight == i * 0.5);
+        }
+        assert(v.Size() == 100);
+        assert(v.Capacity() == 128);
+        assert(std::get<1>(v[42]) == "42"s);
+
+        // Присваивание через прокси-ссылку изменяет элементы столбцов
+        std::get<0>(v[1]) = 1000;
+        v[2] = std::make_tuple(2000, "two thousand"s, 1.5);
+        assert(std::get<0>(v[1]) == 1000);
+        assert(std::get<1>(v[2]) == "two thousand"s);
+
+        const auto& cv = v;
+        Span<const int> ids = cv.Column<0>();
+        assert(ids.Size() == 100);
+        assert(&ids[5] == &std::get<0>(cv[5]));
+        assert(std::accumulate(ids.begin(), ids.end(), 0) == 99 * 100 / 2 - 1 - 2 + 1000 + 2000);
+
+        SoAVector<int, std::string, double> copy(v);
+        assert(copy.Size() == v.Size());
+        assert(std::get<1>(copy[99]) == "99"s);
+        assert(&std::get<1>(copy[99]) != &std::get<1>(v[99]));
+
+        SoAVector<int, std::string, double> moved(std::move(copy));
+        assert(moved.Size() == 100);
+        assert(copy.Size() == 0);
+
+        v.PopBack();
+        assert(v.Size() == 99);
+        v.Reserve(1'000);
+        assert(v.Capacity() == 1'000);
+        assert(std::get<1>(v[98]) == "98"s);
+    }
+    {
+        Obj::ResetCounters();
         {
-            cerr << "std::vector:"sv << endl;
-            C::Reset();
-            vector<C> v(NUM);
-            Dump();
-            v.push_back(c);
+            SoAVector<Obj, Obj> v;
+            v.Reserve(4);
+            v.EmplaceBack(1, 2);
+            v.EmplaceBack(3, 4);
+            assert(Obj::num_constructed_with_id == 4);
+            // Рост перемещает каждый столбец целиком
+            v.Reserve(8);
+            assert(Obj::num_moved == 4);
+            assert(Obj::num_copied == 0);
+            assert(std::get<1>(v[1]).id == 4);
+            assert(Obj::GetAliveObjectCount() == 4);
         }
-        Dump();
-    } catch (...) {
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    try {
-        const size_t NUM = 10;
-        C c;
+    {
+        Obj::ResetCounters();
         {
-            cerr << "Vector:"sv << endl;
-            C::Reset();
-            Vector<C> v(NUM);
-            Dump();
-            v.PushBack(c);
+            SoAVector<Obj, Obj> v;
+            Obj good(1);
+            Obj bad(2);
+            bad.throw_on_copy = true;
+            try {
+                v.EmplaceBack(good, bad);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            // Элемент первого столбца, созданный до исключения, разрушен
+            assert(v.Size() == 0);
+            assert(Obj::GetAliveObjectCount() == 2);
         }
-        Dump();
-    } catch (...) {
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Аргументы могут ссылаться на элементы самого вектора даже при реаллокации
+        SoAVector<TestObj, TestObj> v;
+        v.EmplaceBack(TestObj{}, TestObj{});
+        assert(v.Size() == v.Capacity());
+        v.EmplaceBack(std::get<0>(v[0]), std::get<1>(v[0]));
+        assert(std::get<0>(v[0]).IsAlive() && std::get<1>(v[1]).IsAlive());
+    }
+}
+
+void TestOptionalArray() {
+    using namespace std::literals;
+    const size_t SIZE = 1'000;
+    {
+        OptionalArray<std::string> a(SIZE);
+        assert(a.Size() == SIZE);
+        assert(a.CountPresent() == 0);
+        assert(a.begin() == a.end());
+        assert(!a.Get(0).HasValue());
+
+        a.Set(0, "zero"s);
+        a.Set(63, "63"s);
+        a.Set(64, "64"s);
+        a.Emplace(999, 3, 'x');
+        assert(a.CountPresent() == 4);
+        assert(a.HasValue(63) && !a.HasValue(62));
+        assert(a.Get(64).Value() == "64"s);
+        assert(a.Value(999) == "xxx"s);
+
+        std::vector<size_t> indices;
+        for (auto it = a.begin(); it != a.end(); ++it) {
+            indices.push_back(it.Index());
+        }
+        assert((indices == std::vector<size_t>{0, 63, 64, 999}));
+
+        a.Set(63, "sixty three"s);
+        assert(a.Value(63) == "sixty three"s);
+        a.Reset(63);
+        a.Reset(63);
+        assert(!a.HasValue(63));
+        assert(a.CountPresent() == 3);
+        try {
+            a.Value(63);
+            assert(false && "Exception is expected");
+        } catch (const BadOptionalAccess&) {
+        }
+
+        const OptionalArray<std::string> copy(a);
+        assert(copy.CountPresent() == 3);
+        assert(&copy.Value(0) != &a.Value(0));
+        assert(copy.Value(0) == "zero"s);
+
+        OptionalArray<std::string> moved(std::move(a));
+        assert(moved.CountPresent() == 3);
+        assert(a.Size() == 0);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            OptionalArray<Obj> a(SIZE);
+            for (size_t i = 0; i < SIZE; i += 3) {
+                a.Emplace(i, static_cast<int>(i));
+            }
+            assert(Obj::GetAliveObjectCount() == 334);
+            a.Set(3, Obj{7});
+            assert(Obj::num_move_assigned == 1);
+            a.Reset(0);
+            assert(Obj::GetAliveObjectCount() == 333);
+
+            int sum = 0;
+            for (const Obj& obj : std::as_const(a)) {
+                sum += obj.id;
+            }
+            assert(sum == 999 * 334 / 2 - 3 + 7);
+
+            a.Value(999).throw_on_copy = true;
+            try {
+                OptionalArray<Obj> copy(a);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            assert(Obj::GetAliveObjectCount() == 333);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void TestSlotMap() {
+    using namespace std::literals;
+    {
+        SlotMap<std::string> map;
+        const SlotHandle a = map.Insert("a"s);
+        const SlotHandle b = map.Emplace(2, 'b');
+        const SlotHandle c = map.Insert("c"s);
+        assert(map.Size() == 3);
+        assert(*map.Get(b) == "bb"s);
+
+        assert(map.Erase(a));
+        assert(!map.Erase(a));
+        assert(!map.Contains(a));
+        assert(map.Get(a) == nullptr);
+        assert(map.Size() == 2);
+
+        // Освободившийся слот переиспользуется, но старая ссылка на него недействительна
+        const SlotHandle d = map.Insert("d"s);
+        assert(d.index == a.index);
+        assert(d != a);
+        assert(map.Get(a) == nullptr);
+        assert(*map.Get(d) == "d"s);
+        assert(*map.Get(c) == "c"s);
+
+        std::vector<std::string> values;
+        for (auto it = map.begin(); it != map.end(); ++it) {
+            assert(map.Get(it.Handle()) == &*it);
+            values.push_back(*it);
+        }
+        std::sort(values.begin(), values.end());
+        assert((values == std::vector{"bb"s, "c"s, "d"s}));
+
+        const SlotHandle foreign{100, 0};
+        assert(!map.Contains(foreign));
+    }
+    {
+        // Случайная последовательность операций сверяется с std::unordered_map
+        std::mt19937 generator(42);
+        SlotMap<int> map;
+        std::vector<std::pair<SlotHandle, int>> alive;
+        std::vector<SlotHandle> dead;
+        for (int i = 0; i < 20'000; ++i) {
+            if (alive.empty() || generator() % 3 != 0) {
+                alive.push_back({map.Insert(i), i});
+            } else {
+                const size_t pos = generator() % alive.size();
+                assert(map.Erase(alive[pos].first));
+                dead.push_back(alive[pos].first);
+                alive[pos] = alive.back();
+                alive.pop_back();
+            }
+        }
+        assert(map.Size() == alive.size());
+        for (const auto& [handle, value] : alive) {
+            assert(*map.Get(handle) == value);
+        }
+        for (const SlotHandle& handle : dead) {
+            assert(!map.Contains(handle));
+        }
+        long long expected = 0;
+        for (const auto& item : alive) {
+            expected += item.second;
+        }
+        const auto& cmap = map;
+        assert(std::accumulate(cmap.begin(), cmap.end(), 0LL) == expected);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            SlotMap<Obj> map;
+            const SlotHandle a = map.Emplace(1);
+            map.Emplace(2);
+            map.Erase(a);
+            assert(Obj::GetAliveObjectCount() == 1);
+            Obj::default_construction_throw_countdown = 1;
+            try {
+                map.Emplace();
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            assert(map.Size() == 1);
+            assert(Obj::GetAliveObjectCount() == 1);
+            const SlotHandle c = map.Emplace(3);
+            assert(map.Get(c)->id == 3);
+            assert(Obj::num_copied == 0);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Аргумент Insert ссылается на объект этого же SlotMap, а вставка увеличивает ёмкость
+        SlotMap<std::string> map;
+        SlotHandle handle = map.Insert(std::string(100, 'x'));
+        for (int i = 0; i < 10; ++i) {
+            handle = map.Insert(*map.Get(handle));
+        }
+        assert(map.Size() == 11);
+        // Объекты лежат подряд
+        const std::string* first = &*map.begin();
+        size_t position = 0;
+        for (const std::string& value : map) {
+            assert(&value == first + position++);
+            assert(value == std::string(100, 'x'));
+        }
+    }
+}
+
+void TestFlatHashMap() {
+    using namespace std::literals;
+    {
+        FlatHashMap<std::string, int> map;
+        assert(map.Find("a"s) == nullptr);
+        assert(!map.Erase("a"s));
+        assert(map.Insert("a"s, 1).second);
+        assert(!map.Insert("a"s, 2).second);
+        assert(*map.Find("a"s) == 1);
+        map["b"s] = 2;
+        ++map["b"s];
+        assert(*map.Find("b"s) == 3);
+        assert(map.Size() == 2);
+        assert(map.Erase("a"s));
+        assert(!map.Contains("a"s));
+        assert(map.Size() == 1);
+
+        FlatHashMap<std::string, int> copy(map);
+        *copy.Find("b"s) = 10;
+        assert(*map.Find("b"s) == 3);
+        for (auto [key, value] : copy) {
+            assert(key == "b"s && value == 10);
+        }
+    }
+    {
+        // Одинаковый хеш у всех ключей даёт одну длинную цепочку, которая огибает конец таблицы
+        struct ConstantHash {
+            size_t operator()(int) const noexcept {
+                return 12345;
+            }
+        };
+        FlatHashMap<int, int, ConstantHash> map;
+        for (int i = 0; i < 100; ++i) {
+            map.Insert(i, i * i);
+        }
+        for (int i = 0; i < 100; i += 2) {
+            assert(map.Erase(i));
+        }
+        for (int i = 0; i < 100; ++i) {
+            const int* value = map.Find(i);
+            assert(i % 2 == 0 ? value == nullptr : *value == i * i);
+        }
+    }
+    {
+        // Случайная последовательность операций сверяется с std::unordered_map
+        std::mt19937 generator(42);
+        FlatHashMap<uint32_t, uint32_t> map;
+        std::unordered_map<uint32_t, uint32_t> expected;
+        for (uint32_t i = 0; i < 100'000; ++i) {
+            const uint32_t key = generator() % 5'000;
+            if (generator() % 3 == 0) {
+                assert(map.Erase(key) == (expected.erase(key) == 1));
+            } else {
+                const bool inserted = map.Insert(key, i).second;
+                assert(inserted == expected.emplace(key, i).second);
+            }
+            assert(map.Size() == expected.size());
+            assert(map.LoadFactor() <= 0.875);
+        }
+        for (uint32_t key = 0; key < 5'000; ++key) {
+            const auto it = expected.find(key);
+            const uint32_t* value = map.Find(key);
+            assert(it == expected.end() ? value == nullptr : *value == it->second);
+        }
+        size_t visited = 0;
+        for (auto [key, value] : std::as_const(map)) {
+            assert(expected.at(key) == value);
+            ++visited;
+        }
+        assert(visited == expected.size());
+    }
+    {
+        Obj::ResetCounters();
+        {
+            FlatHashMap<int, Obj> map;
+            for (int i = 0; i < 1'000; ++i) {
+                map.Emplace(i, i);
+            }
+            for (int i = 0; i < 1'000; i += 3) {
+                map.Erase(i);
+            }
+            assert(static_cast<size_t>(Obj::GetAliveObjectCount()) == map.Size());
+            FlatHashMap<int, Obj> moved(std::move(map));
+            assert(moved.Size() == 666 && map.Size() == 0);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Ключ без конструктора копирования
+        struct MoveOnlyKey {
+            explicit MoveOnlyKey(int id)
+                : id(std::make_unique<int>(id)) {
+            }
+            bool operator==(const MoveOnlyKey& other) const {
+                return *id == *other.id;
+            }
+            std::unique_ptr<int> id;
+        };
+        struct KeyHash {
+            size_t operator()(const MoveOnlyKey& key) const {
+                return std::hash<int>()(*key.id);
+            }
+        };
+        FlatHashMap<MoveOnlyKey, std::string, KeyHash> map;
+        for (int i = 0; i < 100; ++i) {
+            assert(map.Emplace(MoveOnlyKey(i), 3, 'x').second);
+        }
+        map[MoveOnlyKey(100)] = "y"s;
+        assert(map.Insert(MoveOnlyKey(101), "z"s).second);
+        assert(map.Size() == 102 && *map.Find(MoveOnlyKey(42)) == "xxx"s);
+        assert(*map.Find(MoveOnlyKey(100)) == "y"s && *map.Find(MoveOnlyKey(101)) == "z"s);
+
+        // Ключ перемещается только при вставке
+        std::string key(100, 'k');
+        FlatHashMap<std::string, int> strings;
+        strings.Insert(std::move(key), 1);
+        assert(key.empty() && strings.Contains(std::string(100, 'k')));
+        std::string same(100, 'k');
+        assert(!strings.Emplace(std::move(same), 2).second);
+        assert(same.size() == 100);
+    }
+    {
+        // Пустая таблица не выделяет память ни при Reserve(0), ни при копировании
+        FlatHashMap<int, int> map;
+        map.Reserve(0);
+        assert(map.Capacity() == 0);
+        const FlatHashMap<int, int> copy(map);
+        assert(copy.Capacity() == 0 && copy.begin() == copy.end());
+        map.Insert(1, 1);
+        map.Erase(1);
+        const FlatHashMap<int, int> erased_copy(map);
+        assert(erased_copy.Capacity() == 0);
+    }
+}
+
+void TestFlatMap() {
+    using namespace std::literals;
+    {
+        FlatSet<int> set(Vector<int>{});
+        assert(set.Empty() && !set.Contains(1));
+        Vector<int> keys;
+        for (int key : {5, 1, 3, 5, 1, 9}) {
+            keys.PushBack(key);
+        }
+        set = FlatSet<int>(std::move(keys));
+        assert((std::vector<int>(set.begin(), set.end()) == std::vector{1, 3, 5, 9}));
+        assert(set.LowerBound(4) == 2 && set.LowerBound(0) == 0 && set.LowerBound(10) == 4);
+        assert(set.Insert(4) && !set.Insert(4));
+        assert(set.Erase(1) && !set.Erase(1));
+        Vector<int> batch;
+        for (int key : {10, 0, 5, 10, 6}) {
+            batch.PushBack(key);
+        }
+        set.InsertMany(std::move(batch));
+        assert((std::vector<int>(set.begin(), set.end()) == std::vector{0, 3, 4, 5, 6, 9, 10}));
+    }
+    {
+        // Из пар с равными ключами остаётся первая, как при вставке в std::map
+        Vector<std::pair<std::string, int>> items;
+        items.PushBack({"b"s, 1});
+        items.PushBack({"a"s, 2});
+        items.PushBack({"b"s, 3});
+        FlatMap<std::string, int> map(std::move(items));
+        assert(map.Size() == 2);
+        assert(*map.Find("b"s) == 1);
+        assert(map.Find("c"s) == nullptr);
+        assert(!map.Insert("a"s, 10).second);
+        map["c"s] = 4;
+        assert(map.Keys()[2] == "c"s && map.Values()[2] == 4);
+        assert(map.Erase("a"s) && !map.Contains("a"s));
+
+        Vector<std::pair<std::string, int>> batch;
+        batch.PushBack({"d"s, 5});
+        batch.PushBack({"b"s, 6});
+        map.InsertMany(std::move(batch));
+        std::vector<std::pair<std::string, int>> flat;
+        for (auto [key, value] : std::as_const(map)) {
+            flat.emplace_back(key, value);
+        }
+        assert((flat == std::vector<std::pair<std::string, int>>{{"b"s, 1}, {"c"s, 4}, {"d"s, 5}}));
+    }
+    {
+        // Случайная последовательность операций сверяется с std::map
+        std::mt19937 generator(42);
+        FlatMap<int, int> map;
+        std::map<int, int> expected;
+        for (int i = 0; i < 20'000; ++i) {
+            const int key = static_cast<int>(generator() % 2'000);
+            switch (generator() % 4) {
+            case 0:
+                assert(map.Erase(key) == (expected.erase(key) == 1));
+                break;
+            case 1: {
+                Vector<std::pair<int, int>> batch;
+                for (int j = 0; j < 8; ++j) {
+                    const int batch_key = static_cast<int>(generator() % 2'000);
+                    batch.PushBack({batch_key, i});
+                    expected.emplace(batch_key, i);
+                }
+                map.InsertMany(std::move(batch));
+                break;
+            }
+            default:
+                assert(map.Insert(key, i).second == expected.emplace(key, i).second);
+            }
+        }
+        assert(map.Size() == expected.size());
+        auto it = expected.begin();
+        for (auto [key, value] : map) {
+            assert(key == it->first && value == it->second);
+            ++it;
+        }
+        for (int key = -1; key <= 2'000; ++key) {
+            const int* value = map.Find(key);
+            assert(expected.count(key) ? *value == expected.at(key) : value == nullptr);
+        }
+    }
+    {
+        // Значение с бросающим перемещением копируется при слиянии, и исключение
+        // оставляет словарь прежним
+        struct Fragile {
+            Fragile(int id, int* copies_left)
+                : id(id)
+                , copies_left(copies_left) {
+            }
+            Fragile(const Fragile& other)
+                : id(other.id)
+                , copies_left(other.copies_left) {
+                if (--*copies_left == 0) {
+                    throw std::runtime_error("Oops");
+                }
+            }
+            Fragile(Fragile&& other)
+                : id(other.id)
+                , copies_left(other.copies_left) {
+            }
+            Fragile& operator=(const Fragile&) = default;
+            Fragile& operator=(Fragile&&) = default;
+            int id;
+            int* copies_left;
+        };
+        int copies_left = -1;
+        FlatMap<int, Fragile> map;
+        for (int key = 0; key < 10; key += 2) {
+            map.Emplace(key, key, &copies_left);
+        }
+        Vector<std::pair<int, Fragile>> batch;
+        for (int key = 1; key < 10; key += 4) {
+            batch.PushBack({key, Fragile(key, &copies_left)});
+        }
+        copies_left = 3;
+        try {
+            map.InsertMany(std::move(batch));
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(map.Size() == 5);
+        for (int key = 0; key < 10; key += 2) {
+            assert(map.Find(key)->id == key);
+        }
+    }
+}
+
+void TestEytzingerIndex() {
+    {
+        const EytzingerIndex<int> empty;
+        assert(empty.Size() == 0 && empty.LowerBound(1) == 0 && empty.LowerBoundKey(1) == nullptr);
+    }
+    // Индексы всех размеров до 100 сверяются с std::lower_bound, включая повторы ключей
+    for (size_t size = 1; size <= 100; ++size) {
+        Vector<int> sorted(size);
+        for (size_t i = 0; i < size; ++i) {
+            sorted[i] = static_cast<int>(i / 2 * 3);
+        }
+        const EytzingerIndex<int> index(sorted);
+        assert(index.Size() == size);
+        for (int key = -1; key <= sorted[size - 1] + 1; ++key) {
+            const size_t expected = static_cast<size_t>(std::lower_bound(sorted.begin(), sorted.end(), key) - sorted.begin());
+            assert(index.LowerBound(key) == expected);
+            assert(index.Contains(key) == (expected < size && sorted[expected] == key));
+            assert(expected == size ? index.LowerBoundKey(key) == nullptr : *index.LowerBoundKey(key) == sorted[expected]);
+        }
+    }
+    {
+        Vector<std::string> sorted(3);
+        sorted[0] = "c";
+        sorted[1] = "b";
+        sorted[2] = "a";
+        const EytzingerIndex<std::string, std::greater<std::string>> index(sorted);
+        assert(index.LowerBound("bb") == 1 && index.LowerBound("z") == 0 && index.LowerBound("") == 3);
+    }
+    {
+        // Ключ в 12 байт: в строку кэша помещается 4 ключа, а не 5
+        using Key = std::array<int, 3>;
+        for (size_t size = 1; size <= 40; ++size) {
+            Vector<Key> sorted(size);
+            for (size_t i = 0; i < size; ++i) {
+                sorted[i] = {static_cast<int>(i), 0, 0};
+            }
+            const EytzingerIndex<Key> index(sorted);
+            for (int key = -1; key <= static_cast<int>(size); ++key) {
+                assert(index.LowerBound({key, 0, 0}) == std::min(static_cast<size_t>(std::max(key, 0)), size));
+            }
+        }
+    }
+    {
+        // Самый левый лист начинает группу потомков и лежит в начале строки кэша
+        Vector<uint32_t> sorted(1'000);
+        std::iota(sorted.begin(), sorted.end(), 0);
+        const EytzingerIndex<uint32_t> index(sorted);
+        assert(reinterpret_cast<uintptr_t>(index.LowerBoundKey(0)) % CACHE_LINE_SIZE == 0);
+    }
+}
+
+void TestDaryHeap() {
+    using namespace std::literals;
+    {
+        DaryHeap<int> heap;
+        assert(!heap.Pop().HasValue() && heap.Top() == nullptr);
+        for (int value : {5, 1, 4, 1, 3}) {
+            heap.Push(value);
+        }
+        assert(*heap.Top() == 1);
+        std::vector<int> popped;
+        while (!heap.Empty()) {
+            popped.push_back(*heap.Pop());
+        }
+        assert((popped == std::vector{1, 1, 3, 4, 5}));
+
+        // Группы потомков начинаются с адресов, кратных D * sizeof(T): при 8 * 8 байтах
+        // каждая группа занимает ровно одну строку кэша
+        DaryHeap<uint64_t, 8> wide;
+        for (uint64_t value = 0; value < 100; ++value) {
+            wide.Push(value);
+            assert(reinterpret_cast<uintptr_t>(wide.Top() + 1) % CACHE_LINE_SIZE == 0);
+        }
+        DaryHeap<int> heapified(Vector<int>(5));
+        assert(reinterpret_cast<uintptr_t>(heapified.Top() + 1) % (4 * sizeof(int)) == 0);
+        DaryHeap<int> copy = heapified;
+        copy.Push(-1);
+        assert(*copy.Top() == -1 && copy.Size() == 6 && reinterpret_cast<uintptr_t>(copy.Top() + 1) % (4 * sizeof(int)) == 0);
+    }
+    {
+        // Случайная последовательность операций сверяется с std::priority_queue
+        std::mt19937 generator(42);
+        DaryHeap<std::string, 8, std::greater<std::string>> heap;
+        std::priority_queue<std::string> expected;
+        for (int i = 0; i < 20'000; ++i) {
+            if (expected.empty() || generator() % 3 != 0) {
+                const std::string value = std::to_string(generator() % 1'000);
+                heap.Push(value);
+                expected.push(value);
+            } else {
+                assert(*heap.Pop() == expected.top());
+                expected.pop();
+            }
+            assert(heap.Size() == expected.size());
+        }
+    }
+    {
+        std::mt19937 generator(42);
+        for (size_t size : {0, 1, 2, 5, 100, 1'000}) {
+            Vector<int> items(size);
+            for (int& item : items) {
+                item = static_cast<int>(generator() % 100);
+            }
+            std::vector<int> expected(items.begin(), items.end());
+            std::sort(expected.begin(), expected.end());
+            DaryHeap<int, 3> heap(std::move(items));
+            for (int value : expected) {
+                assert(*heap.Pop() == value);
+            }
+            assert(heap.Empty());
+        }
+    }
+    {
+        // Алгоритм Дейкстры на случайном графе сверяется с решением без кучи
+        std::mt19937 generator(42);
+        const uint32_t n = 300;
+        std::vector<std::vector<std::pair<uint32_t, int>>> graph(n);
+        for (int i = 0; i < 3'000; ++i) {
+            graph[generator() % n].emplace_back(generator() % n, static_cast<int>(generator() % 100));
+        }
+        const int INF = std::numeric_limits<int>::max();
+
+        struct Entry {
+            int distance;
+            uint32_t vertex;
+            bool operator<(const Entry& other) const noexcept {
+                return distance < other.distance;
+            }
+        };
+        DaryHeap<Entry, 4, std::less<Entry>, true> heap;
+        std::vector<int> distance(n, INF);
+        std::vector<HeapHandle> handles(n);
+        std::vector<bool> queued(n, false);
+        distance[0] = 0;
+        handles[0] = heap.Push({0, 0});
+        queued[0] = true;
+        while (!heap.Empty()) {
+            const Entry top = *heap.Pop();
+            queued[top.vertex] = false;
+            for (auto [to, weight] : graph[top.vertex]) {
+                const int candidate = top.distance + weight;
+                if (candidate < distance[to]) {
+                    distance[to] = candidate;
+                    if (queued[to]) {
+                        assert(heap.Contains(handles[to]) && heap.Get(handles[to]).vertex == to);
+                        heap.DecreaseKey(handles[to], {candidate, to});
+                    } else {
+                        handles[to] = heap.Push({candidate, to});
+                        queued[to] = true;
+                    }
+                }
+            }
+        }
+
+        std::vector<int> expected(n, INF);
+        expected[0] = 0;
+        for (uint32_t round = 0; round < n; ++round) {
+            for (uint32_t from = 0; from < n; ++from) {
+                for (auto [to, weight] : graph[from]) {
+                    if (expected[from] != INF && expected[from] + weight < expected[to]) {
+                        expected[to] = expected[from] + weight;
+                    }
+                }
+            }
+        }
+        assert(distance == expected);
+    }
+    {
+        DaryHeap<int, 4, std::less<int>, true> heap;
+        const HeapHandle a = heap.Push(10);
+        const HeapHandle b = heap.Push(20);
+        assert(*heap.Pop() == 10);
+        assert(!heap.Contains(a) && heap.Contains(b));
+        const HeapHandle c = heap.Push(30);
+        assert(c == a);
+        heap.DecreaseKey(c, 5);
+        assert(*heap.Top() == 5 && heap.Get(b) == 20);
+    }
+}
+
+void TestTieredVector() {
+    using namespace std::literals;
+    {
+        TieredVector<std::string, 4> v;
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        v.Insert(v.begin() + 5, "x"s);
+        v.Insert(v.begin(), "y"s);
+        v.Erase(v.begin() + 3);
+        v.PopBack();
+        std::vector<std::string> values(v.begin(), v.end());
+        assert((values == std::vector{"y"s, "0"s, "1"s, "3"s, "4"s, "x"s, "5"s, "6"s, "7"s, "8"s}));
+        const TieredVector<std::string, 4> copy(v);
+        assert(copy.Size() == v.Size() && copy[5] == "x"s);
+        std::string joined;
+        copy.ForEach([&joined](const std::string& value) {
+            joined += value;
+        });
+        assert(joined == "y0134x5678"s);
+    }
+    {
+        // Случайные вставки и удаления сверяются с std::vector
+        std::mt19937 generator(42);
+        TieredVector<int, 8> v;
+        std::vector<int> expected;
+        for (int i = 0; i < 20'000; ++i) {
+            if (expected.empty() || generator() % 3 != 0) {
+                const size_t pos = generator() % (expected.size() + 1);
+                v.Insert(v.cbegin() + pos, i);
+                expected.insert(expected.begin() + pos, i);
+            } else {
+                const size_t pos = generator() % expected.size();
+                v.Erase(v.cbegin() + pos);
+                expected.erase(expected.begin() + pos);
+            }
+        }
+        assert(v.Size() == expected.size());
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+        for (size_t i = 0; i < expected.size(); i += 97) {
+            assert(v[i] == expected[i]);
+        }
+    }
+    {
+        Obj::ResetCounters();
+        {
+            TieredVector<Obj, 2> v;
+            for (int i = 0; i < 9; ++i) {
+                v.EmplaceBack(i);
+            }
+            v.Erase(v.begin() + 4);
+            v.Emplace(v.begin() + 1, 100);
+            assert(Obj::GetAliveObjectCount() == 9);
+            assert(v[1].id == 100 && v[5].id == 5);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void TestDeque() {
+    using namespace std::literals;
+    {
+        Deque<std::string, 4> d;
+        assert(d.Empty());
+        for (int i = 0; i < 10; ++i) {
+            d.PushBack(std::to_string(i));
+            d.PushFront("-"s + std::to_string(i));
+        }
+        assert(d.Size() == 20 && d[0] == "-9"s && d[19] == "9"s && d[10] == "0"s);
+        d.PopFront();
+        d.PopBack();
+        const Deque<std::string, 4> copy(d);
+        assert((std::vector<std::string>(copy.begin(), copy.end())
+                == std::vector{"-8"s, "-7"s, "-6"s, "-5"s, "-4"s, "-3"s, "-2"s, "-1"s, "-0"s,
+                               "0"s, "1"s, "2"s, "3"s, "4"s, "5"s, "6"s, "7"s, "8"s}));
+        // Ссылки на элементы не инвалидируются вставкой с краёв
+        d.PushBack(d[0]);
+        assert(d[d.Size() - 1] == "-8"s);
+    }
+    {
+        // Случайная последовательность операций сверяется с std::deque
+        std::mt19937 generator(42);
+        Deque<int, 8> d;
+        std::deque<int> expected;
+        for (int i = 0; i < 50'000; ++i) {
+            switch (generator() % 4) {
+            case 0:
+                d.PushBack(i);
+                expected.push_back(i);
+                break;
+            case 1:
+                d.PushFront(i);
+                expected.push_front(i);
+                break;
+            case 2:
+                if (!expected.empty()) {
+                    d.PopBack();
+                    expected.pop_back();
+                }
+                break;
+            default:
+                if (!expected.empty()) {
+                    d.PopFront();
+                    expected.pop_front();
+                }
+            }
+            assert(d.Size() == expected.size());
+            if (!expected.empty()) {
+                assert(d[0] == expected.front() && d[d.Size() - 1] == expected.back());
+                assert(d.Front() == expected.front() && d.Back() == expected.back());
+            }
+        }
+        assert(std::equal(d.begin(), d.end(), expected.begin(), expected.end()));
+    }
+    {
+        // Скользящее окно после разгона не выделяет память
+        Deque<int, 16> d;
+        for (int i = 0; i < 100; ++i) {
+            d.PushBack(i);
+        }
+        const auto slide = [&d] {
+            for (int i = 0; i < 10'000; ++i) {
+                d.PopFront();
+                d.PushBack(i);
+            }
+            for (int i = 0; i < 10'000; ++i) {
+                d.PopBack();
+                d.PushFront(i);
+            }
+        };
+        // Первый проход может добавить блок, когда окно пересекает на одну границу больше
+        slide();
+        const size_t allocations = d.BlockAllocations();
+        slide();
+        assert(d.BlockAllocations() == allocations);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            Deque<Obj, 2> d;
+            d.EmplaceBack(1);
+            d.EmplaceFront(2);
+            Obj::default_construction_throw_countdown = 1;
+            try {
+                d.EmplaceFront();
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            Obj::default_construction_throw_countdown = 1;
+            try {
+                d.EmplaceBack();
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(d.Size() == 2 && d[0].id == 2 && d[1].id == 1);
+            d.EmplaceBack(5);
+            assert(Obj::GetAliveObjectCount() == 3);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Полный интерфейс итератора произвольного доступа и приведение к const_iterator
+        Deque<int, 4> d;
+        for (int i = 0; i < 20; ++i) {
+            d.PushFront(i);
+        }
+        const Deque<int, 4>::const_iterator first = d.begin();
+        auto it = d.begin() + 12;
+        assert(it >= d.begin() && it > first && first <= it && first < it && !(it <= first));
+        assert(it - first == 12 && first == d.begin() && first != it);
+        it -= 3;
+        assert(*it == 10 && it[2] == 8 && (2 + it)[-1] == 9);
+        std::sort(d.begin(), d.end());
+        assert(std::is_sorted(first, std::as_const(d).end()) && d[0] == 0 && d[19] == 19);
+        assert(std::lower_bound(std::as_const(d).begin(), std::as_const(d).end(), 7) - first == 7);
+        assert(*std::prev(d.end()) == 19 && std::distance(first, std::as_const(d).end()) == 20);
+    }
+}
+
+void TestBitVector() {
+    {
+        BitVector bits;
+        assert(bits.Empty() && bits.FindFirst() == 0 && bits.Count() == 0);
+        for (int i = 0; i < 200; ++i) {
+            bits.PushBack(i % 3 == 0);
+        }
+        assert(bits.Size() == 200 && bits.Capacity() >= 200);
+        assert(bits.Test(0) && !bits.Test(1) && bits.Test(198));
+        assert(bits.Count() == 67);
+        assert(bits.FindFirst() == 0 && bits.FindNext(0) == 3 && bits.FindNext(196) == 198 && bits.FindNext(198) == 200);
+        bits.Set(1);
+        bits.Reset(0);
+        assert(bits.FindFirst() == 1);
+        bits.PopBack();
+        bits.PopBack();
+        assert(bits.Size() == 198 && bits.Count() == 66);
+        // Биты за пределами размера не всплывают при повторном росте
+        bits.PushBack(false);
+        bits.PushBack(false);
+        assert(bits.Count() == 66);
+
+        BitVector ones(130, true);
+        assert(ones.Count() == 130);
+        ones.Resize(10);
+        ones.Resize(140, false);
+        assert(ones.Count() == 10);
+        ones.Resize(150, true);
+        assert(ones.Count() == 20 && ones.Test(149) && !ones.Test(139));
+    }
+    {
+        // Поразрядные операции и подсчёт на всех уровнях SIMD сверяются с побитовым расчётом
+        std::mt19937_64 generator(42);
+        const size_t size = 10'007;
+        BitVector lhs(size);
+        BitVector rhs(size);
+        std::vector<bool> expected_lhs(size);
+        std::vector<bool> expected_rhs(size);
+        for (size_t i = 0; i < size; ++i) {
+            expected_lhs[i] = generator() % 3 == 0;
+            expected_rhs[i] = generator() % 2 == 0;
+            lhs.Set(i, expected_lhs[i]);
+            rhs.Set(i, expected_rhs[i]);
+        }
+        for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2}) {
+            BitVector and_bits(lhs);
+            BitVector or_bits(lhs);
+            BitVector xor_bits(lhs);
+            and_bits.And(rhs, level);
+            or_bits.Or(rhs, level);
+            xor_bits.Xor(rhs, level);
+            size_t and_count = 0;
+            for (size_t i = 0; i < size; ++i) {
+                assert(and_bits.Test(i) == (expected_lhs[i] && expected_rhs[i]));
+                assert(or_bits.Test(i) == (expected_lhs[i] || expected_rhs[i]));
+                assert(xor_bits.Test(i) == (expected_lhs[i] != expected_rhs[i]));
+                and_count += expected_lhs[i] && expected_rhs[i];
+            }
+            assert(and_bits.Count(level) == and_count);
+        }
+        // Функции без popcnt, которые используются на процессорах без этой инструкции
+        for (size_t num_bits : {size_t{0}, size_t{63}, size_t{64}, size_t{500}, size}) {
+            assert(detail::scalar::CountBitsBefore(lhs.Data(), num_bits) == detail::CountBitsBefore(lhs.Data(), num_bits));
+        }
+        for (size_t one : {size_t{0}, size_t{63}, size_t{64}, size_t{500}, lhs.Count() - 1}) {
+            size_t scalar_rank = one;
+            size_t dispatched_rank = one;
+            assert(detail::scalar::FindWordOfOne(lhs.Data(), scalar_rank) == detail::FindWordOfOne(lhs.Data(), dispatched_rank));
+            assert(scalar_rank == dispatched_rank);
+        }
+
+        const BitRankSelect index(lhs);
+        assert(index.CountOnes() == lhs.Count());
+        size_t rank = 0;
+        for (size_t i = 0; i <= size; ++i) {
+            assert(index.Rank(i) == rank);
+            if (i < size && expected_lhs[i]) {
+                assert(index.Select(rank) == i);
+                ++rank;
+            }
+        }
+        assert(index.Select(rank) == size);
+        size_t visited = 0;
+        for (size_t i = lhs.FindFirst(); i < lhs.Size(); i = lhs.FindNext(i)) {
+            assert(expected_lhs[i]);
+            ++visited;
+        }
+        assert(visited == rank);
+    }
+}
+
+void TestPackedIntVector() {
+    {
+        const Vector<uint32_t> no_values;
+        PackedIntVector empty(no_values);
+        assert(empty.Size() == 0 && empty.Width() == 1);
+        Vector<uint32_t> decoded;
+        empty.Decode(decoded);
+        assert(decoded.Size() == 0);
+    }
+    {
+        // Ширина выбирается по максимуму, значения пересекают границы слов
+        std::mt19937 generator(42);
+        Vector<uint32_t> values(1'003);
+        for (uint32_t& value : values) {
+            value = generator() % 4096;
+        }
+        values[500] = 4095;
+        const PackedIntVector packed(values);
+        assert(packed.Width() == 12 && packed.Size() == values.Size());
+        assert(packed.MemoryUsage() < values.Size() * sizeof(uint32_t) / 2);
+        for (size_t i = 0; i < values.Size(); ++i) {
+            assert(packed.Get(i) == values[i]);
+        }
+        Vector<uint32_t> decoded;
+        packed.Decode(decoded);
+        assert(std::equal(decoded.begin(), decoded.end(), values.begin(), values.end()));
+
+        PackedIntVector copy(packed);
+        PackedIntVector moved(std::move(copy));
+        assert(moved.Size() == values.Size() && moved[1'002] == values[1'002]);
+    }
+    for (unsigned width = 1; width <= 32; ++width) {
+        // Граничные значения каждой ширины при добавлении по одному
+        const uint32_t max = width == 32 ? ~uint32_t{0} : (uint32_t{1} << width) - 1;
+        PackedIntVector packed(width);
+        for (uint32_t i = 0; i < 200; ++i) {
+            packed.PushBack(i % 3 == 0 ? max : i & max);
+        }
+        Vector<uint32_t> decoded;
+        packed.Decode(decoded);
+        for (uint32_t i = 0; i < 200; ++i) {
+            const uint32_t expected = i % 3 == 0 ? max : i & max;
+            assert(packed.Get(i) == expected && decoded[i] == expected);
+        }
+    }
+    {
+        DeltaVector empty;
+        assert(empty.Size() == 0 && empty.MemoryUsage() == 0);
+    }
+    {
+        // Отсортированные значения с повторами, малыми и предельными разностями
+        std::mt19937 generator(7);
+        Vector<uint32_t> values;
+        uint32_t value = 0;
+        for (size_t i = 0; i < 1'000; ++i) {
+            values.PushBack(value);
+            value += i % 97 == 0 ? 0 : generator() % 16;
+        }
+        values.PushBack(std::numeric_limits<uint32_t>::max());
+        for (size_t i = 0; i < 300; ++i) {
+            values.PushBack(std::numeric_limits<uint32_t>::max());
+        }
+        const DeltaVector deltas(values);
+        assert(deltas.Size() == values.Size());
+        assert(deltas.MemoryUsage() < values.Size() * sizeof(uint32_t));
+        for (size_t i = 0; i < values.Size(); ++i) {
+            assert(deltas.Get(i) == values[i]);
+        }
+        for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2}) {
+            Vector<uint32_t> decoded;
+            deltas.Decode(decoded, level);
+            assert(std::equal(decoded.begin(), decoded.end(), values.begin(), values.end()));
+        }
+
+        DeltaVector appended;
+        for (size_t i = 0; i < 130; ++i) {
+            appended.PushBack(values[i]);
+            assert(appended.Size() == i + 1 && appended[i] == values[i]);
+        }
+    }
+    {
+        // Первый блок из одинаковых значений имеет ширину 0 и не занимает слов
+        DeltaVector deltas;
+        for (size_t i = 0; i < DeltaVector::BLOCK_SIZE; ++i) {
+            deltas.PushBack(7);
+        }
+        assert(deltas.Get(0) == 7 && deltas.Get(DeltaVector::BLOCK_SIZE - 1) == 7);
+        for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE2}) {
+            Vector<uint32_t> decoded;
+            deltas.Decode(decoded, level);
+            assert(decoded.Size() == DeltaVector::BLOCK_SIZE && std::all_of(decoded.begin(), decoded.end(), [](uint32_t value) {
+                return value == 7;
+            }));
+        }
+    }
+}
+
+void TestCompactVector() {
+    static_assert(sizeof(CompactVector<int>) == sizeof(void*));
+    static_assert(sizeof(CompactVector<Obj>) == sizeof(void*));
+    const size_t SIZE = 1'000;
+    const int ID = 42;
+    {
+        CompactVector<int> empty;
+        assert(empty.Size() == 0 && empty.Capacity() == 0 && empty.begin() == nullptr && empty.begin() == empty.end());
+        CompactVector<int> copy(empty);
+        copy = empty;
+        assert(copy.Capacity() == 0);
+    }
+    {
+        Obj::ResetCounters();
+        CompactVector<Obj> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        assert(v.Size() == SIZE && v.Capacity() == 1024);
+        // Рост удваивает ёмкость и перемещает элементы, как Vector
+        assert(Obj::num_copied == 0 && Obj::num_moved == 1023);
+        assert(v[0].id == 0 && v[SIZE - 1].id == static_cast<int>(SIZE - 1));
+
+        v.Insert(v.begin() + 1, Obj{ID});
+        v.Erase(v.begin());
+        assert(v.Size() == SIZE && v[0].id == ID && v[1].id == 1);
+        v.PopBack();
+        v.Resize(10);
+        assert(v.Size() == 10 && v.Capacity() == 1024);
+        v.Resize(20);
+        assert(v.Size() == 20 && v[19].id == 0);
+        assert(static_cast<size_t>(Obj::GetAliveObjectCount()) == v.Size());
+
+        CompactVector<Obj> copy(v);
+        assert(copy.Size() == 20 && copy.Capacity() == 20 && copy[0].id == ID);
+        CompactVector<Obj> assigned(5);
+        assigned = copy;
+        assert(assigned.Size() == 20 && assigned[1].id == 1);
+        copy.Resize(3);
+        assigned = copy;
+        assert(assigned.Size() == 3);
+        CompactVector<Obj> moved(std::move(assigned));
+        assert(moved.Size() == 3 && assigned.Size() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Исключение при добавлении оставляет вектор нетронутым
+        Obj::ResetCounters();
+        CompactVector<Obj> v(2);
+        Obj broken(ID);
+        broken.throw_on_copy = true;
+        try {
+            v.PushBack(broken);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 2 && v.Capacity() == 2);
+        Obj::default_construction_throw_countdown = 3;
+        try {
+            v.Resize(10);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 2);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        CompactVector<TestObj> v(1);
+        // Добавление существующего элемента безопасно при реаллокации
+        v.PushBack(v[0]);
+        v.EmplaceBack(v[1]);
+        assert(v[0].IsAlive() && v[1].IsAlive() && v[2].IsAlive());
+    }
+    {
+        struct alignas(64) Wide {
+            int value = 0;
+        };
+        CompactVector<Wide> v(3);
+        assert(CompactVector<Wide>::HEADER_SIZE == 64);
+        assert(reinterpret_cast<uintptr_t>(v.begin()) % 64 == 0);
+    }
+}
+
+void TestStaticVector() {
+    struct Point {
+        int x;
+        int y;
+    };
+    static_assert(std::is_trivially_copyable_v<StaticVector<int, 8>>);
+    static_assert(std::is_trivially_copyable_v<StaticVector<Point, 4>>);
+    static_assert(!std::is_trivially_copyable_v<StaticVector<Obj, 4>>);
+    static_assert(StaticVector<int, 8>::Capacity() == 8);
+    const int ID = 42;
+    {
+        StaticVector<Point, 4> points;
+        points.PushBack({1, 2});
+        points.EmplaceBack(Point{3, 4});
+        // Тривиально копируемый вектор можно переносить memcpy
+        StaticVector<Point, 4> copy;
+        std::memcpy(static_cast<void*>(&copy), &points, sizeof(points));
+        assert(copy.Size() == 2 && copy[1].x == 3 && copy[1].y == 4);
+    }
+    {
+        StaticVector<int, 3> v;
+        assert(v.TryPushBack(1) && v.TryPushBack(2) && v.TryPushBack(3));
+        assert(!v.TryPushBack(4) && v.TryEmplaceBack(4) == nullptr && v.Size() == 3);
+        try {
+            v.PushBack(4);
+            assert(false);
+        } catch (const std::length_error&) {
+        }
+        try {
+            v.Resize(4);
+            assert(false);
+        } catch (const std::length_error&) {
+        }
+        v.Erase(v.begin());
+        v.Insert(v.begin() + 1, 5);
+        assert(v.Size() == 3 && v[0] == 2 && v[1] == 5 && v[2] == 3);
+        v.PopBack();
+        v.Resize(3);
+        assert(v[2] == 0);
+    }
+    {
+        Obj::ResetCounters();
+        StaticVector<Obj, 8> v(2);
+        v.EmplaceBack(ID);
+        v.Insert(v.begin(), Obj{ID + 1});
+        assert(v.Size() == 4 && v[0].id == ID + 1 && v[3].id == ID);
+        assert(static_cast<size_t>(Obj::GetAliveObjectCount()) == v.Size());
+
+        StaticVector<Obj, 8> copy(v);
+        assert(copy.Size() == 4 && copy[3].id == ID);
+        StaticVector<Obj, 8> assigned(6);
+        assigned = copy;
+        assert(assigned.Size() == 4 && assigned[0].id == ID + 1);
+        copy.Resize(1);
+        assigned = std::move(copy);
+        assert(assigned.Size() == 1 && assigned[0].id == ID + 1);
+        StaticVector<Obj, 8> moved(std::move(v));
+        assert(moved.Size() == 4 && moved[3].id == ID);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Исключение конструктора не меняет размер
+        Obj::ResetCounters();
+        StaticVector<Obj, 4> v(1);
+        Obj::default_construction_throw_countdown = 2;
+        try {
+            v.Resize(4);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 1 && Obj::GetAliveObjectCount() == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void TestCowVector() {
+    const int ID = 42;
+    {
+        CowVector<int> empty;
+        CowVector<int> copy(empty);
+        assert(copy.Size() == 0 && copy.UseCount() == 0 && copy.cbegin() == copy.cend());
+        copy.PushBack(1);
+        assert(copy.Size() == 1 && empty.Size() == 0 && copy.UseCount() == 1);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> source;
+        for (int i = 0; i < 10; ++i) {
+            source.EmplaceBack(i);
+        }
+        CowVector<Obj> original(std::move(source));
+        CowVector<Obj> copy(original);
+        CowVector<Obj> assigned;
+        assigned = copy;
+        // Копии разделяют буфер, элементы не копируются
+        assert(original.UseCount() == 3 && copy.cbegin() == original.cbegin() && Obj::num_copied == 0);
+        const CowVector<Obj>& view = copy;
+        assert(view[3].id == 3 && view.Size() == 10);
+
+        // Первая запись копирует буфер один раз, сразу с местом под новый элемент
+        copy.EmplaceBack(ID);
+        assert(Obj::num_copied == 10 && copy.Capacity() == 11);
+        assert(copy.UseCount() == 1 && original.UseCount() == 2 && copy.cbegin() != original.cbegin());
+        assert(copy.Size() == 11 && original.Size() == 10 && copy[10].id == ID);
+        copy[0].id = ID;
+        copy.Erase(copy.cbegin() + 1);
+        assert(Obj::num_copied == 10 && original[0].id == 0 && original[1].id == 1);
+
+        // Позиция в разделяемом буфере переводится в индекс копии
+        assigned.Insert(assigned.cbegin() + 2, Obj(ID + 1));
+        assert(assigned.Size() == 11 && assigned[2].id == ID + 1 && original.Size() == 10 && original.UseCount() == 1);
+        original.PopBack();
+        assert(original.Size() == 9 && Obj::num_copied == 20);
+
+        CowVector<Obj> moved(std::move(assigned));
+        assert(moved.Size() == 11 && assigned.Size() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Копии живут в разных потоках, каждый поток меняет свою
+        CowVector<int> shared(Vector<int>(1'000));
+        std::vector<std::thread> threads;
+        std::atomic<size_t> sums{0};
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([shared, t, &sums]() mutable {
+                for (int i = 0; i < 1'000; ++i) {
+                    CowVector<int> local(shared);
+                    sums += static_cast<size_t>(local.Size());
+                }
+                shared[0] = t;
+                sums += static_cast<size_t>(shared[0]);
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        assert(shared.UseCount() == 1 && shared[0] == 0 && sums == 4'000'006);
+    }
+    {
+        // Ссылка и итератор, выданные до копирования, не должны менять копию
+        CowVector<int> original(Vector<int>(3));
+        int& first = original[0];
+        const CowVector<int> copy(original);
+        first = ID;
+        assert(copy[0] == 0 && original.UseCount() == 1 && copy.UseCount() == 1);
+
+        CowVector<int> iterated(Vector<int>(3));
+        const auto it = iterated.begin();
+        const CowVector<int> iterated_copy(iterated);
+        *it = ID;
+        assert(iterated_copy[0] == 0 && iterated[0] == ID);
+
+        // Чтение через константный доступ оставляет буфер разделяемым
+        CowVector<int> read(copy);
+        int sum = 0;
+        for (int value : std::as_const(read)) {
+            sum += value;
+        }
+        read.PushBack(1);
+        const CowVector<int> read_copy(read);
+        assert(sum == 0 && read.UseCount() == 2 && read_copy.cbegin() == read.cbegin());
+    }
+}
+
+void TestPersistentVector() {
+    auto equals = [](const PersistentVector<int>& vector, const std::vector<int>& expected) {
+        if (vector.Size() != expected.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < expected.size(); ++i) {
+            if (vector[i] != expected[i]) {
+                return false;
+            }
+        }
+        const Vector<int> values = vector.ToVector();
+        return std::equal(values.begin(), values.end(), expected.begin(), expected.end());
+    };
+    {
+        // Старые версии не меняются при PushBack и Set
+        PersistentVector<int> empty;
+        std::vector<PersistentVector<int>> versions{empty};
+        std::vector<int> expected;
+        for (int i = 0; i < 2'000; ++i) {
+            versions.push_back(versions.back().PushBack(i));
+        }
+        const PersistentVector<int> edited = versions.back().Set(0, -1).Set(1'000, -2).Set(1'999, -3);
+        for (int i = 0; i <= 2'000; i += 97) {
+            expected.resize(i);
+            std::iota(expected.begin(), expected.end(), 0);
+            assert(equals(versions[i], expected));
+        }
+        expected.resize(2'000);
+        std::iota(expected.begin(), expected.end(), 0);
+        assert(equals(versions.back(), expected));
+        expected[0] = -1;
+        expected[1'000] = -2;
+        expected[1'999] = -3;
+        assert(equals(edited, expected));
+    }
+    {
+        // Transient меняет свои узлы на месте и не трогает исходную версию
+        Vector<int> source(5'000);
+        std::iota(source.begin(), source.end(), 0);
+        const PersistentVector<int> base(source);
+        PersistentVector<int>::Transient transient = base.AsTransient();
+        for (int i = 0; i < 100; ++i) {
+            transient.PushBack(5'000 + i);
+        }
+        transient.Set(10, -10);
+        transient.Set(4'000, -4'000);
+        const PersistentVector<int> built = transient.Persistent();
+        assert(transient.Size() == 0 && built.Size() == 5'100 && base.Size() == 5'000);
+        assert(base[10] == 10 && base[4'000] == 4'000 && built[10] == -10 && built[4'000] == -4'000 && built[5'099] == 5'099);
+        const Vector<int> round_trip = base.ToVector();
+        assert(std::equal(round_trip.begin(), round_trip.end(), source.begin(), source.end()));
+    }
+    {
+        // Случайные Concat, Slice, PushBack и Set сверяются с std::vector
+        std::mt19937 generator(42);
+        std::vector<PersistentVector<int>> vectors(1);
+        std::vector<std::vector<int>> expected(1);
+        for (int step = 0; step < 600; ++step) {
+            const size_t a = generator() % vectors.size();
+            const size_t b = generator() % vectors.size();
+            PersistentVector<int> vector;
+            std::vector<int> values;
+            switch (generator() % 4) {
+            case 0: {
+                vector = vectors[a];
+                values = expected[a];
+                for (size_t i = generator() % 300; i > 0; --i) {
+                    vector = vector.PushBack(step);
+                    values.push_back(step);
+                }
+                break;
+            }
+            case 1:
+                vector = vectors[a].Concat(vectors[b]);
+                values = expected[a];
+                values.insert(values.end(), expected[b].begin(), expected[b].end());
+                break;
+            case 2: {
+                const size_t end = generator() % (expected[a].size() + 1);
+                const size_t begin = generator() % (end + 1);
+                vector = vectors[a].Slice(begin, end);
+                values.assign(expected[a].begin() + begin, expected[a].begin() + end);
+                break;
+            }
+            default:
+                vector = vectors[a];
+                values = expected[a];
+                if (!values.empty()) {
+                    const size_t index = generator() % values.size();
+                    vector = vector.Set(index, -step);
+                    values[index] = -step;
+                }
+            }
+            // Размер ограничен, чтобы Concat не удваивал векторы бесконечно
+            if (values.size() < 200'000) {
+                assert(equals(vector, values));
+                vectors.push_back(vector);
+                expected.push_back(values);
+            }
+        }
+        for (size_t i = 0; i < vectors.size(); ++i) {
+            assert(equals(vectors[i], expected[i]));
+        }
+    }
+    {
+        // Все элементы разрушаются, когда исчезает последняя версия
+        Obj::ResetCounters();
+        {
+            PersistentVector<Obj> vector;
+            for (int i = 0; i < 100; ++i) {
+                vector = vector.PushBack(Obj(i));
+            }
+            const PersistentVector<Obj> slice = vector.Slice(10, 90).Concat(vector.Slice(0, 50));
+            assert(slice.Size() == 130 && slice[0].id == 10 && slice[80].id == 0 && slice[129].id == 49);
+            PersistentVector<Obj>::Transient transient = slice.AsTransient();
+            transient.Set(5, Obj(-1));
+            assert(transient[5].id == -1 && slice[5].id == 15);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void TestSpan() {
+    Vector<int> v(100);
+    std::iota(v.begin(), v.end(), 0);
+    {
+        Span<int> s = v.AsSpan();
+        Span<const int> cs = s;
+        assert(cs.Data() == v.begin() && cs.Size() == 100);
+        assert(std::as_const(v).AsSpan().Data() == v.begin());
+
+        Span<int> middle = s.Subspan(10, 20);
+        assert(middle.Size() == 20 && middle[0] == 10 && middle[19] == 29);
+        assert(s.Subspan(90).Size() == 10 && s.Subspan(90)[0] == 90);
+        assert(s.Subspan(100).Empty());
+        assert(middle.First(5).Size() == 5 && middle.First(5)[4] == 14);
+        assert(middle.Last(5).Size() == 5 && middle.Last(5)[0] == 25);
+        assert(middle.First(0).Empty() && middle.Last(20).Data() == middle.Data());
+
+        RawMemory<int> memory(16);
+        assert(memory.AsSpan().Data() == memory.GetAddress() && memory.AsSpan().Size() == 16);
+    }
+    {
+        // Каждый третий элемент, в том числе как диапазон для стандартных алгоритмов
+        StridedSpan<int> every_third = v.AsSpan().Subspan(1).Stride(3);
+        assert(every_third.Size() == 33 && every_third.Stride() == 3);
+        assert(every_third[0] == 1 && every_third[32] == 97);
+        assert(std::accumulate(every_third.begin(), every_third.end(), 0) == 33 * (1 + 97) / 2);
+        assert(v.AsSpan().Stride(3).Size() == 34 && v.AsSpan().Stride(1).Size() == 100);
+        assert(every_third.end() - every_third.begin() == 33);
+
+        std::reverse(every_third.begin(), every_third.end());
+        assert(v[1] == 97 && v[97] == 1 && v[0] == 0 && v[2] == 2);
+        std::sort(every_third.begin(), every_third.end());
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v[i] == static_cast<int>(i));
+        }
+        StridedSpan<int>::iterator it = every_third.begin() + 10;
+        assert(*it == 31 && it[-1] == 28 && *(it - 10) == 1 && it > every_third.begin());
+    }
+    {
+        // Параллельные алгоритмы на части вектора не затрагивают остальные элементы
+        const ParallelPolicy policy{4, 8};
+        Span<int> middle = v.AsSpan().Subspan(10, 80);
+        ParallelForEach(policy, middle, [](int& value) {
+            value = -value;
+        });
+        assert(v[9] == 9 && v[10] == -10 && v[89] == -89 && v[90] == 90);
+        assert(ParallelReduce(policy, Span<const int>(middle), 0) == -(10 + 89) * 80 / 2);
+
+        Vector<long long> squares(80);
+        ParallelTransform(policy, middle, squares.AsSpan(), [](int value) {
+            return static_cast<long long>(value) * value;
+        });
+        assert(squares[0] == 100 && squares[79] == 89 * 89);
+
+        ParallelSort(policy, middle);
+        assert(v[10] == -89 && v[89] == -10 && v[9] == 9 && v[90] == 90);
+        ParallelSort(policy, middle, std::greater<>{});
+        assert(v[10] == -10 && v[89] == -89);
+
+        RadixSort(middle);
+        assert(std::is_sorted(middle.begin(), middle.end()) && v[10] == -89 && v[90] == 90);
+        RadixSort(policy, v.AsSpan().First(50), [](int value) {
+            return -value;
+        });
+        assert(v[0] == 9 && v[49] == -89 && v[50] == -49);
+    }
+    {
+        // SIMD-поиск и агрегаты по части вектора
+        Vector<int32_t> values(1000);
+        std::iota(values.begin(), values.end(), 0);
+        Span<const int32_t> part = std::as_const(values).AsSpan().Subspan(100, 200);
+        assert(Find(part, 150) == values.begin() + 150);
+        assert(Find(part, 50) == part.end() && !Contains(part, 300) && Contains(part, 299));
+        assert(Count(values.AsSpan().First(10), 5) == 1);
+        assert(*Min(part) == 100 && *Max(part) == 299);
+        assert(Sum(part) == (100 + 299) * 200 / 2);
+        assert(!Min(part.First(0)).HasValue());
+    }
+}
+
+void TestAdoptRelease() {
+    using namespace std::literals;
+    static int num_freed;
+    auto counting_free = [](void* buffer, void* context) {
+        ++*static_cast<int*>(context);
+        std::free(buffer);
+    };
+    {
+        // Буфер из malloc принимается без копирования и освобождается переданной функцией
+        num_freed = 0;
+        int* raw = static_cast<int*>(std::malloc(8 * sizeof(int)));
+        std::iota(raw, raw + 5, 0);
+        {
+            Vector<int> v = Vector<int>::Adopt(raw, 5, 8, counting_free, &num_freed);
+            assert(v.begin() == raw && v.Size() == 5 && v.Capacity() == 8 && v[4] == 4);
+            v.PushBack(5);
+            v.PushBack(6);
+            v.PushBack(7);
+            assert(v.begin() == raw && num_freed == 0);
+            // Рост переносит элементы в собственный буфер и освобождает чужой
+            v.PushBack(8);
+            assert(v.begin() != raw && num_freed == 1 && v.Size() == 9 && v[0] == 0 && v[8] == 8);
+        }
+        assert(num_freed == 1);
+
+        Vector<int> v = Vector<int>::Adopt(static_cast<int*>(std::malloc(4 * sizeof(int))), 0, 4, FreeBuffer);
+        v.PushBack(1);
+        Vector<int> copy = v;
+        assert(copy.Size() == 1 && copy[0] == 1);
+    }
+    {
+        // Release отдаёт буфер вектора вместе с элементами
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.Reserve(10);
+        for (int i = 0; i < 3; ++i) {
+            v.EmplaceBack(i);
+        }
+        const Obj* data = v.begin();
+        OwnedBuffer<Obj> buffer = v.Release();
+        assert(v.Size() == 0 && v.Capacity() == 0 && v.begin() == nullptr);
+        assert(buffer.data == data && buffer.size == 3 && buffer.capacity == 10);
+        assert(Obj::GetAliveObjectCount() == 3);
+
+        Vector<Obj> adopted = Vector<Obj>::Adopt(buffer);
+        assert(adopted.begin() == data && adopted.Size() == 3 && adopted[2].id == 2);
+        buffer = adopted.Release();
+        std::destroy_n(buffer.data, buffer.size);
+        buffer.Free();
+        assert(Obj::GetAliveObjectCount() == 0 && Obj::num_copied == 0 && Obj::num_moved == 0);
+
+        RawMemory<int> memory(4);
+        OwnedBuffer<int> raw = memory.Release();
+        assert(memory.GetAddress() == nullptr && memory.Capacity() == 0 && raw.capacity == 4);
+        RawMemory<int> readopted = RawMemory<int>::Adopt(raw.data, raw.capacity, raw.deleter, raw.context);
+        assert(readopted.GetAddress() == raw.data);
+    }
+    {
+        // Буфер std::vector переходит в Vector и обратно без копирования
+        std::vector<int> source(100);
+        std::iota(source.begin(), source.end(), 0);
+        source.reserve(200);
+        const int* data = source.data();
+        Vector<int> v = Vector<int>::FromStdVector(std::move(source));
+        assert(v.begin() == data && v.Size() == 100 && v.Capacity() == 200 && v[99] == 99);
+        for (int i = 100; i < 150; ++i) {
+            v.PushBack(i);
+        }
+        std::vector<int> back = std::move(v).ToStdVector();
+        assert(back.data() == data && back.size() == 150 && v.Size() == 0);
+        for (int i = 0; i < 150; ++i) {
+            assert(back[i] == i);
+        }
+
+        Vector<int> shrunk = Vector<int>::FromStdVector(std::move(back));
+        shrunk.Resize(10);
+        back = std::move(shrunk).ToStdVector();
+        assert(back.data() == data && back.size() == 10 && back[9] == 9);
+
+        // Без чужого буфера элементы перемещаются
+        Vector<std::string> strings;
+        strings.PushBack("a long string that does not fit into SSO"s);
+        strings.PushBack("b"s);
+        std::vector<std::string> std_strings = std::move(strings).ToStdVector();
+        assert(std_strings.size() == 2 && std_strings[0] == "a long string that does not fit into SSO"s);
+        Vector<std::string> from_std = Vector<std::string>::FromStdVector(std::move(std_strings));
+        assert(from_std.Size() == 2 && from_std[1] == "b"s && std_strings.empty());
+        assert(Vector<int>::FromStdVector({}).Capacity() == 0);
+    }
+    {
+        // Поддержка чужих буферов не увеличивает RawMemory и Vector
+        static_assert(sizeof(RawMemory<int>) == 2 * sizeof(void*));
+        static_assert(sizeof(Vector<int>) == 3 * sizeof(void*));
+        num_freed = 0;
+        Vector<int> first = Vector<int>::Adopt(static_cast<int*>(std::malloc(4 * sizeof(int))), 0, 4, counting_free, &num_freed);
+        Vector<int> second = Vector<int>::Adopt(static_cast<int*>(std::malloc(4 * sizeof(int))), 0, 4, FreeBuffer);
+        first.Swap(second);
+        assert(first.Capacity() == 4 && second.Capacity() == 4);
+        OwnedBuffer<int> released = second.Release();
+        assert(released.capacity == 4 && released.deleter == counting_free && released.context == &num_freed);
+        released.Free();
+        assert(num_freed == 1);
+
+        // Одна и та же память может быть принята несколькими векторами, например
+        // как представление над статическим массивом с пустой функцией освобождения
+        static int shared[4] = {1, 2, 3, 4};
+        static int num_released;
+        num_released = 0;
+        auto count_release = [](void*, void*) {
+            ++num_released;
+        };
+        {
+            Vector<int> lhs = Vector<int>::Adopt(shared, 4, 4, count_release);
+            Vector<int> rhs = Vector<int>::Adopt(shared, 2, 4, count_release);
+            assert(lhs.begin() == rhs.begin() && lhs[3] == 4 && rhs.Size() == 2 && rhs.Capacity() == 4);
+        }
+        assert(num_released == 2);
+    }
+}
+
+void TestViews() {
+    using namespace std::literals;
+    Vector<int> v(10);
+    std::iota(v.begin(), v.end(), 0);
+    {
+        // Размер Map известен заранее, и CollectInto резервирует память ровно один раз
+        Vector<int> squares;
+        Map(v, [](int x) {
+            return x * x;
+        }).CollectInto(squares);
+        assert(squares.Size() == 10 && squares.Capacity() == 10 && squares[9] == 81);
+
+        Vector<int> evens = Filter(v, [](int x) {
+            return x % 2 == 0;
+        }).Collect();
+        assert(evens.Size() == 5 && evens[4] == 8);
+
+        // CollectInto дописывает в конец
+        Take(v, 3).CollectInto(evens);
+        assert(evens.Size() == 8 && evens[5] == 0 && evens[7] == 2);
+
+        Vector<double> halves = Map(v, [](int x) {
+            return x / 2.0;
+        }).Collect<double>();
+        assert(halves[3] == 1.5);
+    }
+    {
+        // Цепочка вычисляется за один проход, Take прекращает чтение источника
+        int predicate_calls = 0;
+        const auto result = View(v)
+                                .Filter([&predicate_calls](int x) {
+                                    ++predicate_calls;
+                                    return x % 3 == 0;
+                                })
+                                .Map([](int x) {
+                                    return x * 10;
+                                })
+                                .Enumerate()
+                                .Take(2)
+                                .Collect();
+        assert(result.Size() == 2 && predicate_calls == 4);
+        assert(result[0] == std::make_pair(size_t{0}, 0) && result[1] == std::make_pair(size_t{1}, 30));
+        assert(!Filter(v, [](int) {
+                    return true;
+                }).SizeHint().HasValue());
+        assert(*Take(v, 100).SizeHint() == 10 && Take(v, 0).Collect().Size() == 0);
+    }
+    {
+        // Элементы неконстантного вектора изменяются через представление
+        for (int& x : Filter(v, [](int x) {
+                 return x >= 5;
+             })) {
+            x = -x;
+        }
+        assert(v[4] == 4 && v[5] == -5 && v[9] == -9);
+        for (auto [index, x] : Enumerate(v)) {
+            x = static_cast<int>(index);
+        }
+        assert(v[9] == 9);
+    }
+    {
+        Vector<std::string> names;
+        names.PushBack("zero"s);
+        names.PushBack("one"s);
+        names.PushBack("two"s);
+        Vector<std::pair<int, std::string>> pairs = Zip(v, names).Collect();
+        assert(pairs.Size() == 3 && pairs[2].first == 2 && pairs[2].second == "two"s);
+        assert(*Zip(v, names).SizeHint() == 3);
+        for (auto [number, name] : Zip(v.AsSpan().Subspan(1), names)) {
+            name += std::to_string(number);
+        }
+        assert(names[0] == "zero1"s && names[2] == "two3"s);
+    }
+    {
+        // Части - представления над элементами источника
+        Vector<int> sums = Chunk(v, 4)
+                               .Map([](RangeView<int*> chunk) {
+                                   return std::accumulate(chunk.begin(), chunk.end(), 0);
+                               })
+                               .Collect();
+        assert(sums.Size() == 3 && sums[0] == 6 && sums[1] == 22 && sums[2] == 17);
+        assert(*Chunk(v, 4).SizeHint() == 3 && *Chunk(v, 5).SizeHint() == 2);
+
+        // Части отфильтрованной последовательности
+        Vector<size_t> sizes = Chunk(Filter(v,
+                                            [](int x) {
+                                                return x % 2 == 1;
+                                            }),
+                                     2)
+                                   .Map([](auto chunk) {
+                                       return static_cast<size_t>(std::distance(chunk.begin(), chunk.end()));
+                                   })
+                                   .Collect();
+        assert(sizes.Size() == 3 && sizes[0] == 2 && sizes[2] == 1);
+
+        // Граница части на последнем взятом элементе Take не теряет его
+        Vector<int> take_sums = Chunk(Take(v, 3), 2)
+                                    .Map([](auto chunk) {
+                                        return std::accumulate(chunk.begin(), chunk.end(), 0);
+                                    })
+                                    .Collect();
+        assert(take_sums.Size() == 2 && take_sums[0] == 1 && take_sums[1] == 2);
+        Vector<size_t> indices = Chunk(Enumerate(Take(v, 3)), 2)
+                                     .Map([](auto chunk) {
+                                         size_t last = 0;
+                                         for (auto [index, x] : chunk) {
+                                             last = index;
+                                         }
+                                         return last;
+                                     })
+                                     .Collect();
+        assert(indices.Size() == 2 && indices[0] == 1 && indices[1] == 2);
+
+        // Источник короче count: конец наступает по концу источника
+        assert(Take(Filter(v,
+                           [](int x) {
+                               return x > 7;
+                           }),
+                    5)
+                   .Collect()
+                   .Size() == 2);
+    }
+}
+
+void TestSerialization() {
+    struct Record {
+        int64_t id;
+        double value;
+        int32_t flags;
+    };
+    {
+        Vector<Record> records;
+        for (int i = 0; i < 100; ++i) {
+            records.PushBack(Record{i, i * 0.5, -i});
+        }
+        Vector<char> buffer;
+        SerializeInto(records, buffer);
+        assert(buffer.Size() == sizeof(SerializationHeader) + 100 * sizeof(Record));
+
+        const Vector<Record> copy = Deserialize<Record>(buffer.AsSpan());
+        assert(copy.Size() == 100 && copy[99].id == 99 && copy[99].value == 49.5 && copy[99].flags == -99);
+
+        // Представление указывает прямо в буфер
+        const Span<const Record> view = DeserializeView<Record>(buffer.AsSpan());
+        assert(view.Size() == 100 && view.Data() == reinterpret_cast<const Record*>(buffer.begin() + sizeof(SerializationHeader)));
+        assert(view[42].id == 42 && view[42].flags == -42);
+
+        // Неверный тип, повреждённый и невыровненный буфер
+        bool thrown = false;
+        try {
+            Deserialize<int64_t>(buffer.AsSpan());
+        } catch (const SerializationError&) {
+            thrown = true;
+        }
+        assert(thrown);
+        thrown = false;
+        try {
+            Deserialize<Record>(buffer.AsSpan().First(buffer.Size() - 1));
+        } catch (const SerializationError&) {
+            thrown = true;
+        }
+        assert(thrown);
+        thrown = false;
+        try {
+            DeserializeView<Record>(buffer.AsSpan().First(10));
+        } catch (const SerializationError&) {
+            thrown = true;
+        }
+        assert(thrown);
+        Vector<char> shifted(buffer.Size() + 1);
+        std::memcpy(shifted.begin() + 1, buffer.begin(), buffer.Size());
+        thrown = false;
+        try {
+            DeserializeView<Record>(shifted.AsSpan().Subspan(1));
+        } catch (const SerializationError&) {
+            thrown = true;
+        }
+        assert(thrown);
+        // Копирующее чтение не требует выравнивания
+        assert(Deserialize<Record>(shifted.AsSpan().Subspan(1))[7].id == 7);
+        buffer[0] = 'x';
+        thrown = false;
+        try {
+            Deserialize<Record>(buffer.AsSpan());
+        } catch (const SerializationError&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    {
+        // Вложенные Vector и Optional
+        Vector<Vector<Optional<int16_t>>> nested(3);
+        nested[0].PushBack(Optional<int16_t>(7));
+        nested[0].PushBack(Optional<int16_t>());
+        for (int i = 0; i < 50; ++i) {
+            nested[2].PushBack(i % 3 ? Optional<int16_t>(static_cast<int16_t>(i)) : Optional<int16_t>());
+        }
+        Vector<Optional<Vector<double>>> optional_arrays(3);
+        optional_arrays[0] = Vector<double>(40);
+        optional_arrays[0].Value()[39] = 3.5;
+        optional_arrays[2] = Vector<double>();
+
+        Vector<char> buffer;
+        SerializeInto(nested, buffer);
+        const size_t second = buffer.Size();
+        SerializeInto(optional_arrays, buffer);
+
+        const auto nested_copy = Deserialize<Vector<Optional<int16_t>>>(buffer.AsSpan().First(second));
+        assert(nested_copy.Size() == 3 && nested_copy[0].Size() == 2 && nested_copy[1].Size() == 0);
+        assert(*nested_copy[0][0] == 7 && !nested_copy[0][1].HasValue());
+        for (int i = 0; i < 50; ++i) {
+            assert(nested_copy[2][i].HasValue() == (i % 3 != 0));
+            assert(i % 3 == 0 || *nested_copy[2][i] == i);
+        }
+        const auto arrays_copy = Deserialize<Optional<Vector<double>>>(buffer.AsSpan().Subspan(second));
+        assert(arrays_copy.Size() == 3 && arrays_copy[0]->Size() == 40 && (*arrays_copy[0])[39] == 3.5);
+        assert(!arrays_copy[1].HasValue() && arrays_copy[2]->Size() == 0);
+
+        const Vector<int> empty;
+        Vector<char> empty_buffer;
+        SerializeInto(empty, empty_buffer);
+        assert(Deserialize<int>(empty_buffer.AsSpan()).Size() == 0 && DeserializeView<int>(empty_buffer.AsSpan()).Empty());
+    }
+    {
+        // Запись в поток и в файловый дескриптор дают те же байты
+        Vector<Vector<int>> values(2);
+        values[1] = Vector<int>(1000);
+        std::iota(values[1].begin(), values[1].end(), 0);
+        Vector<char> expected;
+        SerializeInto(values, expected);
+
+        std::ostringstream stream;
+        SerializeTo(values, stream);
+        const std::string bytes = stream.str();
+        assert(bytes.size() == expected.Size() && std::memcmp(bytes.data(), expected.begin(), bytes.size()) == 0);
+#if VECTOR_POSIX_IO
+        std::FILE* file = std::tmpfile();
+        assert(file);
+        SerializeTo(values, fileno(file));
+        Vector<char> read_back(expected.Size());
+        assert(pread(fileno(file), read_back.begin(), read_back.Size(), 0) == static_cast<ssize_t>(read_back.Size()));
+        std::fclose(file);
+        assert(std::memcmp(read_back.begin(), expected.begin(), expected.Size()) == 0);
+        assert(Deserialize<Vector<int>>(read_back.AsSpan())[1][999] == 999);
+#endif
+    }
+}
+
+void TestLazy() {
+    {
+        // factory вызывается при первом обращении и конструирует значение на месте
+        Obj::ResetCounters();
+        int calls = 0;
+        Lazy lazy([&calls] {
+            ++calls;
+            return Obj(5);
+        });
+        assert(!lazy.IsInitialized() && calls == 0);
+        assert(lazy.Get().id == 5 && lazy->id == 5 && (*lazy).id == 5);
+        assert(lazy.IsInitialized() && calls == 1);
+        assert(Obj::num_copied == 0 && Obj::num_moved == 0 && Obj::GetAliveObjectCount() == 1);
+
+        lazy.Reset();
+        assert(!lazy.IsInitialized() && Obj::GetAliveObjectCount() == 0);
+        assert(lazy.Get().id == 5 && calls == 2);
+    }
+    {
+        // Значение без конструкторов копирования и перемещения
+        struct Pinned {
+            explicit Pinned(int value)
+                : value(value) {
+            }
+            Pinned(const Pinned&) = delete;
+            Pinned(Pinned&&) = delete;
+            int value;
+        };
+        const Lazy<Pinned, Pinned (*)()> pinned([] {
+            return Pinned(7);
+        });
+        assert(pinned->value == 7);
+
+        Optional<Pinned> optional;
+        optional.EmplaceFrom([] {
+            return Pinned(8);
+        });
+        assert(optional->value == 8);
+    }
+    {
+        // После исключения в factory следующий Get() повторяет инициализацию
+        int attempts = 0;
+        Lazy lazy([&attempts] {
+            if (++attempts == 1) {
+                throw std::runtime_error("first attempt fails");
+            }
+            return attempts;
+        });
+        bool thrown = false;
+        try {
+            lazy.Get();
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown && !lazy.IsInitialized());
+        assert(lazy.Get() == 2 && lazy.Get() == 2 && attempts == 2);
+    }
+    {
+        // Одновременные первые обращения: factory выполняется один раз, все видят одно значение
+        std::atomic<int> calls = 0;
+        Lazy lazy([&calls] {
+            ++calls;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            Vector<int> table(1000);
+            std::iota(table.begin(), table.end(), 0);
+            return table;
+        });
+        std::atomic<bool> start = false;
+        std::vector<const Vector<int>*> seen(8);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < seen.size(); ++i) {
+            threads.emplace_back([&, i] {
+                while (!start.load()) {
+                    std::this_thread::yield();
+                }
+                seen[i] = &lazy.Get();
+                assert((*seen[i])[999] == 999);
+            });
+        }
+        start = true;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        assert(calls == 1);
+        for (const Vector<int>* table : seen) {
+            assert(table == &lazy.Get());
+        }
+    }
+}
+
+struct C {
+    C() noexcept {
+        ++def_ctor;
+    }
+    C(const C& /*other*/) noexcept {
+        ++copy_ctor;
+    }
+    C(C&& /*other*/) noexcept {
+        ++move_ctor;
+    }
+    C& operator=(const C& other) noexcept {
+        if (this != &other) {
+            ++copy_assign;
+        }
+        return *this;
+    }
+    C& operator=(C&& /*other*/) noexcept {
+        ++move_assign;
+        return *this;
+    }
+    ~C() {
+        ++dtor;
+    }
+
+    static void Reset() {
+        def_ctor = 0;
+        copy_ctor = 0;
+        move_ctor = 0;
+        copy_assign = 0;
+        move_assign = 0;
+        dtor = 0;
+    }
+
+    inline static size_t def_ctor = 0;
+    inline static size_t copy_ctor = 0;
+    inline static size_t move_ctor = 0;
+    inline static size_t copy_assign = 0;
+    inline static size_t move_assign = 0;
+    inline static size_t dtor = 0;
+};
+
+void Dump() {
+    using namespace std;
+    cerr << "Def ctors: "sv << C::def_ctor              //
+         << ", Copy ctors: "sv << C::copy_ctor          //
+         << ", Move ctors: "sv << C::move_ctor          //
+         << ", Copy assignments: "sv << C::copy_assign  //
+         << ", Move assignments: "sv << C::move_assign  //
+         << ", Dtors: "sv << C::dtor << endl;
+}
+
+void Benchmark() {
+    using namespace std;
+    try {
+        const size_t NUM = 10;
+        C c;
+        {
+            cerr << "std::vector:"sv << endl;
+            C::Reset();
+            vector<C> v(NUM);
+            Dump();
+            v.push_back(c);
+        }
+        Dump();
+    } catch (...) {
+    }
+    try {
+        const size_t NUM = 10;
+        C c;
+        {
+            cerr << "Vector:"sv << endl;
+            C::Reset();
+            Vector<C> v(NUM);
+            Dump();
+            v.PushBack(c);
+        }
+        Dump();
+    } catch (...) {
+    }
+}
+
+void BenchmarkParallelAlgorithms() {
+    using namespace std;
+    const size_t SIZE = 4'000'000;
+    Vector<int> source(SIZE);
+    mt19937 generator(42);
+    for (int& x : source) {
+        x = static_cast<int>(generator());
+    }
+
+    cerr << "Parallel algorithms, "sv << SIZE << " ints:"sv << endl;
+    {
+        Vector<int> v(source);
+        LOG_DURATION("std::for_each"s);
+        for_each(v.begin(), v.end(), [](int& x) {
+            x = x / 3 + 1;
+        });
+    }
+    {
+        Vector<int> v(source);
+        Vector<int> out(SIZE);
+        LOG_DURATION("std::transform"s);
+        transform(v.begin(), v.end(), out.begin(), [](int x) {
+            return x / 7;
+        });
+    }
+    {
+        long long sum = 0;
+        {
+            LOG_DURATION("std::accumulate"s);
+            sum = accumulate(source.begin(), source.end(), 0LL);
+        }
+        cerr << "  sum: "sv << sum << endl;
+    }
+    {
+        Vector<int> v(source);
+        LOG_DURATION("std::sort"s);
+        sort(v.begin(), v.end());
+    }
+    for (size_t threads : {1, 2, 4, 8}) {
+        const ParallelPolicy policy{threads};
+        cerr << "threads: "sv << threads << endl;
+        {
+            Vector<int> v(source);
+            LOG_DURATION("  ParallelForEach"s);
+            ParallelForEach(policy, v, [](int& x) {
+                x = x / 3 + 1;
+            });
+        }
+        {
+            Vector<int> out(SIZE);
+            LOG_DURATION("  ParallelTransform"s);
+            ParallelTransform(policy, source, out, [](int x) {
+                return x / 7;
+            });
+        }
+        {
+            LOG_DURATION("  ParallelReduce"s);
+            [[maybe_unused]] long long sum = ParallelReduce(policy, source, 0LL);
+        }
+        {
+            Vector<int> v(source);
+            LOG_DURATION("  ParallelSort"s);
+            ParallelSort(policy, v);
+        }
+    }
+}
+
+void BenchmarkParallelConstruction() {
+    using namespace std;
+    const size_t SIZE = 50'000'000;
+    const size_t STRINGS = 2'000'000;
+    cerr << "Parallel construction, "sv << SIZE << " ints, "sv << STRINGS << " strings:"sv << endl;
+    {
+        Vector<int> v;
+        {
+            LOG_DURATION("Vector(size_t)"s);
+            Vector<int> tmp(SIZE);
+            v.Swap(tmp);
+        }
+        LOG_DURATION("Vector(const Vector&)"s);
+        Vector<int> copy(v);
+    }
+    {
+        Vector<string> v(STRINGS);
+        for (string& str : v) {
+            str = "a string that does not fit into SSO buffer"s;
+        }
+        LOG_DURATION("~Vector<string>"s);
+        Vector<string> tmp(std::move(v));
+    }
+    for (size_t threads : {1, 2, 4, 8}) {
+        const ParallelPolicy policy{threads};
+        cerr << "threads: "sv << threads << endl;
+        Vector<int> v;
+        {
+            LOG_DURATION("  Vector(size_t, policy)"s);
+            Vector<int> tmp(SIZE, policy);
+            v.Swap(tmp);
+        }
+        {
+            LOG_DURATION("  Vector(const Vector&, policy)"s);
+            Vector<int> copy(v, policy);
+        }
+        Vector<string> strings(STRINGS, policy);
+        for (string& str : strings) {
+            str = "a string that does not fit into SSO buffer"s;
+        }
+        LOG_DURATION("  Clear(policy)"s);
+        strings.Clear(policy);
+    }
+}
+
+void BenchmarkRadixSort() {
+    using namespace std;
+    const size_t SIZE = 5'000'000;
+    mt19937_64 generator(42);
+    Vector<uint64_t> keys(SIZE);
+    for (auto& x : keys) {
+        x = generator();
+    }
+    Vector<float> floats(SIZE);
+    uniform_real_distribution<float> distribution(-1e6f, 1e6f);
+    for (auto& x : floats) {
+        x = distribution(generator);
+    }
+    struct Record {
+        int32_t key;
+        uint32_t payload[3];
+    };
+    Vector<Record> records(SIZE);
+    for (auto& record : records) {
+        record.key = static_cast<int32_t>(generator());
+    }
+
+    cerr << "Radix sort, "sv << SIZE << " elements:"sv << endl;
+    auto bench = [](string_view name, auto& source, auto key_fn) {
+        auto less = [&key_fn](const auto& lhs, const auto& rhs) {
+            return key_fn(lhs) < key_fn(rhs);
+        };
+        cerr << name << endl;
+        {
+            auto v(source);
+            LOG_DURATION("  std::sort"s);
+            sort(v.begin(), v.end(), less);
+        }
+        {
+            auto v(source);
+            LOG_DURATION("  std::stable_sort"s);
+            stable_sort(v.begin(), v.end(), less);
+        }
+        {
+            auto v(source);
+            LOG_DURATION("  RadixSort"s);
+            RadixSort(v, key_fn);
+        }
+        for (size_t threads : {2, 4, 8}) {
+            auto v(source);
+            LOG_DURATION("  RadixSort, "s + to_string(threads) + " threads"s);
+            RadixSort(ParallelPolicy{threads}, v, key_fn);
+        }
+    };
+    bench("uint64_t"sv, keys, [](uint64_t x) {
+        return x;
+    });
+    bench("uint64_t below 2^20"sv, keys, [](uint64_t x) {
+        return x >> 44;
+    });
+    bench("float"sv, floats, [](float x) {
+        return x;
+    });
+    bench("struct by int32_t key"sv, records, [](const Record& record) {
+        return record.key;
+    });
+}
+
+void BenchmarkSimdKernels() {
+    using namespace std;
+    // Каждый замер обрабатывает одинаковое общее число элементов
+    const size_t TOTAL = 64'000'000;
+    cerr << "SIMD kernels, detected level: "sv << static_cast<int>(DetectSimdLevel()) << endl;
+    const pair<string_view, size_t> sizes[] = {
+        {"L1"sv, 4'096}, {"L2"sv, 64'000}, {"L3"sv, 1'000'000}, {"DRAM"sv, 16'000'000}};
+    const pair<string_view, SimdLevel> levels[] = {
+        {"scalar"sv, SimdLevel::SCALAR}, {"SSE2"sv, SimdLevel::SSE2}, {"AVX2"sv, SimdLevel::AVX2}};
+    mt19937 generator(42);
+    for (const auto& [size_name, size] : sizes) {
+        Vector<int32_t> ints(size);
+        Vector<float> floats(size);
+        for (size_t i = 0; i < size; ++i) {
+            ints[i] = static_cast<int32_t>(generator() % 1'000'000) + 1;
+            floats[i] = static_cast<float>(ints[i]);
+        }
+        const size_t repeats = TOTAL / size;
+        cerr << size_name << ", "sv << size << " elements:"sv << endl;
+        for (const auto& [level_name, level] : levels) {
+            int64_t checksum = 0;
+            {
+                LOG_DURATION("  "s + string(level_name) + " Find int32_t"s);
+                for (size_t r = 0; r < repeats; ++r) {
+                    checksum += Find(ints, 0, level) - ints.begin();
+                }
+            }
+            {
+                LOG_DURATION("  "s + string(level_name) + " Count float"s);
+                for (size_t r = 0; r < repeats; ++r) {
+                    checksum += Count(floats, 1.0f, level);
+                }
+            }
+            {
+                LOG_DURATION("  "s + string(level_name) + " Min int32_t"s);
+                for (size_t r = 0; r < repeats; ++r) {
+                    checksum += *Min(ints, level);
+                }
+            }
+            {
+                LOG_DURATION("  "s + string(level_name) + " Sum int32_t"s);
+                for (size_t r = 0; r < repeats; ++r) {
+                    checksum += Sum(ints, level);
+                }
+            }
+            {
+                LOG_DURATION("  "s + string(level_name) + " Sum float"s);
+                for (size_t r = 0; r < repeats; ++r) {
+                    checksum += static_cast<int64_t>(Sum(floats, level));
+                }
+            }
+            cerr << "  checksum: "sv << checksum << endl;
+        }
+    }
+}
+
+void BenchmarkSoAVector() {
+    using namespace std;
+    struct Particle {
+        float x, y, z;
+        float vx, vy, vz;
+        float ax, ay, az;
+        float mass, charge, lifetime;
+    };
+    using Particles = SoAVector<float, float, float, float, float, float, float, float, float, float, float, float>;
+    const size_t SIZE = 4'000'000;
+    const int SCANS = 20;
+
+    cerr << "SoAVector vs Vector<struct>, "sv << SIZE << " particles:"sv << endl;
+    Vector<Particle> aos;
+    Particles soa;
+    {
+        LOG_DURATION("Vector<Particle> EmplaceBack"s);
+        for (size_t i = 0; i < SIZE; ++i) {
+            const float f = static_cast<float>(i);
+            aos.EmplaceBack(Particle{f, f, f, 1, 1, 1, 0, 0, 0, 1, 0, 10});
+        }
+    }
+    {
+        LOG_DURATION("SoAVector EmplaceBack"s);
+        for (size_t i = 0; i < SIZE; ++i) {
+            const float f = static_cast<float>(i);
+            soa.EmplaceBack(f, f, f, 1.f, 1.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 10.f);
+        }
+    }
+    {
+        LOG_DURATION("Vector<Particle> x += vx"s);
+        for (int scan = 0; scan < SCANS; ++scan) {
+            for (Particle& p : aos) {
+                p.x += p.vx;
+            }
+        }
+    }
+    {
+        LOG_DURATION("SoAVector x += vx"s);
+        for (int scan = 0; scan < SCANS; ++scan) {
+            Span<float> x = soa.Column<0>();
+            Span<const float> vx = std::as_const(soa).Column<3>();
+            for (size_t i = 0; i < x.Size(); ++i) {
+                x[i] += vx[i];
+            }
+        }
+    }
+    cerr << "  check: "sv << aos[SIZE - 1].x << " "sv << soa.Column<0>()[SIZE - 1] << endl;
+}
+
+void BenchmarkOptionalArray() {
+    using namespace std;
+    const size_t SIZE = 10'000'000;
+    cerr << "OptionalArray<float> vs Vector<Optional<float>>, "sv << SIZE << " slots:"sv << endl;
+    cerr << "  footprint: "sv << SIZE * sizeof(Optional<float>) / (1 << 20) << " MB vs "sv
+         << (SIZE * sizeof(float) + SIZE / 8) / (1 << 20) << " MB"sv << endl;
+    mt19937 generator(42);
+    for (int percent : {1, 10, 50, 100}) {
+        Vector<Optional<float>> optionals(SIZE);
+        OptionalArray<float> dense(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            if (static_cast<int>(generator() % 100) < percent) {
+                optionals[i] = static_cast<float>(i % 1'000);
+                dense.Set(i, static_cast<float>(i % 1'000));
+            }
+        }
+        cerr << percent << "% present:"sv << endl;
+        double sum = 0;
+        {
+            LOG_DURATION("  Vector<Optional<float>> scan"s);
+            for (const auto& value : optionals) {
+                if (value.HasValue()) {
+                    sum += *value;
+                }
+            }
+        }
+        {
+            LOG_DURATION("  OptionalArray<float> scan"s);
+            for (float value : dense) {
+                sum -= value;
+            }
+        }
+        size_t count = 0;
+        {
+            LOG_DURATION("  OptionalArray<float>::CountPresent"s);
+            count = dense.CountPresent();
+        }
+        cerr << "  check: "sv << sum << ", present: "sv << count << endl;
+    }
+}
+
+void BenchmarkSlotMap() {
+    using namespace std;
+    struct Entity {
+        float position[3];
+        float velocity[3];
+        uint32_t flags;
+    };
+    const size_t LIVE = 1'000'000;
+    const size_t CHURN = 4'000'000;
+    cerr << "SlotMap vs unordered_map, "sv << LIVE << " live entities, "sv << CHURN << " erase+insert:"sv << endl;
+    mt19937 generator(42);
+    {
+        SlotMap<Entity> map;
+        Vector<SlotHandle> handles(LIVE);
+        {
+            LOG_DURATION("SlotMap insert"s);
+            for (size_t i = 0; i < LIVE; ++i) {
+                handles[i] = map.Insert(Entity{{1, 2, 3}, {0, 0, 1}, 0});
+            }
+        }
+        {
+            LOG_DURATION("SlotMap churn"s);
+            for (size_t i = 0; i < CHURN; ++i) {
+                SlotHandle& handle = handles[generator() % LIVE];
+                map.Erase(handle);
+                handle = map.Insert(Entity{{1, 2, 3}, {0, 0, 1}, 0});
+            }
+        }
+        float sum = 0;
+        {
+            LOG_DURATION("SlotMap iterate x10"s);
+            for (int i = 0; i < 10; ++i) {
+                for (Entity& entity : map) {
+                    entity.position[2] += entity.velocity[2];
+                    sum += entity.position[2];
+                }
+            }
+        }
+        cerr << "  check: "sv << sum << endl;
+    }
+    {
+        unordered_map<uint64_t, Entity> map;
+        Vector<uint64_t> ids(LIVE);
+        uint64_t next_id = 0;
+        {
+            LOG_DURATION("unordered_map insert"s);
+            for (size_t i = 0; i < LIVE; ++i) {
+                ids[i] = next_id;
+                map.emplace(next_id++, Entity{{1, 2, 3}, {0, 0, 1}, 0});
+            }
+        }
+        {
+            LOG_DURATION("unordered_map churn"s);
+            for (size_t i = 0; i < CHURN; ++i) {
+                uint64_t& id = ids[generator() % LIVE];
+                map.erase(id);
+                id = next_id;
+                map.emplace(next_id++, Entity{{1, 2, 3}, {0, 0, 1}, 0});
+            }
+        }
+        float sum = 0;
+        {
+            LOG_DURATION("unordered_map iterate x10"s);
+            for (int i = 0; i < 10; ++i) {
+                for (auto& [id, entity] : map) {
+                    entity.position[2] += entity.velocity[2];
+                    sum += entity.position[2];
+                }
+            }
+        }
+        cerr << "  check: "sv << sum << endl;
+    }
+}
+
+void BenchmarkFlatHashMap() {
+    using namespace std;
+    const size_t CAPACITY = size_t{1} << 20;
+    const size_t LOOKUPS = 4'000'000;
+    cerr << "FlatHashMap vs unordered_map, "sv << LOOKUPS << " lookups at different load factors:"sv << endl;
+    for (const double load_factor : {0.5, 0.625, 0.75, 0.875}) {
+        const size_t count = static_cast<size_t>(CAPACITY * load_factor);
+        mt19937_64 generator(42);
+        Vector<uint64_t> keys(count);
+        for (uint64_t& key : keys) {
+            key = generator();
+        }
+        cerr << "  load factor "sv << load_factor << ':' << endl;
+        {
+            FlatHashMap<uint64_t, uint64_t> map;
+            map.Reserve(CAPACITY * FlatHashMap<uint64_t, uint64_t>::MAX_LOAD_NUMERATOR
+                        / FlatHashMap<uint64_t, uint64_t>::MAX_LOAD_DENOMINATOR);
+            {
+                LOG_DURATION("FlatHashMap insert"s);
+                for (size_t i = 0; i < count; ++i) {
+                    map.Insert(keys[i], i);
+                }
+            }
+            assert(map.Capacity() == CAPACITY);
+            uint64_t sum = 0;
+            {
+                LOG_DURATION("FlatHashMap hit"s);
+                for (size_t i = 0; i < LOOKUPS; ++i) {
+                    sum += *map.Find(keys[(i * 7919) % count]);
+                }
+            }
+            {
+                LOG_DURATION("FlatHashMap miss"s);
+                for (size_t i = 0; i < LOOKUPS; ++i) {
+                    sum += map.Contains(i);
+                }
+            }
+            {
+                LOG_DURATION("FlatHashMap erase"s);
+                for (size_t i = 0; i < count; i += 2) {
+                    map.Erase(keys[i]);
+                }
+            }
+            cerr << "    check: "sv << sum << endl;
+        }
+        {
+            unordered_map<uint64_t, uint64_t> map;
+            map.reserve(count);
+            {
+                LOG_DURATION("unordered_map insert"s);
+                for (size_t i = 0; i < count; ++i) {
+                    map.emplace(keys[i], i);
+                }
+            }
+            uint64_t sum = 0;
+            {
+                LOG_DURATION("unordered_map hit"s);
+                for (size_t i = 0; i < LOOKUPS; ++i) {
+                    sum += map.find(keys[(i * 7919) % count])->second;
+                }
+            }
+            {
+                LOG_DURATION("unordered_map miss"s);
+                for (size_t i = 0; i < LOOKUPS; ++i) {
+                    sum += map.count(i);
+                }
+            }
+            {
+                LOG_DURATION("unordered_map erase"s);
+                for (size_t i = 0; i < count; i += 2) {
+                    map.erase(keys[i]);
+                }
+            }
+            cerr << "    check: "sv << sum << endl;
+        }
+    }
+}
+
+void BenchmarkFlatMap() {
+    using namespace std;
+    const size_t KEYS = 4'000;
+    const size_t LOOKUPS = 10'000'000;
+    cerr << "FlatMap vs std::map, "sv << KEYS << " keys, "sv << LOOKUPS << " lookups:"sv << endl;
+    mt19937 generator(42);
+    Vector<pair<uint32_t, uint32_t>> items(KEYS);
+    for (size_t i = 0; i < KEYS; ++i) {
+        items[i] = {static_cast<uint32_t>(generator()), static_cast<uint32_t>(i)};
+    }
+    Vector<uint32_t> queries(LOOKUPS);
+    for (uint32_t& query : queries) {
+        // Половина запросов находит ключ, половина - нет
+        query = generator() % 2 ? items[generator() % KEYS].first : static_cast<uint32_t>(generator());
+    }
+    {
+        FlatMap<uint32_t, uint32_t> map;
+        {
+            LOG_DURATION("FlatMap build"s);
+            map = FlatMap<uint32_t, uint32_t>(items);
+        }
+        uint64_t sum = 0;
+        {
+            LOG_DURATION("FlatMap lookup"s);
+            for (uint32_t query : queries) {
+                const uint32_t* value = map.Find(query);
+                sum += value ? *value : 1;
+            }
+        }
+        {
+            LOG_DURATION("FlatMap InsertMany 100 x 100"s);
+            for (int i = 0; i < 100; ++i) {
+                Vector<pair<uint32_t, uint32_t>> batch(100);
+                for (auto& item : batch) {
+                    item = {static_cast<uint32_t>(generator()), 0};
+                }
+                map.InsertMany(std::move(batch));
+            }
+        }
+        cerr << "  check: "sv << sum << endl;
+    }
+    {
+        map<uint32_t, uint32_t> map;
+        {
+            LOG_DURATION("std::map build"s);
+            for (const auto& item : items) {
+                map.insert(item);
+            }
+        }
+        uint64_t sum = 0;
+        {
+            LOG_DURATION("std::map lookup"s);
+            for (uint32_t query : queries) {
+                const auto it = map.find(query);
+                sum += it != map.end() ? it->second : 1;
+            }
+        }
+        {
+            LOG_DURATION("std::map insert 100 x 100"s);
+            for (int i = 0; i < 100; ++i) {
+                for (int j = 0; j < 100; ++j) {
+                    map.emplace(static_cast<uint32_t>(generator()), 0);
+                }
+            }
+        }
+        cerr << "  check: "sv << sum << endl;
+    }
+}
+
+void BenchmarkEytzingerIndex() {
+    using namespace std;
+    const size_t KEYS = size_t{1} << 22;
+    const size_t QUERIES = 4'000'000;
+    cerr << "EytzingerIndex vs std::lower_bound, "sv << KEYS << " keys, "sv << QUERIES << " queries:"sv << endl;
+    mt19937 generator(42);
+    Vector<uint32_t> sorted(KEYS);
+    for (uint32_t& key : sorted) {
+        key = static_cast<uint32_t>(generator());
+    }
+    sort(sorted.begin(), sorted.end());
+    Vector<uint32_t> queries(QUERIES);
+    for (uint32_t& query : queries) {
+        query = static_cast<uint32_t>(generator());
+    }
+    size_t sum = 0;
+    {
+        LOG_DURATION("std::lower_bound"s);
+        for (uint32_t query : queries) {
+            sum += static_cast<size_t>(lower_bound(sorted.begin(), sorted.end(), query) - sorted.begin());
+        }
+    }
+    cerr << "  check: "sv << sum << endl;
+    sum = 0;
+    {
+        LOG_DURATION("branchless lower bound"s);
+        for (uint32_t query : queries) {
+            sum += detail::BranchlessLowerBound(sorted.begin(), sorted.Size(), query, less<uint32_t>());
+        }
+    }
+    cerr << "  check: "sv << sum << endl;
+    EytzingerIndex<uint32_t> index;
+    {
+        LOG_DURATION("EytzingerIndex build"s);
+        index = EytzingerIndex<uint32_t>(sorted);
+    }
+    sum = 0;
+    {
+        LOG_DURATION("EytzingerIndex"s);
+        for (uint32_t query : queries) {
+            sum += index.LowerBound(query);
+        }
+    }
+    cerr << "  check: "sv << sum << endl;
+}
+
+template <size_t D>
+void BenchmarkDaryHeapSize(const Vector<uint64_t>& values, size_t size) {
+    using namespace std;
+    DaryHeap<uint64_t, D> heap;
+    heap.Reserve(size);
+    uint64_t sum = 0;
+    {
+        LOG_DURATION("DaryHeap<"s + to_string(D) + ">"s);
+        for (size_t i = 0; i < size; ++i) {
+            heap.Push(values[i]);
+        }
+        // Устойчивое состояние: извлечение вершины и вставка нового элемента
+        for (size_t i = size; i < values.Size(); ++i) {
+            sum += *heap.Pop();
+            heap.Push(values[i]);
+        }
+    }
+    {
+        // Опустошение: каждое извлечение спускает дырку на всю высоту кучи
+        LOG_DURATION("DaryHeap<"s + to_string(D) + "> drain"s);
+        while (!heap.Empty()) {
+            sum += *heap.Pop();
+        }
+    }
+    cerr << "  check: "sv << sum << endl;
+}
+
+void BenchmarkDaryHeap() {
+    using namespace std;
+    const size_t OPERATIONS = 4'000'000;
+    mt19937_64 generator(42);
+    Vector<uint64_t> values(OPERATIONS);
+    for (uint64_t& value : values) {
+        value = generator();
+    }
+    for (size_t size : {size_t{1'000}, size_t{100'000}, size_t{2'000'000}}) {
+        cerr << "DaryHeap vs std::priority_queue, "sv << size << " elements, "sv << OPERATIONS - size << " pop+push, then drain:"sv << endl;
+        {
+            priority_queue<uint64_t, vector<uint64_t>, greater<uint64_t>> heap;
+            uint64_t sum = 0;
+            {
+                LOG_DURATION("std::priority_queue"s);
+                for (size_t i = 0; i < size; ++i) {
+                    heap.push(values[i]);
+                }
+                for (size_t i = size; i < values.Size(); ++i) {
+                    sum += heap.top();
+                    heap.pop();
+                    heap.push(values[i]);
+                }
+            }
+            {
+                LOG_DURATION("std::priority_queue drain"s);
+                while (!heap.empty()) {
+                    sum += heap.top();
+                    heap.pop();
+                }
+            }
+            cerr << "  check: "sv << sum << endl;
+        }
+        BenchmarkDaryHeapSize<2>(values, size);
+        BenchmarkDaryHeapSize<4>(values, size);
+        BenchmarkDaryHeapSize<8>(values, size);
+    }
+}
+
+void BenchmarkTieredVector() {
+    using namespace std;
+    const size_t SIZE = 1'000'000;
+    const size_t INSERTS = 10'000;
+    const size_t LIST_INSERTS = 300;
+    cerr << "TieredVector vs Vector vs std::list, "sv << SIZE << " elements, random middle insert+erase:"sv << endl;
+    mt19937 generator(42);
+    Vector<size_t> positions(INSERTS);
+    for (size_t& pos : positions) {
+        pos = generator() % SIZE;
+    }
+    {
+        TieredVector<int> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        {
+            LOG_DURATION("TieredVector "s + to_string(INSERTS) + " ops"s);
+            for (size_t pos : positions) {
+                v.Insert(v.cbegin() + pos, 1);
+                v.Erase(v.cbegin() + (SIZE - pos));
+            }
+        }
+        long long sum = 0;
+        {
+            LOG_DURATION("TieredVector scan x10"s);
+            for (int i = 0; i < 10; ++i) {
+                v.ForEach([&sum](int value) {
+                    sum += value;
+                });
+            }
+        }
+        cerr << "  check: "sv << sum << endl;
+    }
+    {
+        Vector<int> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        {
+            LOG_DURATION("Vector "s + to_string(INSERTS) + " ops"s);
+            for (size_t pos : positions) {
+                v.Insert(v.cbegin() + pos, 1);
+                v.Erase(v.cbegin() + (SIZE - pos));
+            }
+        }
+        long long sum = 0;
+        {
+            LOG_DURATION("Vector scan x10"s);
+            for (int i = 0; i < 10; ++i) {
+                sum += accumulate(v.begin(), v.end(), 0LL);
+            }
+        }
+        cerr << "  check: "sv << sum << endl;
+    }
+    {
+        list<int> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.push_back(static_cast<int>(i));
+        }
+        {
+            // Список не умеет искать позицию быстрее обхода, поэтому операций меньше
+            LOG_DURATION("std::list "s + to_string(LIST_INSERTS) + " ops"s);
+            for (size_t i = 0; i < LIST_INSERTS; ++i) {
+                v.insert(next(v.begin(), static_cast<ptrdiff_t>(positions[i])), 1);
+                v.erase(next(v.begin(), static_cast<ptrdiff_t>(SIZE - positions[i])));
+            }
+        }
+        long long sum = 0;
+        {
+            LOG_DURATION("std::list scan x10"s);
+            for (int i = 0; i < 10; ++i) {
+                sum += accumulate(v.begin(), v.end(), 0LL);
+            }
+        }
+        cerr << "  check: "sv << sum << endl;
+    }
+}
+
+// Аллокатор, считающий выделения памяти контейнером стандартной библиотеки
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator(size_t* counter) noexcept
+        : counter(counter) {
+    }
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept
+        : counter(other.counter) {
+    }
+
+    T* allocate(size_t n) {
+        ++*counter;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>& other) const noexcept {
+        return counter == other.counter;
+    }
+
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>& other) const noexcept {
+        return counter != other.counter;
+    }
+
+    size_t* counter;
+};
+
+void BenchmarkDeque() {
+    using namespace std;
+    const size_t WINDOW = 100'000;
+    const size_t STEPS = 20'000'000;
+    cerr << "Deque vs std::deque, sliding window of "sv << WINDOW << ", "sv << STEPS << " push+pop:"sv << endl;
+    {
+        Deque<uint64_t> d;
+        uint64_t sum = 0;
+        {
+            LOG_DURATION("Deque"s);
+            for (size_t i = 0; i < WINDOW; ++i) {
+                d.PushBack(i);
+            }
+            for (size_t i = 0; i < STEPS; ++i) {
+                sum += d.Front();
+                d.PopFront();
+                d.PushBack(i);
+            }
+            for (size_t i = 0; i < STEPS; ++i) {
+                sum += d.Back();
+                d.PopBack();
+                d.PushFront(i);
+            }
+        }
+        cerr << "  check: "sv << sum << ", block allocations: "sv << d.BlockAllocations() << endl;
+    }
+    {
+        size_t allocations = 0;
+        deque<uint64_t, CountingAllocator<uint64_t>> d(CountingAllocator<uint64_t>{&allocations});
+        uint64_t sum = 0;
+        {
+            LOG_DURATION("std::deque"s);
+            for (size_t i = 0; i < WINDOW; ++i) {
+                d.push_back(i);
+            }
+            for (size_t i = 0; i < STEPS; ++i) {
+                sum += d.front();
+                d.pop_front();
+                d.push_back(i);
+            }
+            for (size_t i = 0; i < STEPS; ++i) {
+                sum += d.back();
+                d.pop_back();
+                d.push_front(i);
+            }
+        }
+        cerr << "  check: "sv << sum << ", allocations: "sv << allocations << endl;
+    }
+}
+
+void BenchmarkBitVector() {
+    using namespace std;
+    const size_t SIZE = size_t{1} << 28;
+    const size_t QUERIES = 4'000'000;
+    cerr << "BitVector, "sv << SIZE << " bits ("sv << SIZE / 8 / (1 << 20) << " MB vs "sv << SIZE / (1 << 20)
+         << " MB as Vector<char>):"sv << endl;
+    mt19937_64 generator(42);
+    BitVector lhs(SIZE);
+    BitVector rhs(SIZE);
+    for (size_t i = 0; i < SIZE; i += 1 + generator() % 8) {
+        lhs.Set(i);
+        rhs.Set(SIZE - 1 - i);
+    }
+    Vector<char> flags(SIZE);
+    for (size_t i = lhs.FindFirst(); i < SIZE; i = lhs.FindNext(i)) {
+        flags[i] = 1;
+    }
+    size_t check = 0;
+    {
+        LOG_DURATION("Vector<char> count"s);
+        check += static_cast<size_t>(count(flags.begin(), flags.end(), 1));
+    }
+    {
+        LOG_DURATION("BitVector count scalar"s);
+        check += lhs.Count(SimdLevel::SCALAR);
+    }
+    {
+        LOG_DURATION("BitVector count"s);
+        check += lhs.Count();
+    }
+    {
+        LOG_DURATION("BitVector and+or+xor x10"s);
+        for (int i = 0; i < 10; ++i) {
+            lhs.And(rhs).Or(rhs).Xor(rhs);
+        }
+        check += lhs.Count();
+    }
+    {
+        LOG_DURATION("BitVector FindFirst/FindNext scan"s);
+        for (size_t i = rhs.FindFirst(); i < SIZE; i = rhs.FindNext(i)) {
+            ++check;
+        }
+    }
+    const BitRankSelect index(rhs);
+    {
+        LOG_DURATION("BitRankSelect rank"s);
+        for (size_t i = 0; i < QUERIES; ++i) {
+            check += index.Rank(generator() % SIZE);
+        }
+    }
+    {
+        LOG_DURATION("BitRankSelect select"s);
+        for (size_t i = 0; i < QUERIES; ++i) {
+            check += index.Select(generator() % index.CountOnes());
+        }
+    }
+    cerr << "  check: "sv << check << endl;
+}
+
+void BenchmarkPackedIntVector() {
+    using namespace std;
+    const size_t SIZE = size_t{1} << 24;
+    const size_t QUERIES = 4'000'000;
+    mt19937 generator(42);
+    // Неотсортированные идентификаторы из 12 битов и отсортированный список со средней разностью 4
+    Vector<uint32_t> ids(SIZE);
+    Vector<uint32_t> sorted(SIZE);
+    uint32_t value = 0;
+    for (size_t i = 0; i < SIZE; ++i) {
+        ids[i] = generator() % 4096;
+        value += generator() % 8;
+        sorted[i] = value;
+    }
+    const PackedIntVector packed_ids(ids);
+    const PackedIntVector packed_sorted(sorted);
+    const DeltaVector deltas(sorted);
+    const size_t mb = 1 << 20;
+    cerr << "PackedIntVector/DeltaVector, "sv << SIZE << " values, MB: Vector "sv << SIZE * sizeof(uint32_t) / mb
+         << ", packed ids ("sv << packed_ids.Width() << " bits) "sv << packed_ids.MemoryUsage() / mb
+         << ", packed sorted ("sv << packed_sorted.Width() << " bits) "sv << packed_sorted.MemoryUsage() / mb
+         << ", delta sorted "sv << deltas.MemoryUsage() / mb << endl;
+    // Буфер распаковки выделяется заранее, чтобы не измерять первое обращение к страницам
+    Vector<uint32_t> decoded(SIZE);
+    uint64_t check = 0;
+    {
+        LOG_DURATION("Vector<uint32_t> scan"s);
+        check += accumulate(sorted.begin(), sorted.end(), uint64_t{0});
+    }
+    {
+        LOG_DURATION("PackedIntVector decode"s);
+        packed_sorted.Decode(decoded);
+        check += decoded[SIZE - 1];
+    }
+    {
+        LOG_DURATION("DeltaVector decode scalar"s);
+        deltas.Decode(decoded, SimdLevel::SCALAR);
+        check += decoded[SIZE - 1];
+    }
+    {
+        LOG_DURATION("DeltaVector decode"s);
+        deltas.Decode(decoded);
+        check += decoded[SIZE - 1];
+    }
+    Vector<size_t> queries(QUERIES);
+    for (size_t& query : queries) {
+        query = generator() % SIZE;
+    }
+    {
+        LOG_DURATION("Vector<uint32_t> random access"s);
+        for (size_t query : queries) {
+            check += sorted[query];
+        }
+    }
+    {
+        LOG_DURATION("PackedIntVector random access"s);
+        for (size_t query : queries) {
+            check += packed_sorted.Get(query);
+        }
+    }
+    {
+        LOG_DURATION("DeltaVector random access"s);
+        for (size_t query : queries) {
+            check += deltas.Get(query);
+        }
+    }
+    cerr << "  check: "sv << check << endl;
+}
+
+void BenchmarkCompactVector() {
+    using namespace std;
+    // Списки смежности: 80% вершин без рёбер, у остальных от 1 до 8 соседей
+    const size_t NODES = size_t{1} << 22;
+    const size_t QUERIES = 4'000'000;
+    mt19937 generator(42);
+    Vector<uint32_t> degrees(NODES);
+    for (uint32_t& degree : degrees) {
+        degree = generator() % 5 == 0 ? 1 + generator() % 8 : 0;
+    }
+    auto run = [&](auto& graph, string_view name) {
+        using Neighbours = remove_reference_t<decltype(graph[0])>;
+        {
+            LOG_DURATION(string(name) + " build"s);
+            for (size_t node = 0; node < NODES; ++node) {
+                for (uint32_t i = 0; i < degrees[node]; ++i) {
+                    graph[node].PushBack(static_cast<uint32_t>((node * 31 + i * 7919) % NODES));
+                }
+            }
+        }
+        size_t heap = 0;
+        for (const Neighbours& neighbours : graph) {
+            heap += neighbours.Capacity() * sizeof(uint32_t);
+            if constexpr (is_same_v<Neighbours, CompactVector<uint32_t>>) {
+                heap += neighbours.Capacity() ? CompactVector<uint32_t>::HEADER_SIZE : 0;
+            }
+        }
+        cerr << "  "sv << name << ": "sv << (NODES * sizeof(Neighbours) + heap) / (1 << 20) << " MB ("sv
+             << sizeof(Neighbours) << " bytes per node)"sv << endl;
+        uint64_t check = 0;
+        {
+            LOG_DURATION(string(name) + " edge scan"s);
+            for (const Neighbours& neighbours : graph) {
+                for (uint32_t neighbour : neighbours) {
+                    check += neighbour;
+                }
+            }
+        }
+        mt19937 queries(7);
+        {
+            LOG_DURATION(string(name) + " random two-hop degree"s);
+            for (size_t i = 0; i < QUERIES; ++i) {
+                for (uint32_t neighbour : graph[queries() % NODES]) {
+                    check += graph[neighbour].Size();
+                }
+            }
+        }
+        cerr << "  check: "sv << check << endl;
+    };
+    cerr << "CompactVector graph adjacency, "sv << NODES << " nodes:"sv << endl;
+    {
+        Vector<Vector<uint32_t>> graph(NODES);
+        run(graph, "Vector"sv);
+    }
+    {
+        Vector<CompactVector<uint32_t>> graph(NODES);
+        run(graph, "CompactVector"sv);
+    }
+}
+
+void BenchmarkStaticVector() {
+    using namespace std;
+    // Разбор пакетов: заголовок с числом опций (до 16) и опции по 4 байта
+    struct Option {
+        uint16_t type;
+        uint16_t value;
+    };
+    const size_t PACKETS = 2'000'000;
+    const size_t MAX_OPTIONS = 16;
+    mt19937 generator(42);
+    Vector<uint8_t> stream;
+    for (size_t i = 0; i < PACKETS; ++i) {
+        const size_t options = generator() % (MAX_OPTIONS + 1);
+        stream.PushBack(static_cast<uint8_t>(options));
+        for (size_t j = 0; j < options * sizeof(Option); ++j) {
+            stream.PushBack(static_cast<uint8_t>(generator()));
+        }
+    }
+    auto parse = [&stream](auto make_options) {
+        uint64_t check = 0;
+        for (size_t offset = 0; offset < stream.Size();) {
+            auto options = make_options();
+            const size_t count = stream[offset++];
+            for (size_t j = 0; j < count; ++j, offset += sizeof(Option)) {
+                Option option;
+                memcpy(&option, stream.begin() + offset, sizeof(option));
+                options.PushBack(option);
+            }
+            for (const Option& option : options) {
+                check += option.type ^ option.value;
+            }
+        }
+        return check;
+    };
+    cerr << "StaticVector, parsing "sv << PACKETS << " packets:"sv << endl;
+    uint64_t check = 0;
+    {
+        LOG_DURATION("Vector<Option>"s);
+        check += parse([] {
+            return Vector<Option>();
+        });
+    }
+    {
+        LOG_DURATION("Vector<Option> with Reserve"s);
+        check += parse([] {
+            Vector<Option> options;
+            options.Reserve(MAX_OPTIONS);
+            return options;
+        });
+    }
+    {
+        LOG_DURATION("StaticVector<Option, 16>"s);
+        check += parse([] {
+            return StaticVector<Option, MAX_OPTIONS>();
+        });
+    }
+    cerr << "  check: "sv << check << endl;
+}
+
+void BenchmarkCowVector() {
+    using namespace std;
+    // Конвейер из STAGES этапов: каждый берёт копию "на всякий случай" и читает её,
+    // и только последний этап меняет один элемент
+    const size_t SIZE = 1'000'000;
+    const size_t STAGES = 8;
+    const size_t BATCHES = 20;
+    cerr << "CowVector, "sv << BATCHES << " batches of "sv << SIZE << " elements through "sv << STAGES
+         << " stages:"sv << endl;
+    auto run = [&](auto batch) {
+        uint64_t check = 0;
+        for (size_t b = 0; b < BATCHES; ++b) {
+            auto current = batch;
+            for (size_t stage = 0; stage < STAGES; ++stage) {
+                auto copy = current;
+                const auto& view = copy;
+                check += view.Size() + view[stage];
+                if (stage + 1 == STAGES) {
+                    copy[0] = static_cast<int>(b);
+                }
+                current = std::move(copy);
+            }
+            const auto& result = current;
+            check += result[0];
+        }
+        return check;
+    };
+    Vector<int> values(SIZE);
+    iota(values.begin(), values.end(), 0);
+    uint64_t check = 0;
+    {
+        LOG_DURATION("Vector pipeline"s);
+        check += run(values);
+    }
+    {
+        LOG_DURATION("CowVector pipeline"s);
+        check += run(CowVector<int>(values));
+    }
+    cerr << "  check: "sv << check << endl;
+
+    // Число копирований элементов в том же конвейере
+    auto count_copies = [&](auto batch) {
+        C::Reset();
+        auto current = batch;
+        for (size_t stage = 0; stage < STAGES; ++stage) {
+            auto copy = current;
+            if (stage + 1 == STAGES) {
+                copy[0] = C();
+            }
+            current = std::move(copy);
+        }
+        return C::copy_ctor;
+    };
+    const Vector<C> items(1'000);
+    cerr << "  element copies for 1000 elements: Vector "sv << count_copies(items) << ", CowVector "sv
+         << count_copies(CowVector<C>(items)) << endl;
+}
+
+// Занятая в куче память в байтах, если её можно узнать у библиотеки
+size_t HeapBytesInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+void BenchmarkPersistentVector() {
+    using namespace std;
+    // История правок: каждая версия отличается от предыдущей одним элементом
+    const size_t SIZE = 4'096;
+    const size_t VERSIONS = 10'000;
+    const size_t QUERIES = 4'000'000;
+    cerr << "PersistentVector, "sv << VERSIONS << " versions of "sv << SIZE << " ints:"sv << endl;
+    Vector<int> initial(SIZE);
+    iota(initial.begin(), initial.end(), 0);
+    mt19937 generator(42);
+    uint64_t check = 0;
+    {
+        const size_t heap_before = HeapBytesInUse();
+        Vector<Vector<int>> history;
+        history.Reserve(VERSIONS);
+        {
+            LOG_DURATION("Vector copies"s);
+            history.PushBack(initial);
+            for (size_t i = 1; i < VERSIONS; ++i) {
+                history.PushBack(history[i - 1]);
+                history[i][generator() % SIZE] = static_cast<int>(i);
+            }
+        }
+        cerr << "  Vector copies: "sv << (HeapBytesInUse() - heap_before) / (1 << 20) << " MB"sv << endl;
+        check += history[VERSIONS - 1][0];
+    }
+    {
+        const size_t heap_before = HeapBytesInUse();
+        Vector<PersistentVector<int>> history;
+        history.Reserve(VERSIONS);
+        {
+            LOG_DURATION("PersistentVector versions"s);
+            history.PushBack(PersistentVector<int>(initial));
+            for (size_t i = 1; i < VERSIONS; ++i) {
+                history.PushBack(history[i - 1].Set(generator() % SIZE, static_cast<int>(i)));
+            }
+        }
+        cerr << "  PersistentVector versions: "sv << (HeapBytesInUse() - heap_before) / (1 << 20) << " MB"sv << endl;
+        {
+            LOG_DURATION("PersistentVector random Get"s);
+            for (size_t i = 0; i < QUERIES; ++i) {
+                check += history[i % VERSIONS][generator() % SIZE];
+            }
+        }
+    }
+    const size_t BUILD = 1'000'000;
+    {
+        LOG_DURATION("Vector PushBack x1M"s);
+        Vector<int> values;
+        for (size_t i = 0; i < BUILD; ++i) {
+            values.PushBack(static_cast<int>(i));
+        }
+        check += values[BUILD - 1];
+    }
+    {
+        LOG_DURATION("PersistentVector PushBack x1M"s);
+        PersistentVector<int> values;
+        for (size_t i = 0; i < BUILD; ++i) {
+            values = values.PushBack(static_cast<int>(i));
+        }
+        check += values[BUILD - 1];
+    }
+    PersistentVector<int> built;
+    {
+        LOG_DURATION("PersistentVector transient PushBack x1M"s);
+        PersistentVector<int>::Transient transient;
+        for (size_t i = 0; i < BUILD; ++i) {
+            transient.PushBack(static_cast<int>(i));
+        }
+        built = transient.Persistent();
+        check += built[BUILD - 1];
+    }
+    {
+        LOG_DURATION("PersistentVector 1000 slices + concats"s);
+        PersistentVector<int> joined;
+        for (size_t i = 0; i < 1'000; ++i) {
+            const size_t begin = generator() % (BUILD - 1'000);
+            joined = joined.Concat(built.Slice(begin, begin + 1'000));
+        }
+        check += joined.Size() + joined[joined.Size() / 2];
+    }
+    cerr << "  check: "sv << check << endl;
+}
+
+void BenchmarkSpan() {
+    using namespace std;
+    // Конвейер: каждый поток берёт свои блоки, масштабирует их и считает сумму.
+    // Прежний вариант копирует блок в отдельный Vector и затем записывает обратно
+    const size_t SIZE = 1 << 24;
+    const size_t CHUNK = 1 << 16;
+    const size_t NUM_CHUNKS = SIZE / CHUNK;
+    const size_t NUM_THREADS = ParallelPolicy{}.ThreadCount();
+    cerr << "Chunked pipeline over "sv << SIZE << " floats, "sv << NUM_CHUNKS << " chunks, "sv << NUM_THREADS
+         << " threads:"sv << endl;
+    Vector<float> data(SIZE);
+    for (size_t i = 0; i < SIZE; ++i) {
+        data[i] = static_cast<float>(i % 1000);
+    }
+    auto scale = [](float value) {
+        return value * 0.5f + 1.0f;
+    };
+    Vector<double> sums(NUM_CHUNKS);
+    {
+        atomic<size_t> copied_bytes = 0;
+        {
+            LOG_DURATION("Vector chunk copies"s);
+            for (int round = 0; round < 10; ++round) {
+                detail::RunTasks(NUM_THREADS, [&](size_t worker) {
+                    for (size_t chunk = worker; chunk < NUM_CHUNKS; chunk += NUM_THREADS) {
+                        Vector<float> part(CHUNK);
+                        copy_n(data.begin() + chunk * CHUNK, CHUNK, part.begin());
+                        transform(part.begin(), part.end(), part.begin(), scale);
+                        sums[chunk] = accumulate(part.begin(), part.end(), 0.0);
+                        copy(part.begin(), part.end(), data.begin() + chunk * CHUNK);
+                        copied_bytes += 2 * CHUNK * sizeof(float);
+                    }
+                });
+            }
+        }
+        cerr << "  copied: "sv << copied_bytes / (1 << 20) << " MB"sv << endl;
+    }
+    {
+        LOG_DURATION("Span chunks"s);
+        const Span<float> all = data.AsSpan();
+        for (int round = 0; round < 10; ++round) {
+            detail::RunTasks(NUM_THREADS, [&](size_t worker) {
+                for (size_t chunk = worker; chunk < NUM_CHUNKS; chunk += NUM_THREADS) {
+                    Span<float> part = all.Subspan(chunk * CHUNK, CHUNK);
+                    transform(part.begin(), part.end(), part.begin(), scale);
+                    sums[chunk] = accumulate(part.begin(), part.end(), 0.0);
+                }
+            });
+        }
+    }
+    {
+        // Поиск по части вектора: прежде - копия части, теперь - Span
+        Vector<int32_t> ids(SIZE);
+        iota(ids.begin(), ids.end(), 0);
+        size_t found = 0;
+        {
+            LOG_DURATION("Count in copied Vector slices"s);
+            for (size_t chunk = 0; chunk < NUM_CHUNKS; ++chunk) {
+                Vector<int32_t> part(CHUNK);
+                copy_n(ids.begin() + chunk * CHUNK, CHUNK, part.begin());
+                found += Count(part, static_cast<int32_t>(chunk * CHUNK + 7));
+            }
+        }
+        {
+            LOG_DURATION("Count in Span slices"s);
+            const Span<const int32_t> all = std::as_const(ids).AsSpan();
+            for (size_t chunk = 0; chunk < NUM_CHUNKS; ++chunk) {
+                found += Count(all.Subspan(chunk * CHUNK, CHUNK), static_cast<int32_t>(chunk * CHUNK + 7));
+            }
+        }
+        cerr << "  found: "sv << found << ", checksum: "sv << accumulate(sums.begin(), sums.end(), 0.0) << endl;
+    }
+}
+
+// Имитирует декодер на C: возвращает буфер из malloc, который вызывающий должен освободить
+int32_t* DecodeFrame(size_t size, int32_t seed) {
+    auto* frame = static_cast<int32_t*>(std::malloc(size * sizeof(int32_t)));
+    for (size_t i = 0; i < size; ++i) {
+        frame[i] = seed + static_cast<int32_t>(i);
+    }
+    return frame;
+}
+
+void BenchmarkAdopt() {
+    using namespace std;
+    const size_t FRAME_SIZE = 1 << 20;
+    const int NUM_FRAMES = 200;
+    cerr << "Ingesting "sv << NUM_FRAMES << " decoded frames of "sv << FRAME_SIZE << " int32:"sv << endl;
+    int64_t check = 0;
+    {
+        LOG_DURATION("PushBack copy + free"s);
+        for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+            int32_t* decoded = DecodeFrame(FRAME_SIZE, frame);
+            Vector<int32_t> values;
+            for (size_t i = 0; i < FRAME_SIZE; ++i) {
+                values.PushBack(decoded[i]);
+            }
+            free(decoded);
+            check += values[FRAME_SIZE - 1];
+        }
+    }
+    {
+        LOG_DURATION("Adopt"s);
+        for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+            Vector<int32_t> values = Vector<int32_t>::Adopt(DecodeFrame(FRAME_SIZE, frame), FRAME_SIZE, FRAME_SIZE, FreeBuffer);
+            check += values[FRAME_SIZE - 1];
+        }
+    }
+    {
+        LOG_DURATION("std::vector -> Vector, element copy"s);
+        for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+            vector<int32_t> decoded(FRAME_SIZE, frame);
+            Vector<int32_t> values(decoded.size());
+            copy(decoded.begin(), decoded.end(), values.begin());
+            check += values[FRAME_SIZE - 1];
+        }
+    }
+    {
+        LOG_DURATION("std::vector -> Vector, FromStdVector"s);
+        for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+            vector<int32_t> decoded(FRAME_SIZE, frame);
+            Vector<int32_t> values = Vector<int32_t>::FromStdVector(move(decoded));
+            check += values[FRAME_SIZE - 1];
+        }
+    }
+    cerr << "  check: "sv << check << endl;
+}
+
+void BenchmarkViews() {
+    using namespace std;
+    // Цепочка: квадрат, отбор чётных, масштабирование и сумма по частям. Материализующий
+    // вариант создаёт Vector после каждого шага
+    const size_t SIZE = 1 << 24;
+    cerr << "View pipeline over "sv << SIZE << " ints:"sv << endl;
+    Vector<int64_t> source(SIZE);
+    iota(source.begin(), source.end(), 0);
+    auto square = [](int64_t x) {
+        return x * x;
+    };
+    auto is_even = [](int64_t x) {
+        return x % 2 == 0;
+    };
+    auto scale = [](int64_t x) {
+        return x / 3 + 1;
+    };
+    int64_t check = 0;
+    for (int round = 0; round < 2; ++round) {
+        size_t allocations = 0;
+        size_t intermediate_bytes = 0;
+        // PushBack, который считает перевыделения памяти
+        auto push = [&allocations](Vector<int64_t>& out, int64_t value) {
+            allocations += out.Size() == out.Capacity();
+            out.PushBack(value);
+        };
+        Vector<int64_t> result;
+        {
+            LOG_DURATION("Materialized Map/Filter/Map"s);
+            Vector<int64_t> squares;
+            for (int64_t x : source) {
+                push(squares, square(x));
+            }
+            Vector<int64_t> evens;
+            for (int64_t x : squares) {
+                if (is_even(x)) {
+                    push(evens, x);
+                }
+            }
+            for (int64_t x : evens) {
+                push(result, scale(x));
+            }
+            intermediate_bytes = (squares.Capacity() + evens.Capacity()) * sizeof(int64_t);
+        }
+        check += result[result.Size() - 1];
+        if (round == 0) {
+            cerr << "  allocations: "sv << allocations << ", intermediate buffers: "sv << intermediate_bytes / (1 << 20)
+                 << " MB"sv << endl;
+        }
+    }
+    for (int round = 0; round < 2; ++round) {
+        Vector<int64_t> result;
+        {
+            LOG_DURATION("Fused Map/Filter/Map"s);
+            Map(source, square).Filter(is_even).Map(scale).CollectInto(result);
+        }
+        check += result[result.Size() - 1];
+    }
+    {
+        Vector<int64_t> result;
+        {
+            LOG_DURATION("Fused Map/Map + CollectInto with size hint"s);
+            Map(source, square).Map(scale).CollectInto(result);
+        }
+        cerr << "  capacity == size: "sv << (result.Capacity() == result.Size()) << endl;
+        check += result[result.Size() - 1];
+    }
+    {
+        Vector<int64_t> sums;
+        {
+            LOG_DURATION("Fused Chunk(4096) sums"s);
+            Chunk(source, 4096)
+                .Map([](RangeView<int64_t*> chunk) {
+                    return accumulate(chunk.begin(), chunk.end(), int64_t{0});
+                })
+                .CollectInto(sums);
+        }
+        check += sums[0];
+    }
+    cerr << "  check: "sv << check << endl;
+}
+
+void BenchmarkSerialization() {
+    using namespace std;
+    struct Record {
+        int64_t id;
+        double value;
+        int32_t flags;
+    };
+    const size_t SIZE = 1 << 22;
+    Vector<Record> records(SIZE);
+    for (size_t i = 0; i < SIZE; ++i) {
+        records[i] = Record{static_cast<int64_t>(i), i * 0.25, static_cast<int32_t>(i % 7)};
+    }
+    cerr << "Serialization of "sv << SIZE << " records ("sv << SIZE * sizeof(Record) / (1 << 20) << " MB):"sv << endl;
+    double check = 0;
+    string per_element_bytes;
+    {
+        LOG_DURATION("Per-element stream writes"s);
+        ostringstream out;
+        const uint64_t count = records.Size();
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        for (const Record& record : records) {
+            out.write(reinterpret_cast<const char*>(&record.id), sizeof(record.id));
+            out.write(reinterpret_cast<const char*>(&record.value), sizeof(record.value));
+            out.write(reinterpret_cast<const char*>(&record.flags), sizeof(record.flags));
+        }
+        per_element_bytes = out.str();
+    }
+    {
+        LOG_DURATION("SerializeTo(ostream)"s);
+        ostringstream out;
+        SerializeTo(records, out);
+        check += out.str().size();
+    }
+    Vector<char> buffer;
+    {
+        LOG_DURATION("SerializeInto(Vector<char>)"s);
+        SerializeInto(records, buffer);
+    }
+    {
+        LOG_DURATION("Per-element stream reads"s);
+        istringstream in(per_element_bytes);
+        uint64_t count = 0;
+        in.read(reinterpret_cast<char*>(&count), sizeof(count));
+        Vector<Record> copy;
+        for (uint64_t i = 0; i < count; ++i) {
+            Record record;
+            in.read(reinterpret_cast<char*>(&record.id), sizeof(record.id));
+            in.read(reinterpret_cast<char*>(&record.value), sizeof(record.value));
+            in.read(reinterpret_cast<char*>(&record.flags), sizeof(record.flags));
+            copy.PushBack(record);
+        }
+        check += copy[count - 1].value;
+    }
+    {
+        LOG_DURATION("Deserialize (copy)"s);
+        const Vector<Record> copy = Deserialize<Record>(buffer.AsSpan());
+        check += copy[SIZE - 1].value;
+    }
+    {
+        LOG_DURATION("DeserializeView (zero-copy) + sum"s);
+        const Span<const Record> view = DeserializeView<Record>(buffer.AsSpan());
+        for (const Record& record : view) {
+            check += record.flags;
+        }
+    }
+#if VECTOR_POSIX_IO
+    {
+        std::FILE* file = std::tmpfile();
+        {
+            LOG_DURATION("SerializeTo(fd) via writev"s);
+            SerializeTo(records, fileno(file));
+        }
+        {
+            LOG_DURATION("mmap + DeserializeView + sum"s);
+            void* mapped = mmap(nullptr, buffer.Size(), PROT_READ, MAP_PRIVATE, fileno(file), 0);
+            const Span<const Record> view =
+                DeserializeView<Record>(Span<const char>(static_cast<const char*>(mapped), buffer.Size()));
+            for (const Record& record : view) {
+                check += record.flags;
+            }
+            munmap(mapped, buffer.Size());
+        }
+        std::fclose(file);
+    }
+#endif
+    {
+        // Вложенные векторы и Optional
+        Vector<Vector<int32_t>> nested(SIZE / 32);
+        for (size_t i = 0; i < nested.Size(); ++i) {
+            nested[i] = Vector<int32_t>(32);
+            iota(nested[i].begin(), nested[i].end(), static_cast<int32_t>(i));
+        }
+        Vector<Optional<int32_t>> optionals(SIZE);
+        for (size_t i = 0; i < SIZE; i += 3) {
+            optionals[i] = static_cast<int32_t>(i);
+        }
+        Vector<char> nested_buffer;
+        {
+            LOG_DURATION("Vector<Vector<int32_t>> round trip"s);
+            SerializeInto(nested, nested_buffer);
+            check += Deserialize<Vector<int32_t>>(nested_buffer.AsSpan())[100][5];
+        }
+        Vector<char> optional_buffer;
+        {
+            LOG_DURATION("Vector<Optional<int32_t>> round trip"s);
+            SerializeInto(optionals, optional_buffer);
+            check += *Deserialize<Optional<int32_t>>(optional_buffer.AsSpan())[300];
+        }
+        cerr << "  nested: "sv << nested_buffer.Size() / (1 << 20) << " MB, optionals: "sv
+             << optional_buffer.Size() / (1 << 20) << " MB"sv << endl;
+    }
+    cerr << "  check: "sv << check << endl;
+}
+
+void BenchmarkLazy() {
+    using namespace std;
+    const size_t NUM_THREADS = max<size_t>(4, thread::hardware_concurrency());
+    const size_t READS = 5'000'000;
+    const size_t OBJECTS = 100'000;
+    cerr << "Lazy vs mutex-guarded Optional, "sv << NUM_THREADS << " threads:"sv << endl;
+    auto build_table = [] {
+        Vector<int> table(1024);
+        iota(table.begin(), table.end(), 0);
+        return table;
+    };
+    auto run = [NUM_THREADS](auto work) {
+        vector<thread> threads;
+        for (size_t t = 0; t < NUM_THREADS; ++t) {
+            threads.emplace_back(work);
+        }
+        for (thread& thread : threads) {
+            thread.join();
+        }
+    };
+    atomic<int64_t> check = 0;
+    {
+        // Каждый поток читает одну таблицу READS раз
+        Lazy lazy(build_table);
+        LOG_DURATION("Lazy steady-state reads"s);
+        run([&] {
+            int64_t sum = 0;
+            for (size_t i = 0; i < READS; ++i) {
+                sum += lazy.Get()[i & 1023];
+            }
+            check += sum;
+        });
+    }
+    {
+        mutex table_mutex;
+        Optional<Vector<int>> table;
+        LOG_DURATION("Mutex + Optional steady-state reads"s);
+        run([&] {
+            int64_t sum = 0;
+            for (size_t i = 0; i < READS; ++i) {
+                lock_guard lock(table_mutex);
+                if (!table.HasValue()) {
+                    table.EmplaceFrom(build_table);
+                }
+                sum += (*table)[i & 1023];
+            }
+            check += sum;
+        });
+    }
+    // Первые обращения: все потоки одновременно проходят по OBJECTS ещё не вычисленным значениям
+    auto make_value = +[] {
+        return 42;
+    };
+    {
+        Vector<unique_ptr<Lazy<int>>> values;
+        for (size_t i = 0; i < OBJECTS; ++i) {
+            values.PushBack(make_unique<Lazy<int>>(make_value));
+        }
+        LOG_DURATION("Lazy first access"s);
+        run([&] {
+            int64_t sum = 0;
+            for (const auto& value : values) {
+                sum += value->Get();
+            }
+            check += sum;
+        });
+    }
+    {
+        struct Guarded {
+            mutex value_mutex;
+            Optional<int> value;
+        };
+        Vector<unique_ptr<Guarded>> values;
+        for (size_t i = 0; i < OBJECTS; ++i) {
+            values.PushBack(make_unique<Guarded>());
+        }
+        LOG_DURATION("Mutex + Optional first access"s);
+        run([&] {
+            int64_t sum = 0;
+            for (const auto& guarded : values) {
+                lock_guard lock(guarded->value_mutex);
+                if (!guarded->value.HasValue()) {
+                    guarded->value.EmplaceFrom(make_value);
+                }
+                sum += *guarded->value;
+            }
+            check += sum;
+        });
+    }
+    cerr << "  check: "sv << check << endl;
+}
+
+void TestEmplaceFrom() {
+    {
+        // Optional(T&&) перемещает временный объект, EmplaceFrom конструирует на месте
+        C::Reset();
+        Optional<C> moved_in{C()};
+        assert(C::def_ctor == 1 && C::move_ctor == 1);
+        C::Reset();
+        Optional<C> optional;
+        C& value = optional.EmplaceFrom([] {
+            return C();
+        });
+        assert(&value == &*optional && C::def_ctor == 1 && C::move_ctor == 0 && C::copy_ctor == 0);
+        optional.EmplaceFrom([] {
+            return C();
+        });
+        assert(C::def_ctor == 2 && C::dtor == 1 && C::move_ctor == 0);
+    }
+    {
+        C::Reset();
+        Vector<C> v;
+        v.Reserve(4);
+        for (int i = 0; i < 4; ++i) {
+            v.EmplaceBackFrom([] {
+                return C();
+            });
+        }
+        assert(v.Size() == 4 && C::def_ctor == 4 && C::move_ctor == 0 && C::copy_ctor == 0);
+        // При росте перемещаются только старые элементы
+        v.EmplaceBackFrom([] {
+            return C();
+        });
+        assert(v.Size() == 5 && v.Capacity() == 8 && C::def_ctor == 5 && C::move_ctor == 4 && C::copy_ctor == 0);
+        C::Reset();
+        v.PushBack(C());
+        assert(C::def_ctor == 1 && C::move_ctor == 1);
+    }
+    {
+        // factory вызывается до переноса и может читать элементы вектора
+        Vector<int> v;
+        v.PushBack(41);
+        v.EmplaceBackFrom([&v] {
+            return v[0] + 1;
+        });
+        assert(v.Size() == 2 && v[1] == 42);
+    }
+    {
+        // Неперемещаемый тип с мьютексом внутри
+        struct Guarded {
+            explicit Guarded(int value)
+                : value(value) {
+            }
+            std::mutex mutex;
+            int value;
+        };
+        Optional<Guarded> optional;
+        optional.EmplaceFrom([] {
+            return Guarded(1);
+        });
+        assert(optional->value == 1);
+
+        Vector<Guarded> v;
+        v.Reserve(3);
+        for (int i = 0; i < 3; ++i) {
+            v.EmplaceBackFrom([i] {
+                return Guarded(i);
+            });
+        }
+        bool thrown = false;
+        try {
+            v.EmplaceBackFrom([] {
+                return Guarded(3);
+            });
+        } catch (const std::length_error&) {
+            thrown = true;
+        }
+        assert(thrown && v.Size() == 3 && v[2].value == 2);
+    }
+}
+
+void BenchmarkEmplaceFrom() {
+    using namespace std;
+    // 4 КБ данных: перемещение стоит столько же, сколько копирование
+    struct Big {
+        explicit Big(size_t seed) {
+            for (size_t i = 0; i < size(values); ++i) {
+                values[i] = static_cast<double>(seed + i);
+            }
+        }
+        double values[512];
+    };
+    const size_t SIZE = 20'000;
+    const int ROUNDS = 10;
+    cerr << "EmplaceBackFrom vs PushBack, "sv << SIZE << " elements of "sv << sizeof(Big) << " bytes:"sv << endl;
+    double check = 0;
+    Vector<Big> v;
+    v.Reserve(SIZE);
+    // Первое заполнение затрагивает страницы памяти и не измеряется
+    for (size_t i = 0; i < SIZE; ++i) {
+        v.PushBack(Big(i));
+    }
+    {
+        LOG_DURATION("Vector::PushBack(Big(i))"s);
+        for (int round = 0; round < ROUNDS; ++round) {
+            v.Clear(ParallelPolicy{1});
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.PushBack(Big(i + round));
+            }
+            check += v[SIZE - 1].values[0];
+        }
+    }
+    {
+        LOG_DURATION("Vector::EmplaceBackFrom"s);
+        for (int round = 0; round < ROUNDS; ++round) {
+            v.Clear(ParallelPolicy{1});
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.EmplaceBackFrom([i, round] {
+                    return Big(i + round);
+                });
+            }
+            check += v[SIZE - 1].values[0];
+        }
+    }
+    Optional<Big> optional;
+    {
+        LOG_DURATION("Optional = Big(i)"s);
+        for (size_t i = 0; i < SIZE * ROUNDS; ++i) {
+            optional = Big(i);
+            check += optional->values[1];
+        }
+    }
+    {
+        LOG_DURATION("Optional::EmplaceFrom"s);
+        for (size_t i = 0; i < SIZE * ROUNDS; ++i) {
+            optional.EmplaceFrom([i] {
+                return Big(i);
+            });
+            check += optional->values[1];
+        }
+    }
+    {
+        C::Reset();
+        Vector<C> counted;
+        counted.Reserve(1000);
+        for (int i = 0; i < 1000; ++i) {
+            counted.PushBack(C());
+        }
+        cerr << "  PushBack(C()) x1000: "sv;
+        Dump();
+        C::Reset();
+        Vector<C> emplaced;
+        emplaced.Reserve(1000);
+        for (int i = 0; i < 1000; ++i) {
+            emplaced.EmplaceBackFrom([] {
+                return C();
+            });
+        }
+        cerr << "  EmplaceBackFrom x1000: "sv;
+        Dump();
     }
+    cerr << "  check: "sv << check << endl;
 }
 
 int main() {
@@ -1003,7 +5231,57 @@ int main() {
         Test4();
         Test5();
         Test6();
+        TestParallelAlgorithms();
+        TestParallelConstruction();
+        TestRadixSort();
+        TestSimdKernels();
+        TestSoAVector();
+        TestOptionalArray();
+        TestSlotMap();
+        TestFlatHashMap();
+        TestFlatMap();
+        TestEytzingerIndex();
+        TestDaryHeap();
+        TestTieredVector();
+        TestDeque();
+        TestBitVector();
+        TestPackedIntVector();
+        TestCompactVector();
+        TestStaticVector();
+        TestCowVector();
+        TestPersistentVector();
+        TestSpan();
+        TestAdoptRelease();
+        TestViews();
+        TestSerialization();
+        TestLazy();
+        TestEmplaceFrom();
         Benchmark();
+        BenchmarkParallelAlgorithms();
+        BenchmarkParallelConstruction();
+        BenchmarkRadixSort();
+        BenchmarkSimdKernels();
+        BenchmarkSoAVector();
+        BenchmarkOptionalArray();
+        BenchmarkSlotMap();
+        BenchmarkFlatHashMap();
+        BenchmarkFlatMap();
+        BenchmarkEytzingerIndex();
+        BenchmarkDaryHeap();
+        BenchmarkTieredVector();
+        BenchmarkDeque();
+        BenchmarkBitVector();
+        BenchmarkPackedIntVector();
+        BenchmarkCompactVector();
+        BenchmarkStaticVector();
+        BenchmarkCowVector();
+        BenchmarkPersistentVector();
+        BenchmarkSpan();
+        BenchmarkAdopt();
+        BenchmarkViews();
+        BenchmarkSerialization();
+        BenchmarkLazy();
+        BenchmarkEmplaceFrom();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
     }
@@ -1,4 +1,6 @@
+#pragma once
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
 // Исключение этого типа должно генерироватся при обращении к пустому optional
@@ -38,7 +40,8 @@ public:
         }
     }
 
-    Optional(Optional&& other)
+    // noexcept позволяет Vector перемещать Optional при реаллокации, а не копировать
+    Optional(Optional&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
     {
         is_initialized_ = false;
         if (other.HasValue())
@@ -97,7 +100,8 @@ public:
         return *this;
     }
 
-    Optional& operator=(Optional&& rhs)
+    Optional& operator=(Optional&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>
+                                                 && std::is_nothrow_move_assignable_v<T>)
     {
         if (rhs.HasValue())
         {
@@ -134,6 +138,21 @@ public:
         is_initialized_ = true;
     }
 
+    // Конструирует значение из результата factory() прямо в хранилище Optional.
+    // Если factory возвращает T по значению, копирование пропускается гарантированно,
+    // и T может вовсе не иметь конструкторов копирования и перемещения
+    template <typename F>
+    T& EmplaceFrom(F&& factory)
+    {
+        if (HasValue())
+        {
+            Reset();
+        }
+        obj_ = new (data_) T(std::forward<F>(factory)());
+        is_initialized_ = true;
+        return *obj_;
+    }
+
     bool HasValue() const
     {
         return is_initialized_;
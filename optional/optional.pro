@@ -1,5 +1,5 @@
 TEMPLATE = app
-CONFIG += console c++17
+CONFIG += console c++17 thread
 CONFIG -= app_bundle
 CONFIG -= qt
 
@@ -7,5 +7,30 @@ SOURCES += \
         main.cpp
 
 HEADERS += \
+    bit_vector.h \
+    bits.h \
+    compact_vector.h \
+    cow_vector.h \
+    dary_heap.h \
+    deque.h \
+    eytzinger_index.h \
+    flat_hash_map.h \
+    flat_map.h \
+    lazy.h \
+    log_duration.h \
     optional.h \
-    vector.h
+    optional_array.h \
+    packed_int_vector.h \
+    parallel.h \
+    parallel_policy.h \
+    persistent_vector.h \
+    radix_sort.h \
+    serialization.h \
+    simd.h \
+    slot_map.h \
+    soa_vector.h \
+    span.h \
+    static_vector.h \
+    tiered_vector.h \
+    vector.h \
+    views.h
@@ -0,0 +1,296 @@
+#pragma once
+#include "bits.h"
+#include "optional.h"
+#include "vector.h"
+
+#include <cstdint>
+#include <iterator>
+
+// Массив необязательных значений фиксированного размера. Значения лежат подряд
+// в RawMemory, а признаки наличия упакованы в битовую карту по 64 на слово
+template <typename T>
+class OptionalArray {
+public:
+    // Итератор по присутствующим значениям. Пустые позиции пропускаются
+    // целыми словами битовой карты
+    template <typename Value>
+    class BasicIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::remove_const_t<Value>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        BasicIterator() = default;
+
+        Value& operator*() const noexcept
+        {
+            return values_[Index()];
+        }
+
+        Value* operator->() const noexcept
+        {
+            return values_ + Index();
+        }
+
+        // Позиция текущего значения в массиве
+        size_t Index() const noexcept
+        {
+            return word_index_ * BITS_PER_WORD + detail::CountTrailingZeros(word_);
+        }
+
+        BasicIterator& operator++() noexcept
+        {
+            word_ &= word_ - 1;
+            SkipEmptyWords();
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept
+        {
+            BasicIterator copy(*this);
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(const BasicIterator& other) const noexcept
+        {
+            return word_index_ == other.word_index_ && word_ == other.word_;
+        }
+
+        bool operator!=(const BasicIterator& other) const noexcept
+        {
+            return !(*this == other);
+        }
+
+    private:
+        friend class OptionalArray;
+
+        BasicIterator(Value* values, const uint64_t* words, size_t word_count, size_t word_index) noexcept
+            : values_(values)
+            , words_(words)
+            , word_count_(word_count)
+            , word_index_(word_index)
+            , word_(word_index < word_count ? words[word_index] : 0)
+        {
+            SkipEmptyWords();
+        }
+
+        void SkipEmptyWords() noexcept
+        {
+            while (word_ == 0 && word_index_ < word_count_)
+            {
+                if (++word_index_ < word_count_)
+                {
+                    word_ = words_[word_index_];
+                }
+            }
+        }
+
+        Value* values_ = nullptr;
+        const uint64_t* words_ = nullptr;
+        size_t word_count_ = 0;
+        size_t word_index_ = 0;
+        // Ещё не пройденные биты текущего слова
+        uint64_t word_ = 0;
+    };
+
+    using iterator = BasicIterator<T>;
+    using const_iterator = BasicIterator<const T>;
+
+    OptionalArray() = default;
+
+    // Создаёт массив из size пустых позиций
+    explicit OptionalArray(size_t size)
+        : values_(size)
+        , presence_(WordCount(size))
+        , size_(size)
+    {}
+
+    OptionalArray(const OptionalArray& other)
+        : values_(other.size_)
+        , presence_(other.presence_)
+        , size_(other.size_)
+    {
+        const_iterator it = other.begin();
+        try
+        {
+            for (; it != other.end(); ++it)
+            {
+                new (values_ + it.Index()) T(*it);
+            }
+        }
+        catch (...)
+        {
+            for (const_iterator copied = other.begin(); copied != it; ++copied)
+            {
+                values_[copied.Index()].~T();
+            }
+            throw;
+        }
+    }
+
+    OptionalArray(OptionalArray&& other) noexcept
+    {
+        Swap(other);
+    }
+
+    OptionalArray& operator=(const OptionalArray& rhs)
+    {
+        if (this != &rhs)
+        {
+            OptionalArray rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    OptionalArray& operator=(OptionalArray&& rhs) noexcept
+    {
+        Swap(rhs);
+        return *this;
+    }
+
+    ~OptionalArray()
+    {
+        for (T& value : *this)
+        {
+            value.~T();
+        }
+    }
+
+    void Swap(OptionalArray& other) noexcept
+    {
+        values_.Swap(other.values_);
+        presence_.Swap(other.presence_);
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    bool HasValue(size_t index) const noexcept
+    {
+        assert(index < size_);
+        return (presence_[index / BITS_PER_WORD] >> (index % BITS_PER_WORD)) & 1;
+    }
+
+    // Число присутствующих значений
+    size_t CountPresent() const noexcept
+    {
+        size_t count = 0;
+        for (uint64_t word : presence_)
+        {
+            count += detail::PopCount(word);
+        }
+        return count;
+    }
+
+    // Как и Optional::Emplace, заменяет имеющееся значение новым
+    template <typename... Args>
+    T& Emplace(size_t index, Args&&... args)
+    {
+        Reset(index);
+        new (values_ + index) T(std::forward<Args>(args)...);
+        MarkPresent(index);
+        return values_[index];
+    }
+
+    // Присваивает значение, если оно уже есть, иначе конструирует его
+    void Set(size_t index, const T& value)
+    {
+        if (HasValue(index))
+        {
+            values_[index] = value;
+        }
+        else
+        {
+            Emplace(index, value);
+        }
+    }
+
+    void Set(size_t index, T&& value)
+    {
+        if (HasValue(index))
+        {
+            values_[index] = std::move(value);
+        }
+        else
+        {
+            Emplace(index, std::move(value));
+        }
+    }
+
+    void Reset(size_t index) noexcept
+    {
+        if (HasValue(index))
+        {
+            presence_[index / BITS_PER_WORD] &= ~(uint64_t{1} << (index % BITS_PER_WORD));
+            values_[index].~T();
+        }
+    }
+
+    // Копия значения или пустой Optional
+    Optional<T> Get(size_t index) const
+    {
+        if (!HasValue(index))
+        {
+            return {};
+        }
+        return values_[index];
+    }
+
+    T& Value(size_t index)
+    {
+        if (!HasValue(index))
+        {
+            throw BadOptionalAccess{};
+        }
+        return values_[index];
+    }
+
+    const T& Value(size_t index) const
+    {
+        return const_cast<OptionalArray&>(*this).Value(index);
+    }
+
+    iterator begin() noexcept
+    {
+        return {values_.GetAddress(), presence_.begin(), presence_.Size(), 0};
+    }
+
+    iterator end() noexcept
+    {
+        return {values_.GetAddress(), presence_.begin(), presence_.Size(), presence_.Size()};
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return {values_.GetAddress(), presence_.begin(), presence_.Size(), 0};
+    }
+
+    const_iterator end() const noexcept
+    {
+        return {values_.GetAddress(), presence_.begin(), presence_.Size(), presence_.Size()};
+    }
+
+private:
+    static constexpr size_t BITS_PER_WORD = 64;
+
+    static size_t WordCount(size_t size) noexcept
+    {
+        return (size + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    }
+
+    void MarkPresent(size_t index) noexcept
+    {
+        presence_[index / BITS_PER_WORD] |= uint64_t{1} << (index % BITS_PER_WORD);
+    }
+
+    RawMemory<T> values_;
+    Vector<uint64_t> presence_;
+    size_t size_ = 0;
+};
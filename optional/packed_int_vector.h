@@ -0,0 +1,416 @@
+#pragma once
+#include "bits.h"
+#include "simd.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+
+// Вектор целых фиксированной ширины WIDTH битов, упакованных подряд в слова uint64_t.
+// Значение читается не более чем из двух соседних слов, поэтому Get работает за O(1).
+// За последним словом всегда есть ещё одно, и чтение двух слов не требует ветвления
+class PackedIntVector {
+public:
+    // Пустой вектор значений шириной width битов (от 1 до 32)
+    explicit PackedIntVector(unsigned width = 32)
+        : width_(width)
+        , mask_(width == 32 ? ~uint32_t{0} : (uint32_t{1} << width) - 1)
+    {
+        assert(width >= 1 && width <= 32);
+    }
+
+    // Упаковывает values с наименьшей шириной, достаточной для максимума
+    explicit PackedIntVector(const Vector<uint32_t>& values)
+        : PackedIntVector(std::max(1u, detail::BitWidth(values.Size() ? *std::max_element(values.begin(), values.end()) : 0)))
+    {
+        Reserve(values.Size());
+        for (uint32_t value : values)
+        {
+            PushBack(value);
+        }
+    }
+
+    PackedIntVector(const PackedIntVector& other)
+        : words_(other.words_.Capacity())
+        , width_(other.width_)
+        , mask_(other.mask_)
+        , size_(other.size_)
+    {
+        std::copy_n(other.words_.GetAddress(), other.words_.Capacity(), words_.GetAddress());
+    }
+
+    PackedIntVector(PackedIntVector&& other) noexcept
+    {
+        Swap(other);
+    }
+
+    PackedIntVector& operator=(const PackedIntVector& rhs)
+    {
+        if (this != &rhs)
+        {
+            PackedIntVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    PackedIntVector& operator=(PackedIntVector&& rhs) noexcept
+    {
+        Swap(rhs);
+        return *this;
+    }
+
+    void Swap(PackedIntVector& other) noexcept
+    {
+        words_.Swap(other.words_);
+        std::swap(width_, other.width_);
+        std::swap(mask_, other.mask_);
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    unsigned Width() const noexcept
+    {
+        return width_;
+    }
+
+    // Объём памяти под упакованные значения в байтах
+    size_t MemoryUsage() const noexcept
+    {
+        return words_.Capacity() * sizeof(uint64_t);
+    }
+
+    void Reserve(size_t capacity)
+    {
+        const size_t words = WordsFor(capacity);
+        if (words > words_.Capacity())
+        {
+            RawMemory<uint64_t> new_words(words);
+            std::copy_n(words_.GetAddress(), words_.Capacity(), new_words.GetAddress());
+            std::fill(new_words + words_.Capacity(), new_words + words, 0);
+            words_.Swap(new_words);
+        }
+    }
+
+    void PushBack(uint32_t value)
+    {
+        assert((value & ~mask_) == 0);
+        if (WordsFor(size_ + 1) > words_.Capacity())
+        {
+            Reserve(size_ ? size_ * 2 : 1);
+        }
+        const size_t bit = size_ * width_;
+        const size_t word = bit / 64;
+        const unsigned offset = bit % 64;
+        words_[word] |= uint64_t{value} << offset;
+        if (offset + width_ > 64)
+        {
+            words_[word + 1] |= uint64_t{value} >> (64 - offset);
+        }
+        ++size_;
+    }
+
+    uint32_t Get(size_t index) const noexcept
+    {
+        assert(index < size_);
+        const size_t bit = index * width_;
+        const size_t word = bit / 64;
+        const unsigned offset = bit % 64;
+        // Сдвиг на 64 - offset разбит на два, чтобы при offset = 0 не сдвигать на 64
+        const uint64_t high = (words_[word + 1] << 1) << (63 - offset);
+        return static_cast<uint32_t>(((words_[word] >> offset) | high) & mask_);
+    }
+
+    uint32_t operator[](size_t index) const noexcept
+    {
+        return Get(index);
+    }
+
+    // Распаковывает все значения в out
+    void Decode(Vector<uint32_t>& out) const
+    {
+        out.Resize(size_);
+        const uint64_t* words = words_.GetAddress();
+        size_t bit = 0;
+        for (size_t i = 0; i < size_; ++i, bit += width_)
+        {
+            const unsigned offset = bit % 64;
+            const uint64_t high = (words[bit / 64 + 1] << 1) << (63 - offset);
+            out[i] = static_cast<uint32_t>(((words[bit / 64] >> offset) | high) & mask_);
+        }
+    }
+
+private:
+    // Слов под capacity значений, включая запасное слово за последним
+    size_t WordsFor(size_t capacity) const noexcept
+    {
+        return (capacity * width_ + 63) / 64 + 1;
+    }
+
+    RawMemory<uint64_t> words_;
+    unsigned width_ = 32;
+    uint32_t mask_ = ~uint32_t{0};
+    size_t size_ = 0;
+};
+
+namespace detail {
+
+// Блок DeltaVector: 128 разностей одной ширины в вертикальной раскладке из четырёх полос,
+// как в SIMD-BP128. Разность j лежит в полосе j % 4, так что одно 128-битное слово
+// содержит очередные биты четырёх соседних разностей
+inline constexpr size_t DELTA_BLOCK = 128;
+inline constexpr size_t DELTA_LANES = 4;
+
+inline void PackDeltaBlock(const uint32_t* deltas, unsigned width, uint32_t* words) noexcept
+{
+    std::fill_n(words, width * DELTA_LANES, 0);
+    for (size_t j = 0; j < DELTA_BLOCK; ++j)
+    {
+        const size_t lane = j % DELTA_LANES;
+        const size_t bit = j / DELTA_LANES * width;
+        const size_t word = bit / 32;
+        const unsigned offset = bit % 32;
+        words[word * DELTA_LANES + lane] |= deltas[j] << offset;
+        if (offset + width > 32)
+        {
+            words[(word + 1) * DELTA_LANES + lane] |= deltas[j] >> (32 - offset);
+        }
+    }
+}
+
+namespace scalar {
+
+inline uint32_t UnpackDelta(const uint32_t* words, unsigned width, size_t j) noexcept
+{
+    const size_t lane = j % DELTA_LANES;
+    const size_t bit = j / DELTA_LANES * width;
+    const size_t word = bit / 32;
+    const unsigned offset = bit % 32;
+    uint64_t value = words[word * DELTA_LANES + lane] >> offset;
+    if (offset + width > 32)
+    {
+        value |= uint64_t{words[(word + 1) * DELTA_LANES + lane]} << (32 - offset);
+    }
+    return static_cast<uint32_t>(value & ((uint64_t{1} << width) - 1));
+}
+
+// Восстанавливает значения блока с номерами [first, last). previous - значение перед first
+inline void DecodeDeltaBlock(const uint32_t* words, unsigned width, uint32_t previous, size_t first, size_t last,
+                             uint32_t* out) noexcept
+{
+    for (size_t j = first; j < last; ++j)
+    {
+        previous += width ? UnpackDelta(words, width, j) : 0;
+        *out++ = previous;
+    }
+}
+
+}  // namespace scalar
+
+#if VECTOR_SIMD_X86
+namespace sse2 {
+
+// Распаковывает по четыре разности за шаг и восстанавливает значения префиксной суммой в регистре.
+// first кратно четырём, last округляется вверх до кратного четырём
+inline void DecodeDeltaBlock(const uint32_t* words, unsigned width, uint32_t previous, size_t first, size_t last,
+                             uint32_t* out) noexcept
+{
+    if (width == 0)
+    {
+        // Блок равных значений не хранит слов, за ним лежит только заполнение из нулей
+        std::fill(out, out + (last - first + DELTA_LANES - 1) / DELTA_LANES * DELTA_LANES, previous);
+        return;
+    }
+    const __m128i mask = _mm_set1_epi32(static_cast<int>(width == 32 ? ~uint32_t{0} : (uint32_t{1} << width) - 1));
+    __m128i running = _mm_set1_epi32(static_cast<int>(previous));
+    const __m128i* packed = reinterpret_cast<const __m128i*>(words);
+    for (size_t k = first / DELTA_LANES; k * DELTA_LANES < last; ++k)
+    {
+        const size_t bit = k * width;
+        const unsigned offset = bit % 32;
+        // Следующее слово читается всегда: при offset = 0 сдвиг на 32 обнуляет его,
+        // а лишние старшие биты отбрасывает маска
+        const __m128i low = _mm_srl_epi32(_mm_loadu_si128(packed + bit / 32), _mm_cvtsi32_si128(static_cast<int>(offset)));
+        const __m128i high = _mm_sll_epi32(_mm_loadu_si128(packed + bit / 32 + 1), _mm_cvtsi32_si128(static_cast<int>(32 - offset)));
+        const __m128i deltas = _mm_and_si128(_mm_or_si128(low, high), mask);
+        __m128i sums = _mm_add_epi32(deltas, _mm_slli_si128(deltas, 4));
+        sums = _mm_add_epi32(sums, _mm_slli_si128(sums, 8));
+        running = _mm_add_epi32(sums, _mm_shuffle_epi32(running, _MM_SHUFFLE(3, 3, 3, 3)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), running);
+        out += DELTA_LANES;
+    }
+}
+
+}  // namespace sse2
+#endif
+
+}  // namespace detail
+
+// Отсортированная последовательность uint32_t, сжатая разностями. Значения разбиты на блоки
+// по 128, разности внутри блока упакованы общей для блока шириной. Заголовок блока хранит
+// выборки значений перед каждой из SAMPLES частей блока, поэтому Get распаковывает не больше
+// 128 / SAMPLES разностей, а Decode распаковывает блоки целиком с помощью SSE2.
+// Неполный последний блок хранится несжатым
+class DeltaVector {
+public:
+    static constexpr size_t BLOCK_SIZE = detail::DELTA_BLOCK;
+    static constexpr size_t SAMPLES = 2;
+
+    DeltaVector() = default;
+
+    explicit DeltaVector(const Vector<uint32_t>& sorted)
+    {
+        for (uint32_t value : sorted)
+        {
+            PushBack(value);
+        }
+    }
+
+    size_t Size() const noexcept
+    {
+        return blocks_.Size() * BLOCK_SIZE + tail_.Size();
+    }
+
+    // Объём памяти в байтах без учёта запаса ёмкости
+    size_t MemoryUsage() const noexcept
+    {
+        return blocks_.Size() * sizeof(BlockHeader) + (words_.Size() + tail_.Size()) * sizeof(uint32_t);
+    }
+
+    // Значения добавляются в неубывающем порядке
+    void PushBack(uint32_t value)
+    {
+        assert(Size() == 0 || Back() <= value);
+        tail_.PushBack(value);
+        if (tail_.Size() == BLOCK_SIZE)
+        {
+            FlushTail();
+        }
+    }
+
+    uint32_t Get(size_t index) const noexcept
+    {
+        assert(index < Size());
+        const size_t block = index / BLOCK_SIZE;
+        if (block == blocks_.Size())
+        {
+            return tail_[index % BLOCK_SIZE];
+        }
+        // Распаковка начинается с ближайшей выборки и заканчивается на нужном значении
+        const BlockHeader& header = blocks_[block];
+        const size_t position = index % BLOCK_SIZE;
+        const size_t sample = position / SAMPLE_STEP;
+        uint32_t values[SAMPLE_STEP];
+#if VECTOR_SIMD_X86
+        detail::sse2::DecodeDeltaBlock(words_.begin() + header.offset, header.width, header.samples[sample],
+                                       sample * SAMPLE_STEP, position + 1, values);
+#else
+        detail::scalar::DecodeDeltaBlock(words_.begin() + header.offset, header.width, header.samples[sample],
+                                         sample * SAMPLE_STEP, position + 1, values);
+#endif
+        return values[position % SAMPLE_STEP];
+    }
+
+    uint32_t operator[](size_t index) const noexcept
+    {
+        return Get(index);
+    }
+
+    // Распаковывает все значения в out
+    void Decode(Vector<uint32_t>& out, SimdLevel level = DetectSimdLevel()) const
+    {
+        out.Resize(Size());
+        const bool use_sse2 = detail::ClampSimdLevel(level) != SimdLevel::SCALAR;
+        for (size_t block = 0; block < blocks_.Size(); ++block)
+        {
+            const BlockHeader& header = blocks_[block];
+            const uint32_t* words = words_.begin() + header.offset;
+            uint32_t* dst = out.begin() + block * BLOCK_SIZE;
+#if VECTOR_SIMD_X86
+            if (use_sse2)
+            {
+                detail::sse2::DecodeDeltaBlock(words, header.width, header.samples[0], 0, BLOCK_SIZE, dst);
+                continue;
+            }
+#endif
+            (void)use_sse2;
+            detail::scalar::DecodeDeltaBlock(words, header.width, header.samples[0], 0, BLOCK_SIZE, dst);
+        }
+        std::copy(tail_.begin(), tail_.end(), out.begin() + blocks_.Size() * BLOCK_SIZE);
+    }
+
+private:
+    static constexpr size_t SAMPLE_STEP = BLOCK_SIZE / SAMPLES;
+    static_assert(SAMPLE_STEP % detail::DELTA_LANES == 0, "samples must start at a group of lanes");
+
+    // Заголовок блока занимает 16 байтов и читается одним промахом кэша.
+    // samples[s] - значение перед позицией s * SAMPLE_STEP (для первой части - первое значение,
+    // его разность считается нулевой)
+    struct BlockHeader {
+        uint32_t samples[SAMPLES];
+        uint32_t offset;
+        uint32_t width;
+    };
+
+    uint32_t Back() const noexcept
+    {
+        if (tail_.Size() > 0)
+        {
+            return tail_[tail_.Size() - 1];
+        }
+        return Get(Size() - 1);
+    }
+
+    // Сжимает заполненный хвост в новый блок
+    void FlushTail()
+    {
+        uint32_t deltas[BLOCK_SIZE];
+        deltas[0] = 0;
+        uint32_t max_delta = 0;
+        for (size_t j = 1; j < BLOCK_SIZE; ++j)
+        {
+            deltas[j] = tail_[j] - tail_[j - 1];
+            max_delta = std::max(max_delta, deltas[j]);
+        }
+        BlockHeader header;
+        header.samples[0] = tail_[0];
+        for (size_t s = 1; s < SAMPLES; ++s)
+        {
+            header.samples[s] = tail_[s * SAMPLE_STEP - 1];
+        }
+        header.width = detail::BitWidth(max_delta);
+        uint32_t packed[32 * detail::DELTA_LANES];
+        detail::PackDeltaBlock(deltas, header.width, packed);
+        // За последним блоком лежат DELTA_LANES нулевых слов, чтобы распаковка могла
+        // без проверок читать слово, следующее за последним словом блока
+        for (size_t i = 0; i < detail::DELTA_LANES && words_.Size() > 0; ++i)
+        {
+            words_.PopBack();
+        }
+        assert(words_.Size() <= std::numeric_limits<uint32_t>::max());
+        header.offset = static_cast<uint32_t>(words_.Size());
+        for (size_t i = 0; i < header.width * detail::DELTA_LANES; ++i)
+        {
+            words_.PushBack(packed[i]);
+        }
+        for (size_t i = 0; i < detail::DELTA_LANES; ++i)
+        {
+            words_.PushBack(0);
+        }
+        blocks_.PushBack(header);
+        while (tail_.Size() > 0)
+        {
+            tail_.PopBack();
+        }
+    }
+
+    Vector<BlockHeader> blocks_;
+    Vector<uint32_t> words_;
+    Vector<uint32_t> tail_;
+};
@@ -0,0 +1,283 @@
+#pragma once
+#include "optional.h"
+#include "parallel_policy.h"
+#include "span.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+namespace detail {
+
+// Сливает отсортированные [first1, last1) и [first2, last2) в out, используя
+// до num_parts потоков. Диапазон out должен содержать сконструированные элементы
+template <typename It, typename OutIt, typename Compare>
+void ParallelMerge(It first1, It last1, It first2, It last2, OutIt out, size_t num_parts, Compare comp)
+{
+    const size_t size1 = last1 - first1;
+    num_parts = std::max<size_t>(1, std::min(num_parts, size1));
+
+    // Границы частей вычисляются до запуска потоков, пока элементы ещё не перемещены.
+    // Граница в первом диапазоне выбирается равномерно, во втором - бинарным поиском,
+    // так что равные элементы первого диапазона остаются впереди (слияние устойчиво)
+    Vector<It> splits1(num_parts + 1);
+    Vector<It> splits2(num_parts + 1);
+    splits1[0] = first1;
+    splits2[0] = first2;
+    splits1[num_parts] = last1;
+    splits2[num_parts] = last2;
+    for (size_t p = 1; p < num_parts; ++p)
+    {
+        splits1[p] = first1 + size1 * p / num_parts;
+        splits2[p] = std::lower_bound(splits2[p - 1], last2, *splits1[p], comp);
+    }
+
+    RunTasks(num_parts, [&](size_t part) {
+        std::merge(std::make_move_iterator(splits1[part]), std::make_move_iterator(splits1[part + 1]),
+                   std::make_move_iterator(splits2[part]), std::make_move_iterator(splits2[part + 1]),
+                   out + ((splits1[part] - first1) + (splits2[part] - first2)), comp);
+    });
+}
+
+}  // namespace detail
+
+template <typename It, typename F>
+void ParallelForEach(const ParallelPolicy& policy, It first, It last, F f)
+{
+    detail::RunChunks(policy, last - first, [&](size_t, size_t begin, size_t end) {
+        std::for_each(first + begin, first + end, f);
+    });
+}
+
+template <typename It, typename F>
+void ParallelForEach(It first, It last, F f)
+{
+    ParallelForEach(ParallelPolicy{}, first, last, std::move(f));
+}
+
+template <typename T, typename F>
+void ParallelForEach(const ParallelPolicy& policy, Vector<T>& v, F f)
+{
+    ParallelForEach(policy, v.begin(), v.end(), std::move(f));
+}
+
+template <typename T, typename F>
+void ParallelForEach(Vector<T>& v, F f)
+{
+    ParallelForEach(ParallelPolicy{}, v.begin(), v.end(), std::move(f));
+}
+
+// Перегрузки для Span позволяют обработать часть вектора без копирования
+template <typename T, typename F>
+void ParallelForEach(const ParallelPolicy& policy, Span<T> s, F f)
+{
+    ParallelForEach(policy, s.begin(), s.end(), std::move(f));
+}
+
+template <typename T, typename F>
+void ParallelForEach(Span<T> s, F f)
+{
+    ParallelForEach(ParallelPolicy{}, s.begin(), s.end(), std::move(f));
+}
+
+// Записывает f(*it) в out. Выходной диапазон должен быть заранее заполнен
+template <typename It, typename OutIt, typename F>
+OutIt ParallelTransform(const ParallelPolicy& policy, It first, It last, OutIt out, F f)
+{
+    detail::RunChunks(policy, last - first, [&](size_t, size_t begin, size_t end) {
+        std::transform(first + begin, first + end, out + begin, f);
+    });
+    return out + (last - first);
+}
+
+template <typename It, typename OutIt, typename F>
+OutIt ParallelTransform(It first, It last, OutIt out, F f)
+{
+    return ParallelTransform(ParallelPolicy{}, first, last, out, std::move(f));
+}
+
+template <typename T, typename U, typename F>
+void ParallelTransform(const ParallelPolicy& policy, const Vector<T>& in, Vector<U>& out, F f)
+{
+    assert(out.Size() >= in.Size());
+    ParallelTransform(policy, in.begin(), in.end(), out.begin(), std::move(f));
+}
+
+template <typename T, typename U, typename F>
+void ParallelTransform(const Vector<T>& in, Vector<U>& out, F f)
+{
+    ParallelTransform(ParallelPolicy{}, in, out, std::move(f));
+}
+
+template <typename T, typename U, typename F>
+void ParallelTransform(const ParallelPolicy& policy, Span<T> in, Span<U> out, F f)
+{
+    assert(out.Size() >= in.Size());
+    ParallelTransform(policy, in.begin(), in.end(), out.begin(), std::move(f));
+}
+
+template <typename T, typename U, typename F>
+void ParallelTransform(Span<T> in, Span<U> out, F f)
+{
+    ParallelTransform(ParallelPolicy{}, in, out, std::move(f));
+}
+
+// Операция op должна быть ассоциативной: части диапазона сворачиваются независимо
+template <typename It, typename T, typename Op = std::plus<>>
+T ParallelReduce(const ParallelPolicy& policy, It first, It last, T init, Op op = {})
+{
+    const size_t count = last - first;
+    const size_t num_chunks = policy.ChunkCount(count);
+    if (num_chunks <= 1)
+    {
+        for (; first != last; ++first)
+        {
+            init = op(std::move(init), *first);
+        }
+        return init;
+    }
+
+    Vector<detail::CacheLinePadded<Optional<T>>> partials(num_chunks);
+    detail::RunChunks(policy, count, [&](size_t index, size_t begin, size_t end) {
+        It it = first + begin;
+        T acc(*it);
+        for (++it; it != first + end; ++it)
+        {
+            acc = op(std::move(acc), *it);
+        }
+        partials[index].value = std::move(acc);
+    });
+    for (auto& partial : partials)
+    {
+        init = op(std::move(init), std::move(*partial.value));
+    }
+    return init;
+}
+
+template <typename It, typename T, typename Op = std::plus<>>
+T ParallelReduce(It first, It last, T init, Op op = {})
+{
+    return ParallelReduce(ParallelPolicy{}, first, last, std::move(init), std::move(op));
+}
+
+template <typename T, typename U, typename Op = std::plus<>>
+U ParallelReduce(const ParallelPolicy& policy, const Vector<T>& v, U init, Op op = {})
+{
+    return ParallelReduce(policy, v.begin(), v.end(), std::move(init), std::move(op));
+}
+
+template <typename T, typename U, typename Op = std::plus<>>
+U ParallelReduce(const Vector<T>& v, U init, Op op = {})
+{
+    return ParallelReduce(ParallelPolicy{}, v.begin(), v.end(), std::move(init), std::move(op));
+}
+
+template <typename T, typename U, typename Op = std::plus<>>
+U ParallelReduce(const ParallelPolicy& policy, Span<T> s, U init, Op op = {})
+{
+    return ParallelReduce(policy, s.begin(), s.end(), std::move(init), std::move(op));
+}
+
+template <typename T, typename U, typename Op = std::plus<>>
+U ParallelReduce(Span<T> s, U init, Op op = {})
+{
+    return ParallelReduce(ParallelPolicy{}, s.begin(), s.end(), std::move(init), std::move(op));
+}
+
+// Сортировка слиянием: части сортируются независимо, затем попарно сливаются
+// через вспомогательный буфер. Как и std::sort, не гарантирует устойчивости
+template <typename It, typename Compare = std::less<>>
+void ParallelSort(const ParallelPolicy& policy, It first, It last, Compare comp = {})
+{
+    using T = typename std::iterator_traits<It>::value_type;
+
+    const size_t count = last - first;
+    const size_t num_chunks = policy.ChunkCount(count);
+    if (num_chunks <= 1)
+    {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    Vector<size_t> bounds(num_chunks + 1);
+    for (size_t i = 0; i <= num_chunks; ++i)
+    {
+        bounds[i] = count * i / num_chunks;
+    }
+    detail::RunChunks(policy, count, [&](size_t, size_t begin, size_t end) {
+        std::sort(first + begin, first + end, comp);
+    });
+
+    RawMemory<T> buffer(count);
+    std::uninitialized_move_n(first, count, buffer.GetAddress());
+    T* src = buffer.GetAddress();
+    bool in_buffer = true;
+
+    // Если comp или перемещение бросает исключение, элементы буфера всё равно разрушаются.
+    // Диапазон при этом остаётся в допустимом, но неопределённом состоянии
+    try
+    {
+        const size_t num_threads = policy.ThreadCount();
+        for (size_t width = 1; width < num_chunks; width *= 2)
+        {
+            const size_t num_pairs = (num_chunks + 2 * width - 1) / (2 * width);
+            const size_t parts_per_pair = std::max<size_t>(1, num_threads / num_pairs);
+            detail::RunTasks(num_pairs, [&](size_t pair) {
+                const size_t lo = bounds[pair * 2 * width];
+                const size_t mid = bounds[std::min(pair * 2 * width + width, num_chunks)];
+                const size_t hi = bounds[std::min(pair * 2 * width + 2 * width, num_chunks)];
+                if (in_buffer)
+                {
+                    detail::ParallelMerge(src + lo, src + mid, src + mid, src + hi, first + lo, parts_per_pair, comp);
+                }
+                else
+                {
+                    detail::ParallelMerge(first + lo, first + mid, first + mid, first + hi, src + lo, parts_per_pair, comp);
+                }
+            });
+            in_buffer = !in_buffer;
+        }
+
+        if (in_buffer)
+        {
+            std::move(src, src + count, first);
+        }
+    }
+    catch (...)
+    {
+        std::destroy_n(src, count);
+        throw;
+    }
+    std::destroy_n(src, count);
+}
+
+template <typename It, typename Compare = std::less<>>
+void ParallelSort(It first, It last, Compare comp = {})
+{
+    ParallelSort(ParallelPolicy{}, first, last, std::move(comp));
+}
+
+template <typename T, typename Compare = std::less<>>
+void ParallelSort(const ParallelPolicy& policy, Vector<T>& v, Compare comp = {})
+{
+    ParallelSort(policy, v.begin(), v.end(), std::move(comp));
+}
+
+template <typename T, typename Compare = std::less<>>
+void ParallelSort(Vector<T>& v, Compare comp = {})
+{
+    ParallelSort(ParallelPolicy{}, v.begin(), v.end(), std::move(comp));
+}
+
+template <typename T, typename Compare = std::less<>>
+void ParallelSort(const ParallelPolicy& policy, Span<T> s, Compare comp = {})
+{
+    ParallelSort(policy, s.begin(), s.end(), std::move(comp));
+}
+
+template <typename T, typename Compare = std::less<>>
+void ParallelSort(Span<T> s, Compare comp = {})
+{
+    ParallelSort(ParallelPolicy{}, s.begin(), s.end(), std::move(comp));
+}
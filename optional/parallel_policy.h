@@ -0,0 +1,132 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <thread>
+
+// Минимальное число элементов, которое имеет смысл отдавать отдельному потоку.
+// Диапазоны короче обрабатываются последовательно
+inline constexpr size_t PARALLEL_CUTOFF = 1 << 14;
+
+// Размер кэш-линии, по которому выравниваются частичные результаты потоков
+inline constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Параметры разбиения работы между потоками
+struct ParallelPolicy {
+    // 0 - использовать std::thread::hardware_concurrency()
+    size_t num_threads = 0;
+    size_t cutoff = PARALLEL_CUTOFF;
+
+    size_t ThreadCount() const noexcept
+    {
+        if (num_threads != 0)
+        {
+            return num_threads;
+        }
+        const size_t hardware = std::thread::hardware_concurrency();
+        return hardware != 0 ? hardware : 1;
+    }
+
+    // Число частей, на которые следует разбить count элементов
+    size_t ChunkCount(size_t count) const noexcept
+    {
+        const size_t min_chunk = cutoff != 0 ? cutoff : 1;
+        if (count < 2 * min_chunk)
+        {
+            return 1;
+        }
+        return std::min(ThreadCount(), count / min_chunk);
+    }
+};
+
+namespace detail {
+
+// Значение, занимающее целую кэш-линию, чтобы соседние потоки не мешали друг другу
+template <typename T>
+struct alignas(CACHE_LINE_SIZE) CacheLinePadded {
+    T value;
+};
+
+// Выполняет task(i) для i из [0, num_tasks), каждую задачу в своём потоке.
+// Задача 0 выполняется в вызывающем потоке. Первое из выброшенных исключений
+// пробрасывается после завершения всех потоков
+template <typename Task>
+void RunTasks(size_t num_tasks, Task&& task)
+{
+    if (num_tasks == 0)
+    {
+        return;
+    }
+    if (num_tasks == 1)
+    {
+        task(size_t{0});
+        return;
+    }
+
+    // Vector здесь недоступен: этот заголовок подключается из vector.h
+    std::unique_ptr<std::exception_ptr[]> errors(new std::exception_ptr[num_tasks]);
+    std::unique_ptr<std::thread[]> threads(new std::thread[num_tasks - 1]);
+
+    auto run = [&task, &errors](size_t index) {
+        try
+        {
+            task(index);
+        }
+        catch (...)
+        {
+            errors[index] = std::current_exception();
+        }
+    };
+
+    auto join = [&threads, num_tasks] {
+        for (size_t i = 0; i + 1 < num_tasks; ++i)
+        {
+            if (threads[i].joinable())
+            {
+                threads[i].join();
+            }
+        }
+    };
+
+    try
+    {
+        for (size_t i = 1; i < num_tasks; ++i)
+        {
+            threads[i - 1] = std::thread(run, i);
+        }
+    }
+    catch (...)
+    {
+        join();
+        throw;
+    }
+
+    run(0);
+    join();
+    for (size_t i = 0; i < num_tasks; ++i)
+    {
+        if (errors[i])
+        {
+            std::rethrow_exception(errors[i]);
+        }
+    }
+}
+
+// Начало части index при делении count элементов на num_chunks частей
+inline size_t ChunkBegin(size_t count, size_t index, size_t num_chunks) noexcept
+{
+    return count * index / num_chunks;
+}
+
+// Делит [0, count) на равные части и вызывает chunk(index, begin, end) для каждой из них
+template <typename Chunk>
+void RunChunks(const ParallelPolicy& policy, size_t count, Chunk&& chunk)
+{
+    const size_t num_chunks = policy.ChunkCount(count);
+    RunTasks(num_chunks, [&](size_t index) {
+        chunk(index, ChunkBegin(count, index, num_chunks), ChunkBegin(count, index + 1, num_chunks));
+    });
+}
+
+}  // namespace detail
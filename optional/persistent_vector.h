@@ -0,0 +1,976 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Неизменяемый вектор на RRB-дереве (relaxed radix balanced tree) с узлами по 32 элемента.
+// Каждая операция возвращает новую версию, которая разделяет с исходной все узлы, кроме
+// пути к изменённому месту. Последние элементы хранятся в отдельном листе-хвосте, поэтому
+// PushBack обычно копирует только хвост. Внутренние узлы хранят накопленные размеры
+// поддеревьев: после Concat и Slice листья могут быть неполными, и индекс потомка
+// уточняется от оценки index >> shift вперёд. Concat перераспределяет узлы только вдоль
+// шва между деревьями, так что их число на уровне превышает минимальное не больше чем
+// на EXTRA_NODES.
+// Узлы со счётчиком ссылок 1 принадлежат одной версии. Transient меняет такие узлы на месте
+// и подходит для пакетного построения. Счётчики атомарные, и версии можно читать из разных
+// потоков
+template <typename T>
+class PersistentVector {
+    static constexpr size_t BITS = 5;
+    static constexpr size_t WIDTH = size_t{1} << BITS;
+    static constexpr size_t EXTRA_NODES = 2;
+
+    struct Node {
+        std::atomic<size_t> refs = 1;
+        size_t count = 0;
+    };
+
+    struct Leaf : Node {
+        Leaf() = default;
+        Leaf(const Leaf&) = delete;
+        Leaf& operator=(const Leaf&) = delete;
+
+        ~Leaf()
+        {
+            std::destroy_n(Values(), this->count);
+        }
+
+        T* Values() noexcept
+        {
+            return std::launder(reinterpret_cast<T*>(data));
+        }
+
+        const T* Values() const noexcept
+        {
+            return std::launder(reinterpret_cast<const T*>(data));
+        }
+
+        // alignas нужен для правильного выравнивания блока памяти
+        alignas(T) unsigned char data[sizeof(T) * WIDTH];
+    };
+
+    struct Inner : Node {
+        Node* children[WIDTH];
+        // sizes[i] - число элементов в поддеревьях children[0..i]
+        size_t sizes[WIDTH];
+    };
+
+public:
+    class Transient;
+
+    PersistentVector() = default;
+
+    explicit PersistentVector(const Vector<T>& values)
+    {
+        for (const T& value : values)
+        {
+            PushBackInPlace(T(value));
+        }
+    }
+
+    PersistentVector(const PersistentVector& other) noexcept
+        : root_(Retain(other.root_))
+        , tail_(Retain(other.tail_))
+        , shift_(other.shift_)
+        , size_(other.size_)
+    {}
+
+    PersistentVector(PersistentVector&& other) noexcept
+    {
+        Swap(other);
+    }
+
+    PersistentVector& operator=(const PersistentVector& rhs) noexcept
+    {
+        PersistentVector rhs_copy(rhs);
+        Swap(rhs_copy);
+        return *this;
+    }
+
+    PersistentVector& operator=(PersistentVector&& rhs) noexcept
+    {
+        Swap(rhs);
+        return *this;
+    }
+
+    ~PersistentVector()
+    {
+        Release(root_, shift_);
+        Release(tail_, 0);
+    }
+
+    void Swap(PersistentVector& other) noexcept
+    {
+        std::swap(root_, other.root_);
+        std::swap(tail_, other.tail_);
+        std::swap(shift_, other.shift_);
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    // O(log32 n): спуск от корня с уточнением индекса потомка по накопленным размерам
+    const T& Get(size_t index) const noexcept
+    {
+        assert(index < size_);
+        const size_t tree_size = TreeSize();
+        if (index >= tree_size)
+        {
+            return AsLeaf(tail_)->Values()[index - tree_size];
+        }
+        const Node* node = root_;
+        for (size_t shift = shift_; shift > 0; shift -= BITS)
+        {
+            const Inner* inner = AsInner(node);
+            const size_t child = ChildIndex(inner, index, shift);
+            index -= child > 0 ? inner->sizes[child - 1] : 0;
+            node = inner->children[child];
+        }
+        return AsLeaf(node)->Values()[index];
+    }
+
+    const T& operator[](size_t index) const noexcept
+    {
+        return Get(index);
+    }
+
+    // Новая версия с value в конце
+    PersistentVector PushBack(T value) const
+    {
+        PersistentVector result(*this);
+        result.PushBackInPlace(std::move(value));
+        return result;
+    }
+
+    // Новая версия, в которой элемент index заменён на value
+    PersistentVector Set(size_t index, T value) const
+    {
+        PersistentVector result(*this);
+        result.SetInPlace(index, std::move(value));
+        return result;
+    }
+
+    // Новая версия из элементов [begin, end). Разделяет с исходной все узлы, кроме краёв среза
+    PersistentVector Slice(size_t begin, size_t end) const
+    {
+        assert(begin <= end && end <= size_);
+        PersistentVector result(*this);
+        result.TakeInPlace(end);
+        result.DropInPlace(begin);
+        return result;
+    }
+
+    // Новая версия из элементов этой и other. Узлы перестраиваются только вдоль шва
+    PersistentVector Concat(const PersistentVector& other) const
+    {
+        if (other.size_ == 0)
+        {
+            return *this;
+        }
+        if (size_ == 0)
+        {
+            return other;
+        }
+        PersistentVector result(*this);
+        if (result.TailSize() > 0)
+        {
+            result.PushTail();
+        }
+        if (other.root_)
+        {
+            Node* left = std::exchange(result.root_, nullptr);
+            result.root_ = ConcatTrees(left, result.shift_, Retain(other.root_), other.shift_, result.shift_);
+            result.Collapse();
+        }
+        Release(result.tail_, 0);
+        result.tail_ = Retain(other.tail_);
+        result.size_ += other.size_;
+        return result;
+    }
+
+    // Вызывает f для каждого элемента по порядку, проходя листья целиком
+    template <typename F>
+    void ForEach(F f) const
+    {
+        if (root_)
+        {
+            ForEachIn(root_, shift_, f);
+        }
+        if (tail_)
+        {
+            const Leaf* tail = AsLeaf(tail_);
+            for (size_t i = 0; i < tail->count; ++i)
+            {
+                f(tail->Values()[i]);
+            }
+        }
+    }
+
+    Vector<T> ToVector() const
+    {
+        Vector<T> result;
+        result.Reserve(size_);
+        ForEach([&result](const T& value) {
+            result.PushBack(value);
+        });
+        return result;
+    }
+
+    Transient AsTransient() const
+    {
+        return Transient(*this);
+    }
+
+private:
+    // Список узлов одного уровня, владеющий ссылками на них
+    class NodeList {
+    public:
+        explicit NodeList(size_t shift)
+            : shift_(shift)
+        {}
+
+        NodeList(NodeList&& other) noexcept
+            : nodes_(std::move(other.nodes_))
+            , shift_(other.shift_)
+        {}
+
+        NodeList& operator=(NodeList&& rhs) noexcept
+        {
+            nodes_.Swap(rhs.nodes_);
+            std::swap(shift_, rhs.shift_);
+            return *this;
+        }
+
+        ~NodeList()
+        {
+            for (Node* node : nodes_)
+            {
+                Release(node, shift_);
+            }
+        }
+
+        // Забирает ссылку на node, в том числе при исключении
+        void PushBack(Node* node)
+        {
+            try
+            {
+                nodes_.PushBack(node);
+            }
+            catch (...)
+            {
+                Release(node, shift_);
+                throw;
+            }
+        }
+
+        // Передаёт ссылку на узел вызывающему
+        Node* Extract(size_t index) noexcept
+        {
+            return std::exchange(nodes_[index], nullptr);
+        }
+
+        const Node* operator[](size_t index) const noexcept
+        {
+            return nodes_[index];
+        }
+
+        Node* Back() noexcept
+        {
+            return nodes_[nodes_.Size() - 1];
+        }
+
+        size_t Size() const noexcept
+        {
+            return nodes_.Size();
+        }
+
+        size_t Shift() const noexcept
+        {
+            return shift_;
+        }
+
+    private:
+        Vector<Node*> nodes_;
+        size_t shift_;
+    };
+
+    static Leaf* AsLeaf(Node* node) noexcept
+    {
+        return static_cast<Leaf*>(node);
+    }
+
+    static const Leaf* AsLeaf(const Node* node) noexcept
+    {
+        return static_cast<const Leaf*>(node);
+    }
+
+    static Inner* AsInner(Node* node) noexcept
+    {
+        return static_cast<Inner*>(node);
+    }
+
+    static const Inner* AsInner(const Node* node) noexcept
+    {
+        return static_cast<const Inner*>(node);
+    }
+
+    static Node* Retain(Node* node) noexcept
+    {
+        if (node)
+        {
+            node->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        return node;
+    }
+
+    static void Release(Node* node, size_t shift) noexcept
+    {
+        if (!node || node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        {
+            return;
+        }
+        if (shift == 0)
+        {
+            delete AsLeaf(node);
+            return;
+        }
+        Inner* inner = AsInner(node);
+        for (size_t i = 0; i < inner->count; ++i)
+        {
+            Release(inner->children[i], shift - BITS);
+        }
+        delete inner;
+    }
+
+    static size_t NodeSize(const Node* node, size_t shift) noexcept
+    {
+        return shift == 0 ? node->count : AsInner(node)->sizes[node->count - 1];
+    }
+
+    // Номер потомка, в поддереве которого лежит элемент index. Поддерево вмещает не больше
+    // 1 << shift элементов, поэтому index >> shift не превышает искомый номер, а в плотном
+    // узле совпадает с ним
+    static size_t ChildIndex(const Inner* inner, size_t index, size_t shift) noexcept
+    {
+        size_t child = index >> shift;
+        while (inner->sizes[child] <= index)
+        {
+            ++child;
+        }
+        return child;
+    }
+
+    static Leaf* CloneLeaf(const Leaf* leaf)
+    {
+        Leaf* copy = new Leaf;
+        try
+        {
+            for (; copy->count < leaf->count; ++copy->count)
+            {
+                new (copy->Values() + copy->count) T(leaf->Values()[copy->count]);
+            }
+        }
+        catch (...)
+        {
+            delete copy;
+            throw;
+        }
+        return copy;
+    }
+
+    static Inner* CloneInner(const Inner* inner)
+    {
+        Inner* copy = new Inner;
+        for (size_t i = 0; i < inner->count; ++i)
+        {
+            copy->children[i] = Retain(inner->children[i]);
+            copy->sizes[i] = inner->sizes[i];
+        }
+        copy->count = inner->count;
+        return copy;
+    }
+
+    // Копирует узел, если он разделён с другими версиями. После вызова узел можно менять
+    static void MakeUnique(Node*& node, size_t shift)
+    {
+        if (node->refs.load(std::memory_order_acquire) == 1)
+        {
+            return;
+        }
+        Node* copy = shift == 0 ? static_cast<Node*>(CloneLeaf(AsLeaf(node))) : CloneInner(AsInner(node));
+        Release(node, shift);
+        node = copy;
+    }
+
+    // Цепочка узлов с одним потомком от уровня shift до листа. Забирает ссылку на лист
+    static Node* NewPath(size_t shift, Node* leaf)
+    {
+        Node* node = leaf;
+        for (size_t level = BITS; level <= shift; level += BITS)
+        {
+            node = Wrap(node, level - BITS);
+        }
+        return node;
+    }
+
+    // Узел уровня shift + BITS с единственным потомком node. Забирает ссылку на node
+    static Node* Wrap(Node* node, size_t shift)
+    {
+        Inner* parent = nullptr;
+        try
+        {
+            parent = new Inner;
+        }
+        catch (...)
+        {
+            Release(node, shift);
+            throw;
+        }
+        parent->children[0] = node;
+        parent->sizes[0] = NodeSize(node, shift);
+        parent->count = 1;
+        return parent;
+    }
+
+    // Есть ли в правом крае поддерева место для ещё одного листа
+    static bool HasRoom(const Node* node, size_t shift) noexcept
+    {
+        if (shift == 0)
+        {
+            return false;
+        }
+        const Inner* inner = AsInner(node);
+        return inner->count < WIDTH || HasRoom(inner->children[inner->count - 1], shift - BITS);
+    }
+
+    // Добавляет лист в правый край поддерева, в котором есть место. Забирает ссылку на лист
+    static void AppendLeaf(Node*& node, size_t shift, Node* leaf)
+    {
+        try
+        {
+            MakeUnique(node, shift);
+        }
+        catch (...)
+        {
+            Release(leaf, 0);
+            throw;
+        }
+        Inner* inner = AsInner(node);
+        const size_t last = inner->count - 1;
+        const size_t leaf_size = leaf->count;
+        if (shift > BITS && HasRoom(inner->children[last], shift - BITS))
+        {
+            AppendLeaf(inner->children[last], shift - BITS, leaf);
+            inner->sizes[last] += leaf_size;
+        }
+        else
+        {
+            inner->children[last + 1] = NewPath(shift - BITS, leaf);
+            inner->sizes[last + 1] = inner->sizes[last] + leaf_size;
+            ++inner->count;
+        }
+    }
+
+    size_t TailSize() const noexcept
+    {
+        return tail_ ? tail_->count : 0;
+    }
+
+    size_t TreeSize() const noexcept
+    {
+        return size_ - TailSize();
+    }
+
+    // Переносит непустой хвост в дерево
+    void PushTail()
+    {
+        const size_t leaf_size = tail_->count;
+        Node* leaf = Retain(tail_);
+        if (!root_)
+        {
+            root_ = leaf;
+            shift_ = 0;
+        }
+        else if (HasRoom(root_, shift_))
+        {
+            AppendLeaf(root_, shift_, leaf);
+        }
+        else
+        {
+            Node* path = NewPath(shift_, leaf);
+            Inner* root = nullptr;
+            try
+            {
+                root = new Inner;
+            }
+            catch (...)
+            {
+                Release(path, shift_);
+                throw;
+            }
+            root->children[0] = root_;
+            root->sizes[0] = NodeSize(root_, shift_);
+            root->children[1] = path;
+            root->sizes[1] = root->sizes[0] + leaf_size;
+            root->count = 2;
+            root_ = root;
+            shift_ += BITS;
+        }
+        Release(tail_, 0);
+        tail_ = nullptr;
+    }
+
+    void PushBackInPlace(T&& value)
+    {
+        if (tail_ && tail_->count == WIDTH)
+        {
+            PushTail();
+        }
+        if (tail_)
+        {
+            MakeUnique(tail_, 0);
+        }
+        else
+        {
+            tail_ = new Leaf;
+        }
+        new (AsLeaf(tail_)->Values() + tail_->count) T(std::move(value));
+        ++tail_->count;
+        ++size_;
+    }
+
+    void SetInPlace(size_t index, T&& value)
+    {
+        assert(index < size_);
+        const size_t tree_size = TreeSize();
+        if (index >= tree_size)
+        {
+            MakeUnique(tail_, 0);
+            AsLeaf(tail_)->Values()[index - tree_size] = std::move(value);
+            return;
+        }
+        Node** node = &root_;
+        for (size_t shift = shift_; shift > 0; shift -= BITS)
+        {
+            MakeUnique(*node, shift);
+            Inner* inner = AsInner(*node);
+            const size_t child = ChildIndex(inner, index, shift);
+            index -= child > 0 ? inner->sizes[child - 1] : 0;
+            node = &inner->children[child];
+        }
+        MakeUnique(*node, 0);
+        AsLeaf(*node)->Values()[index] = std::move(value);
+    }
+
+    // Убирает корни с единственным потомком
+    void Collapse() noexcept
+    {
+        while (shift_ > 0 && root_->count == 1)
+        {
+            Node* child = Retain(AsInner(root_)->children[0]);
+            Release(root_, shift_);
+            root_ = child;
+            shift_ -= BITS;
+        }
+    }
+
+    // Оставляет первые n элементов
+    void TakeInPlace(size_t n)
+    {
+        if (n == size_)
+        {
+            return;
+        }
+        const size_t tree_size = TreeSize();
+        if (n > tree_size)
+        {
+            MakeUnique(tail_, 0);
+            DropLeafBack(AsLeaf(tail_), tail_->count - (n - tree_size));
+        }
+        else
+        {
+            Release(tail_, 0);
+            tail_ = nullptr;
+            if (n == 0)
+            {
+                Release(root_, shift_);
+                root_ = nullptr;
+                shift_ = 0;
+            }
+            else if (n < tree_size)
+            {
+                TakeTree(root_, shift_, n);
+                Collapse();
+            }
+        }
+        size_ = n;
+    }
+
+    // Убирает первые n элементов
+    void DropInPlace(size_t n)
+    {
+        if (n == 0)
+        {
+            return;
+        }
+        const size_t tree_size = TreeSize();
+        if (n >= tree_size)
+        {
+            Release(root_, shift_);
+            root_ = nullptr;
+            shift_ = 0;
+            if (n - tree_size == TailSize())
+            {
+                Release(tail_, 0);
+                tail_ = nullptr;
+            }
+            else if (n > tree_size)
+            {
+                MakeUnique(tail_, 0);
+                DropLeafFront(AsLeaf(tail_), n - tree_size);
+            }
+        }
+        else
+        {
+            DropTree(root_, shift_, n);
+            Collapse();
+        }
+        size_ -= n;
+    }
+
+    static void DropLeafBack(Leaf* leaf, size_t count) noexcept
+    {
+        std::destroy_n(leaf->Values() + leaf->count - count, count);
+        leaf->count -= count;
+    }
+
+    static void DropLeafFront(Leaf* leaf, size_t count)
+    {
+        T* values = leaf->Values();
+        std::move(values + count, values + leaf->count, values);
+        DropLeafBack(leaf, count);
+    }
+
+    // Оставляет в поддереве первые n элементов, 0 < n < размера поддерева
+    static void TakeTree(Node*& node, size_t shift, size_t n)
+    {
+        MakeUnique(node, shift);
+        if (shift == 0)
+        {
+            DropLeafBack(AsLeaf(node), node->count - n);
+            return;
+        }
+        Inner* inner = AsInner(node);
+        const size_t child = ChildIndex(inner, n - 1, shift);
+        for (size_t i = child + 1; i < inner->count; ++i)
+        {
+            Release(inner->children[i], shift - BITS);
+        }
+        inner->count = child + 1;
+        const size_t rest = n - (child > 0 ? inner->sizes[child - 1] : 0);
+        if (rest < NodeSize(inner->children[child], shift - BITS))
+        {
+            TakeTree(inner->children[child], shift - BITS, rest);
+        }
+        inner->sizes[child] = n;
+    }
+
+    // Убирает из поддерева первые n элементов, 0 < n < размера поддерева
+    static void DropTree(Node*& node, size_t shift, size_t n)
+    {
+        MakeUnique(node, shift);
+        if (shift == 0)
+        {
+            DropLeafFront(AsLeaf(node), n);
+            return;
+        }
+        Inner* inner = AsInner(node);
+        const size_t child = ChildIndex(inner, n, shift);
+        const size_t rest = n - (child > 0 ? inner->sizes[child - 1] : 0);
+        for (size_t i = 0; i < child; ++i)
+        {
+            Release(inner->children[i], shift - BITS);
+        }
+        for (size_t i = child; i < inner->count; ++i)
+        {
+            inner->children[i - child] = inner->children[i];
+            inner->sizes[i - child] = inner->sizes[i] - n;
+        }
+        inner->count -= child;
+        if (rest > 0)
+        {
+            DropTree(inner->children[0], shift - BITS, rest);
+        }
+    }
+
+    // Склеивает два дерева, забирая ссылки на их корни. Низкое дерево подвешивается
+    // под цепочку узлов, чтобы высоты совпали. В shift записывается уровень нового корня
+    static Node* ConcatTrees(Node* left, size_t left_shift, Node* right, size_t right_shift, size_t& shift)
+    {
+        try
+        {
+            for (; left_shift < right_shift; left_shift += BITS)
+            {
+                left = Wrap(left, left_shift);
+            }
+        }
+        catch (...)
+        {
+            Release(right, right_shift);
+            throw;
+        }
+        try
+        {
+            for (; right_shift < left_shift; right_shift += BITS)
+            {
+                right = Wrap(right, right_shift);
+            }
+        }
+        catch (...)
+        {
+            Release(left, left_shift);
+            throw;
+        }
+        NodeList roots(left_shift);
+        try
+        {
+            roots.PushBack(left);
+        }
+        catch (...)
+        {
+            Release(right, right_shift);
+            throw;
+        }
+        roots.PushBack(right);
+        NodeList nodes = MergeSeam(left, right, left_shift);
+        shift = left_shift;
+        if (nodes.Size() > 1)
+        {
+            nodes = Group(nodes);
+            shift += BITS;
+        }
+        return nodes.Extract(0);
+    }
+
+    // Узлы уровня shift, которыми заменяются соседние left и right: сначала рекурсивно
+    // склеиваются их крайние потомки, затем потомки на шве перераспределяются
+    static NodeList MergeSeam(Node* left, Node* right, size_t shift)
+    {
+        NodeList result(shift);
+        if (shift == 0)
+        {
+            result.PushBack(Retain(left));
+            result.PushBack(Retain(right));
+            return result;
+        }
+        const Inner* left_inner = AsInner(left);
+        const Inner* right_inner = AsInner(right);
+        NodeList middle = MergeSeam(left_inner->children[left_inner->count - 1], right_inner->children[0], shift - BITS);
+        NodeList children(shift - BITS);
+        for (size_t i = 0; i + 1 < left_inner->count; ++i)
+        {
+            children.PushBack(Retain(left_inner->children[i]));
+        }
+        for (size_t i = 0; i < middle.Size(); ++i)
+        {
+            children.PushBack(middle.Extract(i));
+        }
+        for (size_t i = 1; i < right_inner->count; ++i)
+        {
+            children.PushBack(Retain(right_inner->children[i]));
+        }
+        Rebalance(children);
+        return Group(children);
+    }
+
+    // Перераспределяет элементы узлов так, чтобы узлов было не больше минимального числа
+    // плюс EXTRA_NODES. Узел с WIDTH - 1 и больше элементами остаётся на месте, а первый
+    // более пустой узел раздаёт свои элементы следующим за ним. Узлы, чьё содержимое
+    // не изменилось, переиспользуются
+    static void Rebalance(NodeList& nodes)
+    {
+        Vector<size_t> plan(nodes.Size());
+        size_t total = 0;
+        for (size_t i = 0; i < nodes.Size(); ++i)
+        {
+            plan[i] = nodes[i]->count;
+            total += plan[i];
+        }
+        const size_t optimal = (total + WIDTH - 1) / WIDTH;
+        size_t count = nodes.Size();
+        if (count <= optimal + EXTRA_NODES)
+        {
+            return;
+        }
+        for (size_t i = 0; count > optimal + EXTRA_NODES;)
+        {
+            while (plan[i] >= WIDTH - 1)
+            {
+                ++i;
+            }
+            size_t remaining = plan[i];
+            for (; remaining > 0; ++i)
+            {
+                const size_t taken = std::min(remaining + plan[i + 1], WIDTH);
+                remaining = remaining + plan[i + 1] - taken;
+                plan[i] = taken;
+            }
+            for (size_t j = i; j + 1 < count; ++j)
+            {
+                plan[j] = plan[j + 1];
+            }
+            --count;
+            --i;
+        }
+
+        NodeList result(nodes.Shift());
+        size_t source = 0;
+        size_t offset = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (offset == 0 && nodes[source]->count == plan[i])
+            {
+                result.PushBack(nodes.Extract(source++));
+                continue;
+            }
+            result.PushBack(nodes.Shift() == 0 ? static_cast<Node*>(new Leaf) : new Inner);
+            Node* node = result.Back();
+            while (node->count < plan[i])
+            {
+                const Node* from = nodes[source];
+                const size_t moved = std::min(plan[i] - node->count, from->count - offset);
+                CopySlots(from, offset, moved, node, nodes.Shift());
+                offset += moved;
+                if (offset == from->count)
+                {
+                    ++source;
+                    offset = 0;
+                }
+            }
+        }
+        nodes = std::move(result);
+    }
+
+    // Добавляет в конец узла to элементы from[offset, offset + count)
+    static void CopySlots(const Node* from, size_t offset, size_t count, Node* to, size_t shift)
+    {
+        if (shift == 0)
+        {
+            const T* values = AsLeaf(from)->Values() + offset;
+            Leaf* leaf = AsLeaf(to);
+            for (size_t i = 0; i < count; ++i, ++leaf->count)
+            {
+                new (leaf->Values() + leaf->count) T(values[i]);
+            }
+            return;
+        }
+        const Inner* source = AsInner(from);
+        Inner* inner = AsInner(to);
+        for (size_t i = offset; i < offset + count; ++i, ++inner->count)
+        {
+            inner->children[inner->count] = Retain(source->children[i]);
+            inner->sizes[inner->count] = (inner->count > 0 ? inner->sizes[inner->count - 1] : 0)
+                + NodeSize(source->children[i], shift - BITS);
+        }
+    }
+
+    // Собирает узлы под родителей уровнем выше, по WIDTH потомков на родителя
+    static NodeList Group(NodeList& nodes)
+    {
+        const size_t shift = nodes.Shift();
+        NodeList parents(shift + BITS);
+        for (size_t i = 0; i < nodes.Size(); ++i)
+        {
+            if (i % WIDTH == 0)
+            {
+                parents.PushBack(new Inner);
+            }
+            Inner* parent = AsInner(parents.Back());
+            const size_t size = NodeSize(nodes[i], shift);
+            parent->children[parent->count] = nodes.Extract(i);
+            parent->sizes[parent->count] = (parent->count > 0 ? parent->sizes[parent->count - 1] : 0) + size;
+            ++parent->count;
+        }
+        return parents;
+    }
+
+    template <typename F>
+    static void ForEachIn(const Node* node, size_t shift, F& f)
+    {
+        if (shift == 0)
+        {
+            const Leaf* leaf = AsLeaf(node);
+            for (size_t i = 0; i < leaf->count; ++i)
+            {
+                f(leaf->Values()[i]);
+            }
+            return;
+        }
+        const Inner* inner = AsInner(node);
+        for (size_t i = 0; i < inner->count; ++i)
+        {
+            ForEachIn(inner->children[i], shift - BITS, f);
+        }
+    }
+
+    Node* root_ = nullptr;
+    Node* tail_ = nullptr;
+    // Уровень корня: 0, если корень - лист
+    size_t shift_ = 0;
+    size_t size_ = 0;
+};
+
+// Изменяемая версия PersistentVector для пакетного построения и правок. Узлы, которыми
+// владеет только она, меняются на месте, поэтому PushBack не копирует хвост, а Set копирует
+// путь к элементу только при первом обращении. Persistent возвращает неизменяемую версию
+template <typename T>
+class PersistentVector<T>::Transient {
+public:
+    Transient() = default;
+
+    explicit Transient(PersistentVector vector) noexcept
+        : vector_(std::move(vector))
+    {}
+
+    size_t Size() const noexcept
+    {
+        return vector_.Size();
+    }
+
+    const T& Get(size_t index) const noexcept
+    {
+        return vector_.Get(index);
+    }
+
+    const T& operator[](size_t index) const noexcept
+    {
+        return vector_.Get(index);
+    }
+
+    void PushBack(T value)
+    {
+        vector_.PushBackInPlace(std::move(value));
+    }
+
+    void Set(size_t index, T value)
+    {
+        vector_.SetInPlace(index, std::move(value));
+    }
+
+    // Забирает накопленную версию. Transient после этого пуст
+    PersistentVector Persistent() noexcept
+    {
+        return std::move(vector_);
+    }
+
+private:
+    PersistentVector vector_;
+};
@@ -0,0 +1,225 @@
+#pragma once
+#include "parallel_policy.h"
+#include "span.h"
+#include "vector.h"
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+inline constexpr size_t RADIX_BITS = 8;
+inline constexpr size_t RADIX_BUCKETS = size_t{1} << RADIX_BITS;
+
+// Переводит арифметический ключ в беззнаковое число того же размера так,
+// что порядок беззнаковых чисел совпадает с порядком исходных ключей
+template <typename Key>
+auto ToRadixKey(Key key) noexcept
+{
+    static_assert(std::is_arithmetic_v<Key> && !std::is_same_v<Key, bool>, "RadixSort requires an arithmetic key");
+    if constexpr (std::is_floating_point_v<Key>)
+    {
+        using Bits = std::conditional_t<sizeof(Key) == sizeof(uint32_t), uint32_t, uint64_t>;
+        static_assert(sizeof(Key) == sizeof(Bits), "Only IEEE single and double precision keys are supported");
+        Bits bits;
+        std::memcpy(&bits, &key, sizeof(bits));
+        const Bits sign = Bits{1} << (sizeof(Bits) * 8 - 1);
+        // У отрицательных чисел инвертируются все биты, у положительных - только знаковый
+        return (bits & sign) ? static_cast<Bits>(~bits) : static_cast<Bits>(bits | sign);
+    }
+    else if constexpr (std::is_signed_v<Key>)
+    {
+        using Bits = std::make_unsigned_t<Key>;
+        return static_cast<Bits>(static_cast<Bits>(key) ^ (Bits{1} << (sizeof(Bits) * 8 - 1)));
+    }
+    else
+    {
+        return key;
+    }
+}
+
+template <typename Bits>
+size_t RadixDigit(Bits key, size_t pass) noexcept
+{
+    return static_cast<size_t>(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+}
+
+}  // namespace detail
+
+// Устойчивая поразрядная сортировка (LSD) по ключу key_fn(element), где ключ -
+// целое число или число с плавающей точкой. Проходы, в которых разряд одинаков
+// у всех элементов, пропускаются. При нескольких частях в policy подсчёт
+// гистограмм и распределение элементов выполняются параллельно. Сортирует
+// элементы Span на месте, поэтому часть вектора можно отсортировать без копирования
+template <typename T, typename KeyFn>
+void RadixSort(const ParallelPolicy& policy, Span<T> v, KeyFn key_fn)
+{
+    static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>,
+                  "RadixSort requires nothrow movable elements");
+    using detail::RADIX_BUCKETS;
+    using Bits = decltype(detail::ToRadixKey(key_fn(std::declval<const T&>())));
+    constexpr size_t NUM_PASSES = sizeof(Bits);
+
+    const size_t size = v.Size();
+    if (size < 2)
+    {
+        return;
+    }
+
+    const size_t num_chunks = policy.ChunkCount(size);
+    // counts[(chunk * NUM_PASSES + pass) * RADIX_BUCKETS + digit]
+    Vector<size_t> counts(num_chunks * NUM_PASSES * RADIX_BUCKETS);
+    auto chunk_counts = [&counts](size_t chunk, size_t pass) {
+        return &counts[(chunk * NUM_PASSES + pass) * RADIX_BUCKETS];
+    };
+
+    // Гистограммы всех разрядов собираются за один проход по данным
+    detail::RunChunks(policy, size, [&](size_t chunk, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const Bits key = detail::ToRadixKey(key_fn(v[i]));
+            for (size_t pass = 0; pass < NUM_PASSES; ++pass)
+            {
+                ++chunk_counts(chunk, pass)[detail::RadixDigit(key, pass)];
+            }
+        }
+    });
+
+    RawMemory<T> buffer;
+    T* src = v.begin();
+    T* dst = nullptr;
+    bool dst_constructed = false;
+    bool first_pass = true;
+    Vector<size_t> offsets(num_chunks * RADIX_BUCKETS);
+
+    for (size_t pass = 0; pass < NUM_PASSES; ++pass)
+    {
+        size_t totals[RADIX_BUCKETS] = {};
+        bool constant_digit = false;
+        for (size_t digit = 0; digit < RADIX_BUCKETS && !constant_digit; ++digit)
+        {
+            for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+            {
+                totals[digit] += chunk_counts(chunk, pass)[digit];
+            }
+            constant_digit = totals[digit] == size;
+        }
+        if (constant_digit)
+        {
+            continue;
+        }
+
+        if (first_pass)
+        {
+            buffer = RawMemory<T>(size);
+            dst = buffer.GetAddress();
+        }
+        else if (num_chunks > 1)
+        {
+            // После предыдущего прохода элементы переставлены, и гистограммы частей
+            // для текущего разряда приходится пересчитать
+            detail::RunChunks(policy, size, [&](size_t chunk, size_t begin, size_t end) {
+                size_t* chunk_pass_counts = chunk_counts(chunk, pass);
+                std::fill_n(chunk_pass_counts, RADIX_BUCKETS, 0);
+                for (size_t i = begin; i < end; ++i)
+                {
+                    ++chunk_pass_counts[detail::RadixDigit(detail::ToRadixKey(key_fn(src[i])), pass)];
+                }
+            });
+        }
+
+        size_t offset = 0;
+        for (size_t digit = 0; digit < RADIX_BUCKETS; ++digit)
+        {
+            for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+            {
+                offsets[chunk * RADIX_BUCKETS + digit] = offset;
+                offset += chunk_counts(chunk, pass)[digit];
+            }
+        }
+
+        detail::RunChunks(policy, size, [&](size_t chunk, size_t begin, size_t end) {
+            size_t* chunk_offsets = &offsets[chunk * RADIX_BUCKETS];
+            for (size_t i = begin; i < end; ++i)
+            {
+                T* out = dst + chunk_offsets[detail::RadixDigit(detail::ToRadixKey(key_fn(src[i])), pass)]++;
+                if (dst_constructed)
+                {
+                    *out = std::move(src[i]);
+                }
+                else
+                {
+                    new (out) T(std::move(src[i]));
+                }
+            }
+        });
+
+        // После первого прохода оба массива состоят из сконструированных элементов
+        std::swap(src, dst);
+        dst_constructed = true;
+        first_pass = false;
+    }
+
+    if (first_pass)
+    {
+        return;
+    }
+    if (src != v.begin())
+    {
+        std::move(src, src + size, v.begin());
+    }
+    std::destroy_n(buffer.GetAddress(), size);
+}
+
+template <typename T, typename KeyFn>
+void RadixSort(const ParallelPolicy& policy, Vector<T>& v, KeyFn key_fn)
+{
+    RadixSort(policy, v.AsSpan(), std::move(key_fn));
+}
+
+template <typename T, typename KeyFn>
+void RadixSort(Span<T> v, KeyFn key_fn)
+{
+    RadixSort(ParallelPolicy{1}, v, std::move(key_fn));
+}
+
+template <typename T, typename KeyFn>
+void RadixSort(Vector<T>& v, KeyFn key_fn)
+{
+    // По умолчанию сортировка однопоточная
+    RadixSort(ParallelPolicy{1}, v, std::move(key_fn));
+}
+
+template <typename T>
+void RadixSort(const ParallelPolicy& policy, Vector<T>& v)
+{
+    RadixSort(policy, v, [](const T& value) {
+        return value;
+    });
+}
+
+template <typename T>
+void RadixSort(Vector<T>& v)
+{
+    RadixSort(v, [](const T& value) {
+        return value;
+    });
+}
+
+template <typename T>
+void RadixSort(const ParallelPolicy& policy, Span<T> v)
+{
+    RadixSort(policy, v, [](const T& value) {
+        return value;
+    });
+}
+
+template <typename T>
+void RadixSort(Span<T> v)
+{
+    RadixSort(v, [](const T& value) {
+        return value;
+    });
+}
@@ -0,0 +1,476 @@
+#pragma once
+#include "optional.h"
+#include "span.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define VECTOR_POSIX_IO 1
+#include <cerrno>
+#include <climits>
+#include <system_error>
+#include <sys/uio.h>
+#include <unistd.h>
+#else
+#define VECTOR_POSIX_IO 0
+#endif
+
+// Двоичный формат Vector<T>. Поток начинается с SerializationHeader, за которым идут элементы.
+// Тривиально копируемые значения записываются как есть, с выравниванием относительно начала
+// потока, поэтому массив таких элементов можно читать прямо из буфера без копирования.
+// Vector<U> внутри записывается как uint64_t число элементов и элементы, Optional<U> - как
+// байт-признак и значение. Порядок байтов - порядок байтов машины, записавшей поток
+
+inline constexpr uint32_t SERIALIZATION_MAGIC = 0x52455356;  // "VSER"
+inline constexpr uint16_t SERIALIZATION_VERSION = 1;
+
+// Флаг заголовка: элементы лежат сплошным массивом и их можно читать без копирования
+inline constexpr uint16_t SERIALIZATION_CONTIGUOUS = 1;
+
+struct SerializationHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    uint32_t element_size;
+    uint32_t element_alignment;
+    uint64_t count;
+};
+
+// Поток повреждён или записан для другого типа элементов
+class SerializationError : public std::runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+namespace detail {
+
+template <typename T>
+struct IsVector : std::false_type {};
+
+template <typename T>
+struct IsVector<Vector<T>> : std::true_type {};
+
+template <typename T>
+struct IsOptional : std::false_type {};
+
+template <typename T>
+struct IsOptional<Optional<T>> : std::true_type {};
+
+template <typename T>
+struct IsSerializable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+struct IsSerializable<Vector<T>> : IsSerializable<T> {};
+
+template <typename T>
+struct IsSerializable<Optional<T>> : IsSerializable<T> {};
+
+// Значения не больше этого размера копируются в служебный буфер, а не записываются
+// отдельным фрагментом: иначе Vector<Optional<int>> дал бы по фрагменту на элемент
+inline constexpr size_t SMALL_PIECE_SIZE = 64;
+
+// Список фрагментов потока. Большие массивы не копируются: фрагмент ссылается на память
+// самого вектора. Мелкие значения и выравнивание собираются в служебный буфер
+class SerializationPieces {
+public:
+    size_t Offset() const noexcept
+    {
+        return offset_;
+    }
+
+    void AddExternal(const void* data, size_t size)
+    {
+        if (size <= SMALL_PIECE_SIZE)
+        {
+            AddScratch(data, size);
+            return;
+        }
+        pieces_.PushBack(Piece{static_cast<const char*>(data), 0, size});
+        offset_ += size;
+    }
+
+    void AddScratch(const void* data, size_t size)
+    {
+        if (size == 0)
+        {
+            return;
+        }
+        // Соседние служебные фрагменты сливаются в один
+        if (pieces_.Size() == 0 || pieces_[pieces_.Size() - 1].data != nullptr)
+        {
+            pieces_.PushBack(Piece{nullptr, scratch_.Size(), 0});
+        }
+        const size_t start = scratch_.Size();
+        if (start + size > scratch_.Capacity())
+        {
+            scratch_.Reserve(std::max(start + size, 2 * scratch_.Capacity()));
+        }
+        scratch_.Resize(start + size);
+        std::memcpy(scratch_.begin() + start, data, size);
+        pieces_[pieces_.Size() - 1].size += size;
+        offset_ += size;
+    }
+
+    // Дополняет поток нулями до границы alignment
+    void Pad(size_t alignment)
+    {
+        static constexpr char ZEROS[alignof(std::max_align_t) * 4] = {};
+        const size_t padding = (alignment - offset_ % alignment) % alignment;
+        for (size_t left = padding; left > 0;)
+        {
+            const size_t step = std::min(left, sizeof(ZEROS));
+            AddScratch(ZEROS, step);
+            left -= step;
+        }
+    }
+
+    // f(data, size) для каждого фрагмента по порядку
+    template <typename F>
+    void ForEach(F f) const
+    {
+        for (const Piece& piece : pieces_)
+        {
+            f(piece.data ? piece.data : scratch_.begin() + piece.offset, piece.size);
+        }
+    }
+
+private:
+    struct Piece {
+        // nullptr - фрагмент служебного буфера, начинающийся с offset
+        const char* data;
+        size_t offset;
+        size_t size;
+    };
+
+    Vector<Piece> pieces_;
+    Vector<char> scratch_;
+    size_t offset_ = 0;
+};
+
+template <typename T>
+void EncodeElements(const T* data, size_t count, SerializationPieces& pieces);
+
+template <typename T>
+void EncodeValue(const T& value, SerializationPieces& pieces)
+{
+    if constexpr (std::is_trivially_copyable_v<T>)
+    {
+        pieces.Pad(alignof(T));
+        pieces.AddExternal(&value, sizeof(T));
+    }
+    else if constexpr (IsVector<T>::value)
+    {
+        pieces.Pad(alignof(uint64_t));
+        const uint64_t count = value.Size();
+        pieces.AddScratch(&count, sizeof(count));
+        EncodeElements(value.begin(), value.Size(), pieces);
+    }
+    else
+    {
+        static_assert(IsOptional<T>::value, "unsupported type");
+        const uint8_t has_value = value.HasValue() ? 1 : 0;
+        pieces.AddScratch(&has_value, sizeof(has_value));
+        if (has_value)
+        {
+            EncodeValue(*value, pieces);
+        }
+    }
+}
+
+template <typename T>
+void EncodeElements(const T* data, size_t count, SerializationPieces& pieces)
+{
+    if constexpr (std::is_trivially_copyable_v<T>)
+    {
+        pieces.Pad(alignof(T));
+        pieces.AddExternal(data, count * sizeof(T));
+    }
+    else
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            EncodeValue(data[i], pieces);
+        }
+    }
+}
+
+template <typename T>
+SerializationPieces EncodeVector(const Vector<T>& values)
+{
+    static_assert(IsSerializable<T>::value,
+                  "elements must be trivially copyable or Vector/Optional of serializable types");
+    SerializationHeader header{};
+    header.magic = SERIALIZATION_MAGIC;
+    header.version = SERIALIZATION_VERSION;
+    header.flags = std::is_trivially_copyable_v<T> ? SERIALIZATION_CONTIGUOUS : 0;
+    header.element_size = sizeof(T);
+    header.element_alignment = alignof(T);
+    header.count = values.Size();
+
+    SerializationPieces pieces;
+    pieces.AddScratch(&header, sizeof(header));
+    EncodeElements(values.begin(), values.Size(), pieces);
+    return pieces;
+}
+
+// Последовательное чтение буфера с проверкой границ
+class SerializationReader {
+public:
+    explicit SerializationReader(Span<const char> buffer) noexcept
+        : buffer_(buffer)
+    {}
+
+    size_t Remaining() const noexcept
+    {
+        return buffer_.Size() - offset_;
+    }
+
+    void Align(size_t alignment)
+    {
+        Skip((alignment - offset_ % alignment) % alignment);
+    }
+
+    // Адрес следующих size байт, которые считаются прочитанными
+    const char* Take(size_t size)
+    {
+        if (size > Remaining())
+        {
+            throw SerializationError("serialized data is truncated");
+        }
+        const char* data = buffer_.Data() + offset_;
+        offset_ += size;
+        return data;
+    }
+
+    void Read(void* out, size_t size)
+    {
+        std::memcpy(out, Take(size), size);
+    }
+
+    void Skip(size_t size)
+    {
+        Take(size);
+    }
+
+private:
+    Span<const char> buffer_;
+    size_t offset_ = 0;
+};
+
+template <typename T>
+void DecodeElements(SerializationReader& reader, uint64_t count, Vector<T>& out);
+
+template <typename T>
+void DecodeValue(SerializationReader& reader, T& out)
+{
+    if constexpr (std::is_trivially_copyable_v<T>)
+    {
+        reader.Align(alignof(T));
+        reader.Read(&out, sizeof(T));
+    }
+    else if constexpr (IsVector<T>::value)
+    {
+        reader.Align(alignof(uint64_t));
+        uint64_t count = 0;
+        reader.Read(&count, sizeof(count));
+        DecodeElements(reader, count, out);
+    }
+    else
+    {
+        uint8_t has_value = 0;
+        reader.Read(&has_value, sizeof(has_value));
+        if (has_value > 1)
+        {
+            throw SerializationError("invalid Optional flag");
+        }
+        out.Reset();
+        if (has_value)
+        {
+            typename std::remove_reference_t<decltype(*out)> value{};
+            DecodeValue(reader, value);
+            out = std::move(value);
+        }
+    }
+}
+
+template <typename T>
+void DecodeElements(SerializationReader& reader, uint64_t count, Vector<T>& out)
+{
+    // Каждый элемент занимает хотя бы байт, поэтому count проверяется до выделения памяти
+    if (count > reader.Remaining())
+    {
+        throw SerializationError("serialized data is truncated");
+    }
+    if constexpr (std::is_trivially_copyable_v<T>)
+    {
+        reader.Align(alignof(T));
+        const char* data = reader.Take(count * sizeof(T));
+        // Память не заполняется нулями перед копированием: memcpy сам создаёт элементы
+        OwnedBuffer<T> buffer = RawMemory<T>(count).Release();
+        if (count > 0)
+        {
+            std::memcpy(buffer.data, data, count * sizeof(T));
+        }
+        buffer.size = count;
+        out = Vector<T>::Adopt(buffer);
+    }
+    else
+    {
+        out = Vector<T>();
+        out.Reserve(count);
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            T value{};
+            DecodeValue(reader, value);
+            out.PushBack(std::move(value));
+        }
+    }
+}
+
+template <typename T>
+uint64_t ReadHeader(SerializationReader& reader)
+{
+    SerializationHeader header;
+    reader.Read(&header, sizeof(header));
+    if (header.magic != SERIALIZATION_MAGIC)
+    {
+        throw SerializationError("not a serialized Vector or different byte order");
+    }
+    if (header.version != SERIALIZATION_VERSION)
+    {
+        throw SerializationError("unsupported serialization version");
+    }
+    const uint16_t flags = std::is_trivially_copyable_v<T> ? SERIALIZATION_CONTIGUOUS : 0;
+    if (header.element_size != sizeof(T) || header.element_alignment != alignof(T) || header.flags != flags)
+    {
+        throw SerializationError("serialized elements have a different type");
+    }
+    return header.count;
+}
+
+#if VECTOR_POSIX_IO
+// Записывает все фрагменты, повторяя writev после частичной записи и прерывания сигналом
+inline void WriteAll(int fd, iovec* iov, int count)
+{
+    while (count > 0)
+    {
+        const ssize_t written = ::writev(fd, iov, count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "writev");
+        }
+        size_t left = static_cast<size_t>(written);
+        while (count > 0 && left >= iov->iov_len)
+        {
+            left -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0)
+        {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+            iov->iov_len -= left;
+        }
+    }
+}
+#endif
+
+}  // namespace detail
+
+// Дописывает поток в конец out. Массивы тривиально копируемых элементов копируются memcpy
+template <typename T>
+void SerializeInto(const Vector<T>& values, Vector<char>& out)
+{
+    const detail::SerializationPieces pieces = detail::EncodeVector(values);
+    const size_t start = out.Size();
+    const size_t needed = start + pieces.Offset();
+    if (needed > out.Capacity())
+    {
+        out.Reserve(std::max(needed, 2 * out.Capacity()));
+    }
+    // Resize не перевыделяет память после Reserve, а значения тут же перезаписываются
+    out.Resize(needed);
+    char* dst = out.begin() + start;
+    pieces.ForEach([&dst](const char* data, size_t size) {
+        std::memcpy(dst, data, size);
+        dst += size;
+    });
+}
+
+template <typename T>
+void SerializeTo(const Vector<T>& values, std::ostream& out)
+{
+    const detail::SerializationPieces pieces = detail::EncodeVector(values);
+    pieces.ForEach([&out](const char* data, size_t size) {
+        out.write(data, static_cast<std::streamsize>(size));
+    });
+}
+
+#if VECTOR_POSIX_IO
+// Записывает поток в файловый дескриптор через writev, не копируя массивы элементов
+template <typename T>
+void SerializeTo(const Vector<T>& values, int fd)
+{
+#ifdef IOV_MAX
+    constexpr size_t MAX_IOV = IOV_MAX;
+#else
+    constexpr size_t MAX_IOV = 1024;
+#endif
+    const detail::SerializationPieces pieces = detail::EncodeVector(values);
+    Vector<iovec> iov;
+    pieces.ForEach([&](const char* data, size_t size) {
+        iov.PushBack(iovec{const_cast<char*>(data), size});
+    });
+    for (size_t begin = 0; begin < iov.Size(); begin += MAX_IOV)
+    {
+        const size_t count = std::min(MAX_IOV, iov.Size() - begin);
+        detail::WriteAll(fd, iov.begin() + begin, static_cast<int>(count));
+    }
+}
+#endif
+
+// Читает поток, записанный SerializeInto или SerializeTo, копируя элементы
+template <typename T>
+Vector<T> Deserialize(Span<const char> buffer)
+{
+    detail::SerializationReader reader(buffer);
+    const uint64_t count = detail::ReadHeader<T>(reader);
+    Vector<T> values;
+    detail::DecodeElements(reader, count, values);
+    return values;
+}
+
+// Элементы потока прямо в буфере, без копирования. Доступно для тривиально копируемых T;
+// буфер должен быть выровнен хотя бы по alignof(T), как память из mmap или operator new.
+// Span действителен, пока жив буфер
+template <typename T>
+Span<const T> DeserializeView(Span<const char> buffer)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "zero-copy view requires trivially copyable elements");
+    detail::SerializationReader reader(buffer);
+    const uint64_t count = detail::ReadHeader<T>(reader);
+    if (count > reader.Remaining() / sizeof(T))
+    {
+        throw SerializationError("serialized data is truncated");
+    }
+    reader.Align(alignof(T));
+    const char* data = reader.Take(count * sizeof(T));
+    if (reinterpret_cast<uintptr_t>(data) % alignof(T) != 0)
+    {
+        throw SerializationError("buffer is not aligned for zero-copy access");
+    }
+    return {std::launder(reinterpret_cast<const T*>(data)), count};
+}
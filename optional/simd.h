@@ -0,0 +1,589 @@
+#pragma once
+#include "bits.h"
+#include "optional.h"
+#include "span.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define VECTOR_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC позволяет использовать AVX2 и popcnt без отдельного атрибута
+#define VECTOR_TARGET_AVX2
+#define VECTOR_TARGET_POPCNT
+#else
+#define VECTOR_TARGET_AVX2 __attribute__((target("avx2")))
+#define VECTOR_TARGET_POPCNT __attribute__((target("popcnt")))
+#endif
+#else
+#define VECTOR_SIMD_X86 0
+#endif
+
+// Набор инструкций, которым реализованы ядра поиска и агрегации
+enum class SimdLevel {
+    SCALAR,
+    SSE2,
+    AVX2,
+};
+
+// Наилучший набор инструкций, поддерживаемый процессором. Определяется один раз через CPUID
+inline SimdLevel DetectSimdLevel() noexcept
+{
+    static const SimdLevel level = [] {
+#if VECTOR_SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] >= 7)
+        {
+            __cpuid(info, 1);
+            const bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+            __cpuidex(info, 7, 0);
+            if (os_saves_ymm && (info[1] & (1 << 5)))
+            {
+                return SimdLevel::AVX2;
+            }
+        }
+#else
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return SimdLevel::AVX2;
+        }
+#endif
+        // SSE2 входит в базовый набор x86-64
+        return SimdLevel::SSE2;
+#endif
+        return SimdLevel::SCALAR;
+    }();
+    return level;
+}
+
+// Поддержка инструкции popcnt. Она не входит в базовый набор x86-64, и без -mpopcnt
+// компилятор считает биты вызовом библиотечной функции. Определяется один раз через CPUID
+inline bool DetectPopCount() noexcept
+{
+    static const bool supported = [] {
+#if VECTOR_SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 23)) != 0;
+#else
+        return __builtin_cpu_supports("popcnt") != 0;
+#endif
+#else
+        return false;
+#endif
+    }();
+    return supported;
+}
+
+namespace detail {
+
+template <typename T>
+inline constexpr bool IS_SIMD_TYPE = std::is_same_v<T, int32_t> || std::is_same_v<T, float>;
+
+// Сумма int32_t накапливается в int64_t, чтобы избежать переполнения
+template <typename T>
+using SimdSum = std::conditional_t<std::is_same_v<T, int32_t>, int64_t, float>;
+
+// Счётчики в векторных регистрах 32-битные и сбрасываются каждые COUNT_BLOCK элементов
+inline constexpr size_t COUNT_BLOCK = size_t{1} << 24;
+
+inline SimdLevel ClampSimdLevel(SimdLevel level) noexcept
+{
+    const SimdLevel supported = DetectSimdLevel();
+    return level < supported ? level : supported;
+}
+
+namespace scalar {
+
+template <typename T>
+size_t Find(const T* data, size_t size, T value) noexcept
+{
+    size_t i = 0;
+    while (i < size && !(data[i] == value))
+    {
+        ++i;
+    }
+    return i;
+}
+
+template <typename T>
+size_t Count(const T* data, size_t size, T value) noexcept
+{
+    size_t count = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        count += data[i] == value;
+    }
+    return count;
+}
+
+template <bool IS_MAX, typename T>
+T Extreme(const T* data, size_t size) noexcept
+{
+    T result = data[0];
+    for (size_t i = 1; i < size; ++i)
+    {
+        if (IS_MAX ? result < data[i] : data[i] < result)
+        {
+            result = data[i];
+        }
+    }
+    return result;
+}
+
+template <typename T>
+SimdSum<T> Sum(const T* data, size_t size) noexcept
+{
+    SimdSum<T> sum = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        sum += data[i];
+    }
+    return sum;
+}
+
+}  // namespace scalar
+
+#if VECTOR_SIMD_X86
+namespace sse2 {
+
+inline __m128i EqualLanes(const int32_t* data, int32_t value) noexcept
+{
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    return _mm_cmpeq_epi32(chunk, _mm_set1_epi32(value));
+}
+
+inline __m128i EqualLanes(const float* data, float value) noexcept
+{
+    return _mm_castps_si128(_mm_cmpeq_ps(_mm_loadu_ps(data), _mm_set1_ps(value)));
+}
+
+template <typename T>
+size_t Find(const T* data, size_t size, T value) noexcept
+{
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        if (const int mask = _mm_movemask_ps(_mm_castsi128_ps(EqualLanes(data + i, value))))
+        {
+            return i + CountTrailingZeros(mask);
+        }
+    }
+    return i + scalar::Find(data + i, size - i, value);
+}
+
+template <typename T>
+size_t Count(const T* data, size_t size, T value) noexcept
+{
+    size_t count = 0;
+    size_t i = 0;
+    while (i + 4 <= size)
+    {
+        // Совпадение даёт в полосе -1, поэтому вычитание увеличивает счётчик
+        __m128i acc = _mm_setzero_si128();
+        const size_t block_end = std::min(size, i + COUNT_BLOCK);
+        for (; i + 4 <= block_end; i += 4)
+        {
+            acc = _mm_sub_epi32(acc, EqualLanes(data + i, value));
+        }
+        alignas(16) uint32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        count += size_t{lanes[0]} + lanes[1] + lanes[2] + lanes[3];
+    }
+    return count + scalar::Count(data + i, size - i, value);
+}
+
+// В SSE2 нет pminsd/pmaxsd, поэтому выбор делается через маску сравнения
+template <bool IS_MAX>
+__m128i Select(__m128i lhs, __m128i rhs) noexcept
+{
+    const __m128i take_rhs = IS_MAX ? _mm_cmpgt_epi32(rhs, lhs) : _mm_cmplt_epi32(rhs, lhs);
+    return _mm_or_si128(_mm_and_si128(take_rhs, rhs), _mm_andnot_si128(take_rhs, lhs));
+}
+
+template <bool IS_MAX>
+int32_t Extreme(const int32_t* data, size_t size) noexcept
+{
+    if (size < 4)
+    {
+        return scalar::Extreme<IS_MAX>(data, size);
+    }
+    __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    size_t i = 4;
+    for (; i + 4 <= size; i += 4)
+    {
+        acc = Select<IS_MAX>(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+    }
+    alignas(16) int32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    int32_t result = scalar::Extreme<IS_MAX>(lanes, 4);
+    for (; i < size; ++i)
+    {
+        result = IS_MAX ? std::max(result, data[i]) : std::min(result, data[i]);
+    }
+    return result;
+}
+
+template <bool IS_MAX>
+float Extreme(const float* data, size_t size) noexcept
+{
+    if (size < 4)
+    {
+        return scalar::Extreme<IS_MAX>(data, size);
+    }
+    __m128 acc = _mm_loadu_ps(data);
+    size_t i = 4;
+    for (; i + 4 <= size; i += 4)
+    {
+        const __m128 chunk = _mm_loadu_ps(data + i);
+        acc = IS_MAX ? _mm_max_ps(acc, chunk) : _mm_min_ps(acc, chunk);
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    float result = scalar::Extreme<IS_MAX>(lanes, 4);
+    for (; i < size; ++i)
+    {
+        result = IS_MAX ? std::max(result, data[i]) : std::min(result, data[i]);
+    }
+    return result;
+}
+
+inline int64_t Sum(const int32_t* data, size_t size) noexcept
+{
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        // Расширение до 64 бит: старшие половины заполняются знаковым битом
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i sign = _mm_srai_epi32(chunk, 31);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(chunk, sign));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(chunk, sign));
+    }
+    alignas(16) int64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return lanes[0] + lanes[1] + scalar::Sum(data + i, size - i);
+}
+
+inline float Sum(const float* data, size_t size) noexcept
+{
+    __m128 acc = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        acc = _mm_add_ps(acc, _mm_loadu_ps(data + i));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + scalar::Sum(data + i, size - i);
+}
+
+}  // namespace sse2
+
+namespace avx2 {
+
+VECTOR_TARGET_AVX2 inline __m256i EqualLanes(const int32_t* data, int32_t value) noexcept
+{
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    return _mm256_cmpeq_epi32(chunk, _mm256_set1_epi32(value));
+}
+
+VECTOR_TARGET_AVX2 inline __m256i EqualLanes(const float* data, float value) noexcept
+{
+    return _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(data), _mm256_set1_ps(value), _CMP_EQ_OQ));
+}
+
+template <typename T>
+VECTOR_TARGET_AVX2 size_t Find(const T* data, size_t size, T value) noexcept
+{
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        if (const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(EqualLanes(data + i, value))))
+        {
+            return i + CountTrailingZeros(mask);
+        }
+    }
+    return i + sse2::Find(data + i, size - i, value);
+}
+
+template <typename T>
+VECTOR_TARGET_AVX2 size_t Count(const T* data, size_t size, T value) noexcept
+{
+    size_t count = 0;
+    size_t i = 0;
+    while (i + 8 <= size)
+    {
+        __m256i acc = _mm256_setzero_si256();
+        const size_t block_end = std::min(size, i + COUNT_BLOCK);
+        for (; i + 8 <= block_end; i += 8)
+        {
+            acc = _mm256_sub_epi32(acc, EqualLanes(data + i, value));
+        }
+        alignas(32) uint32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        for (uint32_t lane : lanes)
+        {
+            count += lane;
+        }
+    }
+    return count + scalar::Count(data + i, size - i, value);
+}
+
+template <bool IS_MAX>
+VECTOR_TARGET_AVX2 int32_t Extreme(const int32_t* data, size_t size) noexcept
+{
+    if (size < 8)
+    {
+        return sse2::Extreme<IS_MAX>(data, size);
+    }
+    __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    size_t i = 8;
+    for (; i + 8 <= size; i += 8)
+    {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        acc = IS_MAX ? _mm256_max_epi32(acc, chunk) : _mm256_min_epi32(acc, chunk);
+    }
+    alignas(32) int32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    int32_t result = scalar::Extreme<IS_MAX>(lanes, 8);
+    for (; i < size; ++i)
+    {
+        result = IS_MAX ? std::max(result, data[i]) : std::min(result, data[i]);
+    }
+    return result;
+}
+
+template <bool IS_MAX>
+VECTOR_TARGET_AVX2 float Extreme(const float* data, size_t size) noexcept
+{
+    if (size < 8)
+    {
+        return sse2::Extreme<IS_MAX>(data, size);
+    }
+    __m256 acc = _mm256_loadu_ps(data);
+    size_t i = 8;
+    for (; i + 8 <= size; i += 8)
+    {
+        const __m256 chunk = _mm256_loadu_ps(data + i);
+        acc = IS_MAX ? _mm256_max_ps(acc, chunk) : _mm256_min_ps(acc, chunk);
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, acc);
+    float result = scalar::Extreme<IS_MAX>(lanes, 8);
+    for (; i < size; ++i)
+    {
+        result = IS_MAX ? std::max(result, data[i]) : std::min(result, data[i]);
+    }
+    return result;
+}
+
+VECTOR_TARGET_AVX2 inline int64_t Sum(const int32_t* data, size_t size) noexcept
+{
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(chunk)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(chunk, 1)));
+    }
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + scalar::Sum(data + i, size - i);
+}
+
+VECTOR_TARGET_AVX2 inline float Sum(const float* data, size_t size) noexcept
+{
+    // Два независимых аккумулятора скрывают задержку сложения
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(data + i));
+        acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(data + i + 8));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, _mm256_add_ps(acc0, acc1));
+    float result = 0;
+    for (float lane : lanes)
+    {
+        result += lane;
+    }
+    return result + sse2::Sum(data + i, size - i);
+}
+
+}  // namespace avx2
+#endif
+
+template <typename T>
+size_t SimdFind(const T* data, size_t size, T value, SimdLevel level) noexcept
+{
+    switch (ClampSimdLevel(level))
+    {
+#if VECTOR_SIMD_X86
+    case SimdLevel::AVX2:
+        return avx2::Find(data, size, value);
+    case SimdLevel::SSE2:
+        return sse2::Find(data, size, value);
+#endif
+    default:
+        return scalar::Find(data, size, value);
+    }
+}
+
+template <typename T>
+size_t SimdCount(const T* data, size_t size, T value, SimdLevel level) noexcept
+{
+    switch (ClampSimdLevel(level))
+    {
+#if VECTOR_SIMD_X86
+    case SimdLevel::AVX2:
+        return avx2::Count(data, size, value);
+    case SimdLevel::SSE2:
+        return sse2::Count(data, size, value);
+#endif
+    default:
+        return scalar::Count(data, size, value);
+    }
+}
+
+template <bool IS_MAX, typename T>
+T SimdExtreme(const T* data, size_t size, SimdLevel level) noexcept
+{
+    switch (ClampSimdLevel(level))
+    {
+#if VECTOR_SIMD_X86
+    case SimdLevel::AVX2:
+        return avx2::Extreme<IS_MAX>(data, size);
+    case SimdLevel::SSE2:
+        return sse2::Extreme<IS_MAX>(data, size);
+#endif
+    default:
+        return scalar::Extreme<IS_MAX>(data, size);
+    }
+}
+
+template <typename T>
+SimdSum<T> SimdSumOf(const T* data, size_t size, SimdLevel level) noexcept
+{
+    switch (ClampSimdLevel(level))
+    {
+#if VECTOR_SIMD_X86
+    case SimdLevel::AVX2:
+        return avx2::Sum(data, size);
+    case SimdLevel::SSE2:
+        return sse2::Sum(data, size);
+#endif
+    default:
+        return scalar::Sum(data, size);
+    }
+}
+
+}  // namespace detail
+
+// Векторизованные поиск и агрегаты для Vector<int32_t> и Vector<float>.
+// Набор инструкций выбирается во время выполнения; level позволяет ограничить его
+// (уровни выше поддерживаемых процессором понижаются). Значения NaN не поддерживаются
+
+template <typename T, typename = std::enable_if_t<detail::IS_SIMD_TYPE<T>>>
+typename Vector<T>::const_iterator Find(const Vector<T>& v, T value, SimdLevel level = DetectSimdLevel()) noexcept
+{
+    return v.begin() + detail::SimdFind(v.begin(), v.Size(), value, level);
+}
+
+template <typename T, typename = std::enable_if_t<detail::IS_SIMD_TYPE<T>>>
+bool Contains(const Vector<T>& v, T value, SimdLevel level = DetectSimdLevel()) noexcept
+{
+    return Find(v, value, level) != v.end();
+}
+
+template <typename T, typename = std::enable_if_t<detail::IS_SIMD_TYPE<T>>>
+size_t Count(const Vector<T>& v, T value, SimdLevel level = DetectSimdLevel()) noexcept
+{
+    return detail::SimdCount(v.begin(), v.Size(), value, level);
+}
+
+// Для пустого вектора возвращает пустой Optional
+template <typename T, typename = std::enable_if_t<detail::IS_SIMD_TYPE<T>>>
+Optional<T> Min(const Vector<T>& v, SimdLevel level = DetectSimdLevel())
+{
+    if (v.Size() == 0)
+    {
+        return {};
+    }
+    return detail::SimdExtreme<false>(v.begin(), v.Size(), level);
+}
+
+template <typename T, typename = std::enable_if_t<detail::IS_SIMD_TYPE<T>>>
+Optional<T> Max(const Vector<T>& v, SimdLevel level = DetectSimdLevel())
+{
+    if (v.Size() == 0)
+    {
+        return {};
+    }
+    return detail::SimdExtreme<true>(v.begin(), v.Size(), level);
+}
+
+// Сумма int32_t вычисляется в int64_t. Сумма float складывается в другом порядке,
+// чем при последовательном проходе, и может отличаться в последних разрядах
+template <typename T, typename = std::enable_if_t<detail::IS_SIMD_TYPE<T>>>
+detail::SimdSum<T> Sum(const Vector<T>& v, SimdLevel level = DetectSimdLevel()) noexcept
+{
+    return detail::SimdSumOf(v.begin(), v.Size(), level);
+}
+
+// Перегрузки для Span<T> и Span<const T> обрабатывают часть вектора без копирования
+
+template <typename T, typename = std::enable_if_t<detail::IS_SIMD_TYPE<std::remove_const_t<T>>>>
+T* Find(Span<T> s, std::remove_const_t<T> value, SimdLevel level = DetectSimdLevel()) noexcept
+{
+    return s.begin() + detail::SimdFind(s.Data(), s.Size(), value, level);
+}
+
+template <typename T, typename = std::enable_if_t<detail::IS_SIMD_TYPE<std::remove_const_t<T>>>>
+bool Contains(Span<T> s, std::remove_const_t<T> value, SimdLevel level = DetectSimdLevel()) noexcept
+{
+    return Find(s, value, level) != s.end();
+}
+
+template <typename T, typename = std::enable_if_t<detail::IS_SIMD_TYPE<std::remove_const_t<T>>>>
+size_t Count(Span<T> s, std::remove_const_t<T> value, SimdLevel level = DetectSimdLevel()) noexcept
+{
+    return detail::SimdCount(s.Data(), s.Size(), value, level);
+}
+
+template <typename T, typename = std::enable_if_t<detail::IS_SIMD_TYPE<std::remove_const_t<T>>>>
+Optional<std::remove_const_t<T>> Min(Span<T> s, SimdLevel level = DetectSimdLevel())
+{
+    if (s.Empty())
+    {
+        return {};
+    }
+    return detail::SimdExtreme<false>(s.Data(), s.Size(), level);
+}
+
+template <typename T, typename = std::enable_if_t<detail::IS_SIMD_TYPE<std::remove_const_t<T>>>>
+Optional<std::remove_const_t<T>> Max(Span<T> s, SimdLevel level = DetectSimdLevel())
+{
+    if (s.Empty())
+    {
+        return {};
+    }
+    return detail::SimdExtreme<true>(s.Data(), s.Size(), level);
+}
+
+template <typename T, typename = std::enable_if_t<detail::IS_SIMD_TYPE<std::remove_const_t<T>>>>
+detail::SimdSum<std::remove_const_t<T>> Sum(Span<T> s, SimdLevel level = DetectSimdLevel()) noexcept
+{
+    return detail::SimdSumOf(s.Data(), s.Size(), level);
+}
@@ -0,0 +1,248 @@
+#pragma once
+#include "vector.h"
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+// Ссылка на объект в SlotMap. Поколение позволяет отличить ссылку на удалённый
+// объект от ссылки на объект, занявший тот же слот позже
+struct SlotHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0;
+
+    bool operator==(const SlotHandle& other) const noexcept
+    {
+        return index == other.index && generation == other.generation;
+    }
+
+    bool operator!=(const SlotHandle& other) const noexcept
+    {
+        return !(*this == other);
+    }
+};
+
+// Пул объектов с доступом по SlotHandle. Вставка и удаление за O(1): свободные слоты
+// связаны в список через сами слоты. Сами объекты лежат подряд в плотном массиве, поэтому
+// обход читает память последовательно и не затрагивает свободные слоты. Erase переносит
+// последний объект на место удалённого, так что указатели из Get действительны только
+// до следующего Erase
+template <typename T>
+class SlotMap {
+    static constexpr uint32_t NO_SLOT = std::numeric_limits<uint32_t>::max();
+
+    struct Slot {
+        uint32_t generation = 0;
+        // У свободного слота - номер следующего свободного, у занятого - позиция в values_
+        uint32_t link = NO_SLOT;
+    };
+
+public:
+    template <typename Map, typename Value>
+    class BasicIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::remove_const_t<Value>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        BasicIterator() = default;
+
+        Value& operator*() const noexcept
+        {
+            return map_->values_[position_];
+        }
+
+        Value* operator->() const noexcept
+        {
+            return &**this;
+        }
+
+        // Ссылка на текущий объект
+        SlotHandle Handle() const noexcept
+        {
+            const uint32_t index = map_->owners_[position_];
+            return {index, map_->slots_[index].generation};
+        }
+
+        BasicIterator& operator++() noexcept
+        {
+            ++position_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept
+        {
+            BasicIterator copy(*this);
+            ++position_;
+            return copy;
+        }
+
+        bool operator==(const BasicIterator& other) const noexcept
+        {
+            return position_ == other.position_;
+        }
+
+        bool operator!=(const BasicIterator& other) const noexcept
+        {
+            return position_ != other.position_;
+        }
+
+    private:
+        friend class SlotMap;
+
+        BasicIterator(Map* map, size_t position) noexcept
+            : map_(map)
+            , position_(position)
+        {}
+
+        Map* map_ = nullptr;
+        size_t position_ = 0;
+    };
+
+    using iterator = BasicIterator<SlotMap, T>;
+    using const_iterator = BasicIterator<const SlotMap, const T>;
+
+    SlotMap() = default;
+
+    size_t Size() const noexcept
+    {
+        return values_.Size();
+    }
+
+    void Reserve(size_t capacity)
+    {
+        slots_.Reserve(capacity);
+        values_.Reserve(capacity);
+        owners_.Reserve(capacity);
+    }
+
+    // Аргументы могут ссылаться на объекты этого же SlotMap: рост slots_ их не затрагивает,
+    // а values_.EmplaceBack конструирует новый объект до переноса старых
+    template <typename... Args>
+    SlotHandle Emplace(Args&&... args)
+    {
+        const uint32_t index = AcquireSlot();
+        try
+        {
+            owners_.PushBack(index);
+            try
+            {
+                values_.EmplaceBack(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                owners_.PopBack();
+                throw;
+            }
+        }
+        catch (...)
+        {
+            ReleaseSlot(index);
+            throw;
+        }
+        Slot& slot = slots_[index];
+        slot.link = static_cast<uint32_t>(values_.Size() - 1);
+        return {index, slot.generation};
+    }
+
+    SlotHandle Insert(const T& value)
+    {
+        return Emplace(value);
+    }
+
+    SlotHandle Insert(T&& value)
+    {
+        return Emplace(std::move(value));
+    }
+
+    bool Contains(SlotHandle handle) const noexcept
+    {
+        // Поколение свободного слота уже увеличено, поэтому совпасть может только у занятого
+        return handle.index < slots_.Size() && slots_[handle.index].generation == handle.generation;
+    }
+
+    // Указатель на объект или nullptr, если объект по этой ссылке уже удалён
+    T* Get(SlotHandle handle) noexcept
+    {
+        return Contains(handle) ? &values_[slots_[handle.index].link] : nullptr;
+    }
+
+    const T* Get(SlotHandle handle) const noexcept
+    {
+        return const_cast<SlotMap&>(*this).Get(handle);
+    }
+
+    // Удаляет объект. Последний объект плотного массива занимает место удалённого
+    bool Erase(SlotHandle handle) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        if (!Contains(handle))
+        {
+            return false;
+        }
+        const uint32_t position = slots_[handle.index].link;
+        const size_t last = values_.Size() - 1;
+        if (position != last)
+        {
+            values_[position] = std::move(values_[last]);
+            owners_[position] = owners_[last];
+            slots_[owners_[position]].link = position;
+        }
+        values_.PopBack();
+        owners_.PopBack();
+        ReleaseSlot(handle.index);
+        return true;
+    }
+
+    iterator begin() noexcept
+    {
+        return {this, 0};
+    }
+
+    iterator end() noexcept
+    {
+        return {this, values_.Size()};
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return {this, 0};
+    }
+
+    const_iterator end() const noexcept
+    {
+        return {this, values_.Size()};
+    }
+
+private:
+    uint32_t AcquireSlot()
+    {
+        if (free_head_ != NO_SLOT)
+        {
+            const uint32_t index = free_head_;
+            free_head_ = slots_[index].link;
+            return index;
+        }
+        assert(slots_.Size() < NO_SLOT);
+        slots_.EmplaceBack();
+        return static_cast<uint32_t>(slots_.Size() - 1);
+    }
+
+    // Новое поколение делает недействительными все выданные ссылки на слот
+    void ReleaseSlot(uint32_t index) noexcept
+    {
+        Slot& slot = slots_[index];
+        ++slot.generation;
+        slot.link = free_head_;
+        free_head_ = index;
+    }
+
+    Vector<Slot> slots_;
+    // Живые объекты подряд и номера их слотов
+    Vector<T> values_;
+    Vector<uint32_t> owners_;
+    uint32_t free_head_ = NO_SLOT;
+};
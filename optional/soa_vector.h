@@ -0,0 +1,240 @@
+#pragma once
+#include "span.h"
+#include "vector.h"
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Вектор структур, хранящий каждое поле в отдельном столбце (structure of arrays).
+// Столбцы имеют общие размер и ёмкость и перевыделяются вместе
+template <typename... Ts>
+class SoAVector {
+    static_assert(sizeof...(Ts) > 0, "SoAVector requires at least one column");
+
+public:
+    // Строка доступна через кортеж ссылок на элементы столбцов
+    using Reference = std::tuple<Ts&...>;
+    using ConstReference = std::tuple<const Ts&...>;
+
+    template <size_t I>
+    using ColumnType = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    static constexpr size_t COLUMN_COUNT = sizeof...(Ts);
+
+    SoAVector() = default;
+
+    SoAVector(const SoAVector& other)
+        : columns_(RawMemory<Ts>(other.size_)...)
+    {
+        CopyColumns(other, INDICES);
+        size_ = other.size_;
+    }
+
+    SoAVector(SoAVector&& other) noexcept
+    {
+        Swap(other);
+    }
+
+    SoAVector& operator=(const SoAVector& rhs)
+    {
+        if (this != &rhs)
+        {
+            SoAVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    SoAVector& operator=(SoAVector&& rhs) noexcept
+    {
+        Swap(rhs);
+        return *this;
+    }
+
+    ~SoAVector()
+    {
+        DestroyRange(columns_, 0, size_, INDICES);
+    }
+
+    void Swap(SoAVector& other) noexcept
+    {
+        std::swap(columns_, other.columns_);
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return std::get<0>(columns_).Capacity();
+    }
+
+    void Reserve(size_t new_capacity)
+    {
+        if (new_capacity <= Capacity())
+        {
+            return;
+        }
+        Columns new_columns{RawMemory<Ts>(new_capacity)...};
+        Relocate(new_columns);
+    }
+
+    // Конструирует по одному элементу в каждом столбце: i-й аргумент идёт в i-й столбец
+    template <typename... Args>
+    Reference EmplaceBack(Args&&... args)
+    {
+        static_assert(sizeof...(Args) == sizeof...(Ts), "EmplaceBack requires one argument per column");
+        if (size_ < Capacity())
+        {
+            ConstructRow(columns_, size_, INDICES, std::forward<Args>(args)...);
+        }
+        else
+        {
+            // Новая строка создаётся до переноса старых, так как аргументы могут ссылаться на них
+            Columns new_columns{RawMemory<Ts>(size_ ? size_ * 2 : 1)...};
+            ConstructRow(new_columns, size_, INDICES, std::forward<Args>(args)...);
+            try
+            {
+                Relocate(new_columns);
+            }
+            catch (...)
+            {
+                DestroyRange(new_columns, size_, size_ + 1, INDICES);
+                throw;
+            }
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PopBack() noexcept
+    {
+        assert(size_ > 0);
+        DestroyRange(columns_, size_ - 1, size_, INDICES);
+        --size_;
+    }
+
+    Reference operator[](size_t index) noexcept
+    {
+        assert(index < size_);
+        return MakeRow<Reference>(columns_, index, INDICES);
+    }
+
+    ConstReference operator[](size_t index) const noexcept
+    {
+        assert(index < size_);
+        return MakeRow<ConstReference>(columns_, index, INDICES);
+    }
+
+    // Непрерывный столбец I, пригодный для векторизованных циклов
+    template <size_t I>
+    Span<ColumnType<I>> Column() noexcept
+    {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+    template <size_t I>
+    Span<const ColumnType<I>> Column() const noexcept
+    {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+private:
+    using Columns = std::tuple<RawMemory<Ts>...>;
+    static constexpr auto INDICES = std::index_sequence_for<Ts...>{};
+
+    template <size_t... Is>
+    static void DestroyRange(Columns& columns, size_t begin, size_t end, std::index_sequence<Is...>) noexcept
+    {
+        (std::destroy(std::get<Is>(columns) + begin, std::get<Is>(columns) + end), ...);
+    }
+
+    // Разрушает элементы строки index в первых count столбцах
+    template <size_t... Is>
+    static void DestroyRowPrefix(Columns& columns, size_t index, size_t count, std::index_sequence<Is...>) noexcept
+    {
+        ((Is < count ? std::destroy_at(std::get<Is>(columns) + index) : void()), ...);
+    }
+
+    template <size_t... Is, typename... Args>
+    static void ConstructRow(Columns& columns, size_t index, std::index_sequence<Is...>, Args&&... args)
+    {
+        size_t constructed = 0;
+        try
+        {
+            ((new (std::get<Is>(columns) + index) Ts(std::forward<Args>(args)), ++constructed), ...);
+        }
+        catch (...)
+        {
+            DestroyRowPrefix(columns, index, constructed, INDICES);
+            throw;
+        }
+    }
+
+    template <typename Row, typename Cols, size_t... Is>
+    static Row MakeRow(Cols& columns, size_t index, std::index_sequence<Is...>) noexcept
+    {
+        return Row(std::get<Is>(columns)[index]...);
+    }
+
+    // Копирует столбцы other в собственную память. При исключении скопированное разрушается
+    template <size_t... Is>
+    void CopyColumns(const SoAVector& other, std::index_sequence<Is...>)
+    {
+        size_t copied = 0;
+        try
+        {
+            ((std::uninitialized_copy_n(std::get<Is>(other.columns_).GetAddress(), other.size_,
+                                        std::get<Is>(columns_).GetAddress()), ++copied), ...);
+        }
+        catch (...)
+        {
+            ((Is < copied ? (void)std::destroy_n(std::get<Is>(columns_).GetAddress(), other.size_) : void()), ...);
+            throw;
+        }
+    }
+
+    template <size_t I>
+    void RelocateColumn(Columns& new_columns)
+    {
+        using T = ColumnType<I>;
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+        {
+            std::uninitialized_move_n(std::get<I>(columns_).GetAddress(), size_, std::get<I>(new_columns).GetAddress());
+        }
+        else
+        {
+            std::uninitialized_copy_n(std::get<I>(columns_).GetAddress(), size_, std::get<I>(new_columns).GetAddress());
+        }
+    }
+
+    // Переносит все столбцы в new_columns, как Vector::SwapData переносит свой буфер
+    void Relocate(Columns& new_columns)
+    {
+        RelocateColumns(new_columns, INDICES);
+        DestroyRange(columns_, 0, size_, INDICES);
+        columns_.swap(new_columns);
+    }
+
+    template <size_t... Is>
+    void RelocateColumns(Columns& new_columns, std::index_sequence<Is...>)
+    {
+        size_t relocated = 0;
+        try
+        {
+            ((RelocateColumn<Is>(new_columns), ++relocated), ...);
+        }
+        catch (...)
+        {
+            ((Is < relocated ? (void)std::destroy_n(std::get<Is>(new_columns).GetAddress(), size_) : void()), ...);
+            throw;
+        }
+    }
+
+    Columns columns_;
+    size_t size_ = 0;
+};
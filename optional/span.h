@@ -0,0 +1,279 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+template <typename T>
+class StridedSpan;
+
+// Невладеющее представление непрерывного диапазона элементов. Границы проверяются
+// только assert, поэтому в сборке с NDEBUG Span не дороже пары указатель и размер
+template <typename T>
+class Span {
+public:
+    using iterator = T*;
+
+    Span() = default;
+
+    Span(T* data, size_t size) noexcept
+        : data_(data)
+        , size_(size)
+    {}
+
+    // Span<T> приводится к Span<const T>
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+    Span(Span<U> other) noexcept
+        : data_(other.Data())
+        , size_(other.Size())
+    {}
+
+    iterator begin() const noexcept
+    {
+        return data_;
+    }
+
+    iterator end() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    T& operator[](size_t index) const noexcept
+    {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    T* Data() const noexcept
+    {
+        return data_;
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    bool Empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    // Первые count элементов
+    Span First(size_t count) const noexcept
+    {
+        assert(count <= size_);
+        return {data_, count};
+    }
+
+    // Последние count элементов
+    Span Last(size_t count) const noexcept
+    {
+        assert(count <= size_);
+        return {data_ + (size_ - count), count};
+    }
+
+    // Элементы начиная с offset до конца
+    Span Subspan(size_t offset) const noexcept
+    {
+        assert(offset <= size_);
+        return {data_ + offset, size_ - offset};
+    }
+
+    // count элементов начиная с offset
+    Span Subspan(size_t offset, size_t count) const noexcept
+    {
+        assert(offset <= size_ && count <= size_ - offset);
+        return {data_ + offset, count};
+    }
+
+    // Каждый step-й элемент, начиная с первого
+    StridedSpan<T> Stride(size_t step) const noexcept
+    {
+        assert(step > 0);
+        return {data_, (size_ + step - 1) / step, step};
+    }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Невладеющее представление элементов, расположенных с постоянным шагом, например
+// одного канала в перемежающемся массиве или столбца матрицы
+template <typename T>
+class StridedSpan {
+public:
+    // Итератор хранит индекс, а не указатель, чтобы end() не выходил за пределы массива
+    class iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_cv_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iterator() = default;
+
+        iterator(T* data, size_t stride, size_t index) noexcept
+            : data_(data)
+            , stride_(stride)
+            , index_(index)
+        {}
+
+        reference operator*() const noexcept
+        {
+            return data_[index_ * stride_];
+        }
+
+        pointer operator->() const noexcept
+        {
+            return &**this;
+        }
+
+        reference operator[](difference_type offset) const noexcept
+        {
+            return *(*this + offset);
+        }
+
+        iterator& operator++() noexcept
+        {
+            ++index_;
+            return *this;
+        }
+
+        iterator operator++(int) noexcept
+        {
+            iterator old(*this);
+            ++index_;
+            return old;
+        }
+
+        iterator& operator--() noexcept
+        {
+            --index_;
+            return *this;
+        }
+
+        iterator operator--(int) noexcept
+        {
+            iterator old(*this);
+            --index_;
+            return old;
+        }
+
+        iterator& operator+=(difference_type offset) noexcept
+        {
+            index_ += offset;
+            return *this;
+        }
+
+        iterator& operator-=(difference_type offset) noexcept
+        {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend iterator operator+(iterator it, difference_type offset) noexcept
+        {
+            return it += offset;
+        }
+
+        friend iterator operator+(difference_type offset, iterator it) noexcept
+        {
+            return it += offset;
+        }
+
+        friend iterator operator-(iterator it, difference_type offset) noexcept
+        {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const iterator& lhs, const iterator& rhs) noexcept
+        {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const iterator& lhs, const iterator& rhs) noexcept
+        {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const iterator& lhs, const iterator& rhs) noexcept
+        {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend bool operator<(const iterator& lhs, const iterator& rhs) noexcept
+        {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend bool operator>(const iterator& lhs, const iterator& rhs) noexcept
+        {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const iterator& lhs, const iterator& rhs) noexcept
+        {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const iterator& lhs, const iterator& rhs) noexcept
+        {
+            return !(lhs < rhs);
+        }
+
+    private:
+        T* data_ = nullptr;
+        size_t stride_ = 1;
+        size_t index_ = 0;
+    };
+
+    StridedSpan() = default;
+
+    // size - число элементов в представлении, stride - шаг между ними в элементах T
+    StridedSpan(T* data, size_t size, size_t stride) noexcept
+        : data_(data)
+        , size_(size)
+        , stride_(stride)
+    {
+        assert(stride > 0);
+    }
+
+    iterator begin() const noexcept
+    {
+        return {data_, stride_, 0};
+    }
+
+    iterator end() const noexcept
+    {
+        return {data_, stride_, size_};
+    }
+
+    T& operator[](size_t index) const noexcept
+    {
+        assert(index < size_);
+        return data_[index * stride_];
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    size_t Stride() const noexcept
+    {
+        return stride_;
+    }
+
+    bool Empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    size_t stride_ = 1;
+};
@@ -0,0 +1,302 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Хранилище StaticVector: место под N элементов прямо в объекте и число элементов.
+// Для тривиально копируемых T все специальные функции тривиальны, и StaticVector
+// можно копировать memcpy
+template <typename T, size_t N, bool TRIVIAL = std::is_trivially_copyable_v<T>>
+class StaticVectorStorage {
+protected:
+    StaticVectorStorage() = default;
+
+    StaticVectorStorage(const StaticVectorStorage& other)
+    {
+        std::uninitialized_copy_n(other.Data(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    StaticVectorStorage(StaticVectorStorage&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        std::uninitialized_move_n(other.Data(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    StaticVectorStorage& operator=(const StaticVectorStorage& rhs)
+    {
+        if (this != &rhs)
+        {
+            Assign(rhs.Data(), rhs.size_, [](const T& value) -> const T& {
+                return value;
+            });
+        }
+        return *this;
+    }
+
+    StaticVectorStorage& operator=(StaticVectorStorage&& rhs) noexcept(std::is_nothrow_move_assignable_v<T>
+                                                                       && std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this != &rhs)
+        {
+            Assign(rhs.Data(), rhs.size_, [](T& value) -> T&& {
+                return std::move(value);
+            });
+        }
+        return *this;
+    }
+
+    ~StaticVectorStorage()
+    {
+        std::destroy_n(Data(), size_);
+    }
+
+    T* Data() noexcept
+    {
+        return std::launder(reinterpret_cast<T*>(data_));
+    }
+
+    const T* Data() const noexcept
+    {
+        return std::launder(reinterpret_cast<const T*>(data_));
+    }
+
+    // alignas нужен для правильного выравнивания блока памяти
+    alignas(T) char data_[sizeof(T) * N];
+    size_t size_ = 0;
+
+private:
+    // Общие элементы присваиваются, лишние разрушаются, недостающие конструируются
+    template <typename Source, typename Forward>
+    void Assign(Source* source, size_t size, Forward forward)
+    {
+        const size_t common = std::min(size, size_);
+        for (size_t i = 0; i < common; ++i)
+        {
+            Data()[i] = forward(source[i]);
+        }
+        if (size < size_)
+        {
+            std::destroy_n(Data() + size, size_ - size);
+            size_ = size;
+        }
+        for (; size_ < size; ++size_)
+        {
+            new (Data() + size_) T(forward(source[size_]));
+        }
+    }
+};
+
+template <typename T, size_t N>
+class StaticVectorStorage<T, N, true> {
+protected:
+    T* Data() noexcept
+    {
+        return std::launder(reinterpret_cast<T*>(data_));
+    }
+
+    const T* Data() const noexcept
+    {
+        return std::launder(reinterpret_cast<const T*>(data_));
+    }
+
+    alignas(T) char data_[sizeof(T) * N];
+    size_t size_ = 0;
+};
+
+}  // namespace detail
+
+// Вектор ёмкостью не больше N элементов, которые лежат прямо в объекте. Память в куче
+// не выделяется. Операции, которым не хватает места, бросают std::length_error,
+// а TryPushBack и TryEmplaceBack в этом случае сообщают о неудаче без исключения
+template <typename T, size_t N>
+class StaticVector : private detail::StaticVectorStorage<T, N> {
+    static_assert(N > 0, "StaticVector requires a positive capacity");
+
+    using Storage = detail::StaticVectorStorage<T, N>;
+    using Storage::Data;
+    using Storage::size_;
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    StaticVector() = default;
+
+    explicit StaticVector(size_t size)
+    {
+        Resize(size);
+    }
+
+    iterator begin() noexcept
+    {
+        return Data();
+    }
+
+    iterator end() noexcept
+    {
+        return Data() + size_;
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return Data();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return Data() + size_;
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    static constexpr size_t Capacity() noexcept
+    {
+        return N;
+    }
+
+    const T& operator[](size_t index) const noexcept
+    {
+        return const_cast<StaticVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept
+    {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    void Resize(size_t new_size)
+    {
+        CheckCapacity(new_size);
+        if (new_size < size_)
+        {
+            std::destroy_n(Data() + new_size, size_ - new_size);
+        }
+        else
+        {
+            std::uninitialized_value_construct_n(Data() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args)
+    {
+        const size_t shift = pos - cbegin();
+        assert(shift <= size_);
+        CheckCapacity(size_ + 1);
+        iterator p = Data() + shift;
+        if (shift == size_)
+        {
+            new (p) T(std::forward<Args>(args)...);
+        }
+        else
+        {
+            T tmp(std::forward<Args>(args)...);
+            new (end()) T(std::move(*(end() - 1)));
+            std::move_backward(p, end() - 1, end());
+            *p = std::move(tmp);
+        }
+        ++size_;
+        return p;
+    }
+
+    iterator Insert(const_iterator pos, const T& value)
+    {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value)
+    {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Erase(const_iterator pos)
+    {
+        const size_t shift = pos - cbegin();
+        assert(shift < size_);
+        iterator p = Data() + shift;
+        std::move(p + 1, end(), p);
+        std::destroy_at(end() - 1);
+        --size_;
+        return p;
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args)
+    {
+        CheckCapacity(size_ + 1);
+        return *TryEmplaceBack(std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T& value)
+    {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value)
+    {
+        EmplaceBack(std::move(value));
+    }
+
+    // Указатель на новый элемент или nullptr, если вектор заполнен
+    template <typename... Args>
+    T* TryEmplaceBack(Args&&... args)
+    {
+        if (size_ == N)
+        {
+            return nullptr;
+        }
+        T* value = new (Data() + size_) T(std::forward<Args>(args)...);
+        ++size_;
+        return value;
+    }
+
+    // false, если вектор заполнен
+    bool TryPushBack(const T& value)
+    {
+        return TryEmplaceBack(value) != nullptr;
+    }
+
+    bool TryPushBack(T&& value)
+    {
+        return TryEmplaceBack(std::move(value)) != nullptr;
+    }
+
+    void PopBack() noexcept
+    {
+        assert(size_ > 0);
+        std::destroy_at(end() - 1);
+        --size_;
+    }
+
+private:
+    static void CheckCapacity(size_t size)
+    {
+        if (size > N)
+        {
+            throw std::length_error("StaticVector capacity exceeded");
+        }
+    }
+};
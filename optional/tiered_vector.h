@@ -0,0 +1,447 @@
+#pragma once
+#include "vector.h"
+
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Последовательность с вставкой и удалением в середине за O(sqrt(n)). Элементы лежат
+// в блоках по BLOCK_SIZE, каждый блок - кольцевой буфер в RawMemory. Все блоки, кроме
+// последнего, заполнены целиком, поэтому operator[] находит блок сдвигом. Вставка
+// сдвигает элементы только внутри своего блока, а в следующих блоках перекладывает
+// по одному элементу с конца на начало
+template <typename T, size_t BLOCK_SIZE = 1024>
+class TieredVector {
+    static_assert(BLOCK_SIZE > 1 && (BLOCK_SIZE & (BLOCK_SIZE - 1)) == 0, "BLOCK_SIZE must be a power of two");
+    static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>,
+                  "TieredVector shifts elements between blocks and requires nothrow moves");
+
+    static constexpr size_t MASK = BLOCK_SIZE - 1;
+
+    // Кольцевой буфер на BLOCK_SIZE элементов. Элементы разрушает TieredVector
+    struct Block {
+        Block()
+            : data(BLOCK_SIZE)
+        {}
+
+        T& At(size_t index) noexcept
+        {
+            return data[(head + index) & MASK];
+        }
+
+        const T& At(size_t index) const noexcept
+        {
+            return data[(head + index) & MASK];
+        }
+
+        void PushFront(T&& value) noexcept
+        {
+            head = (head - 1) & MASK;
+            new (&At(0)) T(std::move(value));
+            ++size;
+        }
+
+        void PushBack(T&& value) noexcept
+        {
+            new (&At(size)) T(std::move(value));
+            ++size;
+        }
+
+        T TakeFront() noexcept
+        {
+            T value(std::move(At(0)));
+            std::destroy_at(&At(0));
+            head = (head + 1) & MASK;
+            --size;
+            return value;
+        }
+
+        T TakeBack() noexcept
+        {
+            T value(std::move(At(size - 1)));
+            std::destroy_at(&At(size - 1));
+            --size;
+            return value;
+        }
+
+        // Сдвигает ту часть блока, которая короче
+        void InsertAt(size_t index, T&& value) noexcept
+        {
+            if (index == size)
+            {
+                PushBack(std::move(value));
+            }
+            else if (index == 0)
+            {
+                PushFront(std::move(value));
+            }
+            else if (index < size / 2)
+            {
+                head = (head - 1) & MASK;
+                new (&At(0)) T(std::move(At(1)));
+                for (size_t i = 1; i < index; ++i)
+                {
+                    At(i) = std::move(At(i + 1));
+                }
+                At(index) = std::move(value);
+                ++size;
+            }
+            else
+            {
+                new (&At(size)) T(std::move(At(size - 1)));
+                for (size_t i = size - 1; i > index; --i)
+                {
+                    At(i) = std::move(At(i - 1));
+                }
+                At(index) = std::move(value);
+                ++size;
+            }
+        }
+
+        void EraseAt(size_t index) noexcept
+        {
+            if (index < size / 2)
+            {
+                for (size_t i = index; i > 0; --i)
+                {
+                    At(i) = std::move(At(i - 1));
+                }
+                std::destroy_at(&At(0));
+                head = (head + 1) & MASK;
+            }
+            else
+            {
+                for (size_t i = index; i + 1 < size; ++i)
+                {
+                    At(i) = std::move(At(i + 1));
+                }
+                std::destroy_at(&At(size - 1));
+            }
+            --size;
+        }
+
+        RawMemory<T> data;
+        size_t head = 0;
+        size_t size = 0;
+    };
+
+public:
+    template <typename Container, typename Value>
+    class BasicIterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_const_t<Value>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        BasicIterator() = default;
+
+        // Неконстантный итератор приводится к константному
+        template <typename OtherContainer, typename OtherValue,
+                  typename = std::enable_if_t<std::is_convertible_v<OtherValue*, Value*>>>
+        BasicIterator(const BasicIterator<OtherContainer, OtherValue>& other) noexcept
+            : container_(other.container_)
+            , index_(other.index_)
+        {}
+
+        Value& operator*() const noexcept
+        {
+            return (*container_)[index_];
+        }
+
+        Value* operator->() const noexcept
+        {
+            return &**this;
+        }
+
+        Value& operator[](difference_type offset) const noexcept
+        {
+            return (*container_)[index_ + offset];
+        }
+
+        BasicIterator& operator++() noexcept
+        {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept
+        {
+            BasicIterator copy(*this);
+            ++index_;
+            return copy;
+        }
+
+        BasicIterator& operator--() noexcept
+        {
+            --index_;
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept
+        {
+            BasicIterator copy(*this);
+            --index_;
+            return copy;
+        }
+
+        BasicIterator& operator+=(difference_type offset) noexcept
+        {
+            index_ += offset;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type offset) noexcept
+        {
+            index_ -= offset;
+            return *this;
+        }
+
+        BasicIterator operator+(difference_type offset) const noexcept
+        {
+            return BasicIterator(container_, index_ + offset);
+        }
+
+        BasicIterator operator-(difference_type offset) const noexcept
+        {
+            return BasicIterator(container_, index_ - offset);
+        }
+
+        difference_type operator-(const BasicIterator& other) const noexcept
+        {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+        }
+
+        bool operator==(const BasicIterator& other) const noexcept
+        {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const BasicIterator& other) const noexcept
+        {
+            return index_ != other.index_;
+        }
+
+        bool operator<(const BasicIterator& other) const noexcept
+        {
+            return index_ < other.index_;
+        }
+
+        bool operator>(const BasicIterator& other) const noexcept
+        {
+            return index_ > other.index_;
+        }
+
+        bool operator<=(const BasicIterator& other) const noexcept
+        {
+            return index_ <= other.index_;
+        }
+
+        bool operator>=(const BasicIterator& other) const noexcept
+        {
+            return index_ >= other.index_;
+        }
+
+    private:
+        friend class TieredVector;
+        template <typename, typename>
+        friend class BasicIterator;
+
+        BasicIterator(Container* container, size_t index) noexcept
+            : container_(container)
+            , index_(index)
+        {}
+
+        Container* container_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using iterator = BasicIterator<TieredVector, T>;
+    using const_iterator = BasicIterator<const TieredVector, const T>;
+
+    TieredVector() = default;
+
+    TieredVector(const TieredVector& other)
+    {
+        for (const T& value : other)
+        {
+            PushBack(value);
+        }
+    }
+
+    TieredVector(TieredVector&& other) noexcept
+    {
+        Swap(other);
+    }
+
+    TieredVector& operator=(const TieredVector& rhs)
+    {
+        if (this != &rhs)
+        {
+            TieredVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    TieredVector& operator=(TieredVector&& rhs) noexcept
+    {
+        Swap(rhs);
+        return *this;
+    }
+
+    ~TieredVector()
+    {
+        for (Block& block : blocks_)
+        {
+            for (size_t i = 0; i < block.size; ++i)
+            {
+                std::destroy_at(&block.At(i));
+            }
+        }
+    }
+
+    void Swap(TieredVector& other) noexcept
+    {
+        blocks_.Swap(other.blocks_);
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    T& operator[](size_t index) noexcept
+    {
+        assert(index < size_);
+        return blocks_[index / BLOCK_SIZE].At(index & MASK);
+    }
+
+    const T& operator[](size_t index) const noexcept
+    {
+        assert(index < size_);
+        return blocks_[index / BLOCK_SIZE].At(index & MASK);
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args)
+    {
+        const size_t index = pos.index_;
+        assert(index <= size_);
+        // Элемент создаётся до выделения блока, так как аргументы могут ссылаться на элементы
+        T value(std::forward<Args>(args)...);
+        if (blocks_.Size() == 0 || blocks_[blocks_.Size() - 1].size == BLOCK_SIZE)
+        {
+            blocks_.EmplaceBack();
+        }
+        const size_t target = index / BLOCK_SIZE;
+        for (size_t i = blocks_.Size() - 1; i > target; --i)
+        {
+            blocks_[i].PushFront(blocks_[i - 1].TakeBack());
+        }
+        blocks_[target].InsertAt(index & MASK, std::move(value));
+        ++size_;
+        return {this, index};
+    }
+
+    iterator Insert(const_iterator pos, const T& value)
+    {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value)
+    {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Erase(const_iterator pos) noexcept
+    {
+        const size_t index = pos.index_;
+        assert(index < size_);
+        const size_t target = index / BLOCK_SIZE;
+        blocks_[target].EraseAt(index & MASK);
+        for (size_t i = target + 1; i < blocks_.Size(); ++i)
+        {
+            blocks_[i - 1].PushBack(blocks_[i].TakeFront());
+        }
+        if (blocks_[blocks_.Size() - 1].size == 0)
+        {
+            blocks_.PopBack();
+        }
+        --size_;
+        return {this, index};
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args)
+    {
+        return *Emplace(cend(), std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T& value)
+    {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value)
+    {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept
+    {
+        assert(size_ > 0);
+        Erase(cend() - 1);
+    }
+
+    iterator begin() noexcept
+    {
+        return {this, 0};
+    }
+
+    iterator end() noexcept
+    {
+        return {this, size_};
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return {this, 0};
+    }
+
+    const_iterator end() const noexcept
+    {
+        return {this, size_};
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    // Вызывает f для каждого элемента по порядку, проходя блоки целиком
+    template <typename F>
+    void ForEach(F f) const
+    {
+        for (const Block& block : blocks_)
+        {
+            for (size_t i = 0; i < block.size; ++i)
+            {
+                f(block.At(i));
+            }
+        }
+    }
+
+private:
+    Vector<Block> blocks_;
+    size_t size_ = 0;
+};
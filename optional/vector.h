@@ -1,11 +1,65 @@
 #pragma once
+#include "parallel_policy.h"
+#include "span.h"
+
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <iterator>
 #include <new>
+#include <stdexcept>
 #include <utility>
 #include <memory>
 #include <iostream>
+#include <type_traits>
+#include <vector>
+
+// Функция освобождения буфера, переданного во владение RawMemory или Vector.
+// context передаётся без изменений и позволяет освобождать память вместе с её владельцем
+using BufferDeleter = void (*)(void* buffer, void* context);
+
+// BufferDeleter для памяти, выделенной malloc, например библиотекой на C
+inline void FreeBuffer(void* buffer, void*) noexcept
+{
+    std::free(buffer);
+}
+
+// Буфер, переданный из RawMemory или Vector вместе с владением: первые size из capacity
+// элементов сконструированы, память освобождается вызовом deleter(data, context)
+template <typename T>
+struct OwnedBuffer {
+    T* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+    BufferDeleter deleter = nullptr;
+    void* context = nullptr;
+
+    // Освобождает память. Элементы к этому моменту должны быть разрушены
+    void Free() noexcept
+    {
+        if (data)
+        {
+            deleter(data, context);
+        }
+    }
+};
+
+namespace detail {
+
+// Сведения о чужом буфере, принятом RawMemory::Adopt. Хранятся в куче отдельно для
+// каждого такого буфера, чтобы обычная RawMemory не платила за них лишними полями
+struct AdoptedBuffer {
+    size_t capacity;
+    BufferDeleter deleter;
+    void* context;
+};
+
+}  // namespace detail
 
+// Сырая память под capacity элементов. Занимает два слова: у чужого буфера второе слово
+// вместо ёмкости хранит помеченный старшим битом указатель на detail::AdoptedBuffer
 template <typename T>
 class RawMemory {
 public:
@@ -30,13 +84,64 @@ public:
 
     ~RawMemory()
     {
-        Deallocate(buffer_);
+        if (IsAdopted())
+        {
+            const detail::AdoptedBuffer* adopted = GetAdopted();
+            adopted->deleter(buffer_, adopted->context);
+            delete adopted;
+        }
+        else
+        {
+            Deallocate(buffer_);
+        }
+    }
+
+    // Принимает во владение чужой буфер на capacity элементов без копирования.
+    // Сведения о deleter размещаются в куче, поэтому Adopt может бросить std::bad_alloc,
+    // и тогда буфер остаётся у вызывающего
+    static RawMemory Adopt(T* buffer, size_t capacity, BufferDeleter deleter, void* context = nullptr)
+    {
+        assert(deleter != nullptr || buffer == nullptr);
+        assert((capacity & ADOPTED) == 0);
+        RawMemory memory;
+        if (deleter == &DeleteAllocated)
+        {
+            // Память из Allocate, например отданная Release, принимается без выделений
+            memory.buffer_ = buffer;
+            memory.capacity_ = capacity;
+        }
+        else if (buffer)
+        {
+            static_assert(alignof(detail::AdoptedBuffer) > 1 && sizeof(std::uintptr_t) == sizeof(size_t));
+            const auto* adopted = new detail::AdoptedBuffer{capacity, deleter, context};
+            memory.buffer_ = buffer;
+            // Младший бит указателя всегда нулевой, поэтому сдвиг освобождает старший под признак
+            memory.capacity_ = (reinterpret_cast<std::uintptr_t>(adopted) >> 1) | ADOPTED;
+        }
+        return memory;
+    }
+
+    // Отдаёт буфер вызывающему и становится пустой. Память из Allocate возвращается
+    // с deleter, который освобождает её так же, как это сделала бы RawMemory
+    OwnedBuffer<T> Release() noexcept
+    {
+        OwnedBuffer<T> buffer{buffer_, 0, Capacity(), &DeleteAllocated, nullptr};
+        if (IsAdopted())
+        {
+            const detail::AdoptedBuffer* adopted = GetAdopted();
+            buffer.deleter = adopted->deleter;
+            buffer.context = adopted->context;
+            delete adopted;
+        }
+        buffer_ = nullptr;
+        capacity_ = 0;
+        return buffer;
     }
 
     T* operator+(size_t offset) noexcept
     {
         // Разрешается получать адрес ячейки памяти, следующей за последним элементом массива
-        assert(offset <= capacity_);
+        assert(offset <= Capacity());
         return buffer_ + offset;
     }
 
@@ -52,7 +157,7 @@ public:
 
     T& operator[](size_t index) noexcept
     {
-        assert(index < capacity_);
+        assert(index < Capacity());
         return buffer_[index];
     }
 
@@ -74,20 +179,71 @@ public:
 
     size_t Capacity() const
     {
-        return capacity_;
+        return IsAdopted() ? GetAdopted()->capacity : capacity_;
+    }
+
+    // Вся выделенная память, включая ещё не сконструированные элементы
+    Span<T> AsSpan() noexcept
+    {
+        return {buffer_, Capacity()};
+    }
+
+    Span<const T> AsSpan() const noexcept
+    {
+        return {buffer_, Capacity()};
     }
 
 private:
+    // Типы с выравниванием больше стандартного (например, выровненные по кэш-линии)
+    // требуют выровненной версии operator new
+    static constexpr bool OVER_ALIGNED = alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
     // Выделяет сырую память под n элементов и возвращает указатель на неё
     static T* Allocate(size_t n)
     {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+        if (n == 0)
+        {
+            return nullptr;
+        }
+        if constexpr (OVER_ALIGNED)
+        {
+            return static_cast<T*>(operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+        }
+        else
+        {
+            return static_cast<T*>(operator new(n * sizeof(T)));
+        }
     }
 
     // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
     static void Deallocate(T* buf) noexcept
     {
-        operator delete(buf);
+        if constexpr (OVER_ALIGNED)
+        {
+            operator delete(buf, std::align_val_t(alignof(T)));
+        }
+        else
+        {
+            operator delete(buf);
+        }
+    }
+
+    static void DeleteAllocated(void* buffer, void*) noexcept
+    {
+        Deallocate(static_cast<T*>(buffer));
+    }
+
+    // Старший бит второго слова: буфер принят Adopt и освобождается своим deleter
+    static constexpr size_t ADOPTED = ~(~size_t{0} >> 1);
+
+    bool IsAdopted() const noexcept
+    {
+        return (capacity_ & ADOPTED) != 0;
+    }
+
+    const detail::AdoptedBuffer* GetAdopted() const noexcept
+    {
+        return reinterpret_cast<const detail::AdoptedBuffer*>(static_cast<std::uintptr_t>(capacity_ << 1));
     }
 
     T* buffer_ = nullptr;
@@ -130,6 +286,17 @@ public:
         return data_.GetAddress()+size_;
     }
 
+    // Невладеющее представление элементов. Действительно, пока вектор не перевыделит память
+    Span<T> AsSpan() noexcept
+    {
+        return {data_.GetAddress(), size_};
+    }
+
+    Span<const T> AsSpan() const noexcept
+    {
+        return {data_.GetAddress(), size_};
+    }
+
     template <typename... Args>
     iterator Emplace(const_iterator pos, Args&&... args)
     {
@@ -138,7 +305,7 @@ public:
 
         if (size_<data_.Capacity())
         {
-            if (!size_)
+            if (p == end())
             {
                 new (end()) T(std::forward<Args>(args)...);
             }
@@ -213,6 +380,26 @@ public:
         std::uninitialized_copy_n(other.data_.GetAddress(), other.size_, data_.GetAddress());
     }
 
+    // Параллельные версии конструкторов: каждый поток конструирует свою часть элементов,
+    // поэтому страницы памяти впервые затрагивает тот поток, который их заполняет
+    Vector(size_t size, const ParallelPolicy& policy)
+        : data_(size)
+        , size_(size)
+    {
+        ConstructParallel(policy, [](T* dst, size_t, size_t count) {
+            std::uninitialized_value_construct_n(dst, count);
+        });
+    }
+
+    Vector(const Vector& other, const ParallelPolicy& policy)
+        : data_(other.size_)
+        , size_(other.size_)
+    {
+        ConstructParallel(policy, [&other](T* dst, size_t offset, size_t count) {
+            std::uninitialized_copy_n(other.data_.GetAddress() + offset, count, dst);
+        });
+    }
+
     Vector(Vector&& other) noexcept
     {
         Swap(other);
@@ -262,6 +449,100 @@ public:
         std::swap(this->size_, other.size_);
     }
 
+    // Принимает во владение буфер на capacity элементов, первые size из которых уже
+    // сконструированы, без копирования. Память освобождается вызовом deleter(data, context),
+    // для памяти из malloc подходит FreeBuffer. При росте элементы переносятся в собственный
+    // буфер вектора, а чужой освобождается тем же deleter. Если Adopt бросает исключение,
+    // буфер остаётся у вызывающего
+    static Vector Adopt(T* data, size_t size, size_t capacity, BufferDeleter deleter, void* context = nullptr)
+    {
+        assert(size <= capacity);
+        Vector result;
+        result.data_ = RawMemory<T>::Adopt(data, capacity, deleter, context);
+        result.size_ = size;
+        return result;
+    }
+
+    static Vector Adopt(const OwnedBuffer<T>& buffer)
+    {
+        return Adopt(buffer.data, buffer.size, buffer.capacity, buffer.deleter, buffer.context);
+    }
+
+    // Отдаёт буфер вместе с элементами, вектор становится пустым. Вызывающий отвечает
+    // за разрушение buffer.size элементов и освобождение памяти через buffer.Free()
+    OwnedBuffer<T> Release() noexcept
+    {
+        OwnedBuffer<T> buffer = data_.Release();
+        buffer.size = size_;
+        size_ = 0;
+        return buffer;
+    }
+
+    // Для тривиально разрушаемых T вектор забирает буфер std::vector без копирования:
+    // std::vector переезжает в кучу и освобождается вместе с буфером. Остальные типы
+    // перемещаются поэлементно
+    static Vector FromStdVector(std::vector<T>&& values)
+    {
+        if constexpr (std::is_trivially_destructible_v<T>)
+        {
+            if (values.capacity() == 0)
+            {
+                return {};
+            }
+            auto owner = std::make_unique<std::vector<T>>(std::move(values));
+            Vector result = Adopt(owner->data(), owner->size(), owner->capacity(), &DeleteStdVector, owner.get());
+            owner.release();
+            return result;
+        }
+        else
+        {
+            Vector result;
+            result.Reserve(values.size());
+            for (T& value : values)
+            {
+                result.PushBack(std::move(value));
+            }
+            values.clear();
+            return result;
+        }
+    }
+
+    // std::allocator не умеет принимать чужую память, поэтому без копирования возвращается
+    // только буфер, ранее взятый из std::vector, и только для тривиально копируемых T.
+    // В остальных случаях элементы перемещаются
+    std::vector<T> ToStdVector() &&
+    {
+        Vector values(std::move(*this));
+        if constexpr (std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>)
+        {
+            OwnedBuffer<T> buffer = values.Release();
+            if (buffer.deleter == &DeleteStdVector)
+            {
+                std::unique_ptr<std::vector<T>> owner(static_cast<std::vector<T>*>(buffer.context));
+                // Элементы, добавленные после FromStdVector, resize затёр бы значениями по умолчанию
+                const size_t kept = std::min(owner->size(), buffer.size);
+                const size_t tail_bytes = (buffer.size - kept) * sizeof(T);
+                std::unique_ptr<unsigned char[]> tail(new unsigned char[tail_bytes]);
+                std::memcpy(tail.get(), buffer.data + kept, tail_bytes);
+                // Ёмкости хватает, поэтому resize не перевыделяет память
+                owner->resize(buffer.size);
+                std::memcpy(owner->data() + kept, tail.get(), tail_bytes);
+                return std::move(*owner);
+            }
+            try
+            {
+                values = Adopt(buffer);
+            }
+            catch (...)
+            {
+                std::destroy_n(buffer.data, buffer.size);
+                buffer.Free();
+                throw;
+            }
+        }
+        return std::vector<T>(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+    }
+
     size_t Size() const noexcept {
         return size_;
     }
@@ -344,12 +625,71 @@ public:
         return *(data_.GetAddress()+size_ -1);
     }
 
+    // Конструирует элемент из результата factory() прямо в памяти вектора. Если factory
+    // возвращает T по значению, временный объект не создаётся и не перемещается. factory
+    // вызывается до переноса элементов, поэтому может читать текущие элементы вектора.
+    // Вектор неперемещаемых T не может расти: EmplaceBackFrom бросает std::length_error,
+    // если ёмкость, заданная Reserve пустого вектора, исчерпана
+    template <typename F>
+    T& EmplaceBackFrom(F&& factory)
+    {
+        if (size_ < data_.Capacity())
+        {
+            new (data_ + size_) T(std::forward<F>(factory)());
+        }
+        else
+        {
+            RawMemory<T> new_data(size_?size_*2:1);
+            if constexpr (!IS_RELOCATABLE)
+            {
+                if (size_ != 0)
+                {
+                    throw std::length_error("Vector of non-movable elements cannot grow");
+                }
+            }
+            new (new_data + size_) T(std::forward<F>(factory)());
+            SwapData(new_data);
+        }
+        size_++;
+        return *(data_.GetAddress()+size_ -1);
+    }
+
     void PopBack()  noexcept
     {
         std::destroy(data_.GetAddress()+size_-1, data_.GetAddress()+size_);
         size_--;
     }
 
+    // Разрушает все элементы, распределяя работу между потоками. Ёмкость сохраняется
+    void Clear(const ParallelPolicy& policy) noexcept
+    {
+        const size_t num_chunks = policy.ChunkCount(size_);
+        std::unique_ptr<bool[]> done(new (std::nothrow) bool[num_chunks]());
+        if (done)
+        {
+            try
+            {
+                detail::RunChunks(policy, size_, [&](size_t index, size_t begin, size_t end) {
+                    std::destroy_n(data_.GetAddress() + begin, end - begin);
+                    done[index] = true;
+                });
+            }
+            catch (...)
+            {
+                // Не удалось запустить потоки: оставшиеся части разрушаются в текущем
+            }
+        }
+        for (size_t i = 0; i < num_chunks; ++i)
+        {
+            if (!done || !done[i])
+            {
+                const size_t begin = detail::ChunkBegin(size_, i, num_chunks);
+                std::destroy_n(data_.GetAddress() + begin, detail::ChunkBegin(size_, i + 1, num_chunks) - begin);
+            }
+        }
+        size_ = 0;
+    }
+
     void Reserve(size_t new_capacity) {
 
         if (new_capacity <= data_.Capacity())
@@ -361,9 +701,52 @@ public:
     }
 
 private:
+    // construct(dst, offset, count) конструирует count элементов по адресу dst.
+    // При исключении уже сконструированные части разрушаются
+    template <typename Construct>
+    void ConstructParallel(const ParallelPolicy& policy, Construct construct)
+    {
+        const size_t num_chunks = policy.ChunkCount(size_);
+        std::unique_ptr<bool[]> done(new bool[num_chunks]());
+        try
+        {
+            detail::RunChunks(policy, size_, [&](size_t index, size_t begin, size_t end) {
+                construct(data_.GetAddress() + begin, begin, end - begin);
+                done[index] = true;
+            });
+        }
+        catch (...)
+        {
+            for (size_t i = 0; i < num_chunks; ++i)
+            {
+                if (done[i])
+                {
+                    const size_t begin = detail::ChunkBegin(size_, i, num_chunks);
+                    std::destroy_n(data_.GetAddress() + begin, detail::ChunkBegin(size_, i + 1, num_chunks) - begin);
+                }
+            }
+            throw;
+        }
+    }
+
+    static void DeleteStdVector(void*, void* context) noexcept
+    {
+        delete static_cast<std::vector<T>*>(context);
+    }
+
+    static constexpr bool IS_RELOCATABLE = std::is_move_constructible_v<T> || std::is_copy_constructible_v<T>;
+
     void SwapData(RawMemory<T> &new_data)
     {
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+        if constexpr (!IS_RELOCATABLE)
+        {
+            // Неперемещаемые элементы нельзя перенести: память заменяется только у пустого вектора
+            if (size_ != 0)
+            {
+                throw std::length_error("Vector of non-movable elements cannot grow");
+            }
+        }
+        else if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
         {
             std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
         }
@@ -0,0 +1,787 @@
+#pragma once
+#include "optional.h"
+#include "span.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+// Ленивые представления над диапазонами: Map, Filter, Zip, Enumerate, Take и Chunk.
+// Представление хранит только итераторы источника и функции, а элементы вычисляются
+// при обходе, поэтому цепочка представлений проходит данные один раз и не создаёт
+// промежуточных векторов. Представления не владеют элементами: вектор-источник должен
+// жить дольше представления. Функции вызываются через const-ссылку
+
+template <typename It>
+class RangeView;
+template <typename View, typename F>
+class MapView;
+template <typename View, typename Predicate>
+class FilterView;
+template <typename View1, typename View2>
+class ZipView;
+template <typename View>
+class EnumerateView;
+template <typename View>
+class TakeView;
+template <typename View>
+class ChunkView;
+
+namespace detail {
+
+struct ViewTag {};
+
+template <typename Range>
+using RemoveCvRef = std::remove_cv_t<std::remove_reference_t<Range>>;
+
+template <typename Range>
+inline constexpr bool IS_VIEW = std::is_base_of_v<ViewTag, RemoveCvRef<Range>>;
+
+template <typename Range>
+struct IsSpan : std::false_type {};
+
+template <typename T>
+struct IsSpan<Span<T>> : std::true_type {};
+
+template <typename T>
+struct IsSpan<StridedSpan<T>> : std::true_type {};
+
+// Представление над диапазоном. Временный контейнер разрушился бы раньше представления,
+// поэтому по значению принимаются только представления и Span
+template <typename Range>
+auto AsView(Range&& range)
+{
+    if constexpr (IS_VIEW<Range>)
+    {
+        return RemoveCvRef<Range>(std::forward<Range>(range));
+    }
+    else
+    {
+        static_assert(std::is_lvalue_reference_v<Range> || IsSpan<RemoveCvRef<Range>>::value,
+                      "views do not own elements, the source range must outlive them");
+        return RangeView<decltype(range.begin())>(range.begin(), range.end());
+    }
+}
+
+template <typename View>
+using ViewIterator = decltype(std::declval<const View&>().begin());
+
+template <typename It>
+using IteratorReference = decltype(*std::declval<const It&>());
+
+}  // namespace detail
+
+// Общая часть представлений: продолжение цепочки и сбор результата в Vector.
+// SizeHint() наследника возвращает точное число элементов, если его можно узнать без обхода
+template <typename Derived>
+class ViewBase : public detail::ViewTag {
+public:
+    template <typename F>
+    MapView<Derived, F> Map(F f) const
+    {
+        return {Self(), std::move(f)};
+    }
+
+    template <typename Predicate>
+    FilterView<Derived, Predicate> Filter(Predicate predicate) const
+    {
+        return {Self(), std::move(predicate)};
+    }
+
+    template <typename Range>
+    auto Zip(Range&& other) const
+    {
+        auto other_view = detail::AsView(std::forward<Range>(other));
+        return ZipView<Derived, decltype(other_view)>(Self(), std::move(other_view));
+    }
+
+    EnumerateView<Derived> Enumerate() const
+    {
+        return EnumerateView<Derived>(Self());
+    }
+
+    TakeView<Derived> Take(size_t count) const
+    {
+        return {Self(), count};
+    }
+
+    ChunkView<Derived> Chunk(size_t chunk_size) const
+    {
+        return {Self(), chunk_size};
+    }
+
+    // Дописывает элементы в конец out. Если размер известен заранее, память резервируется
+    // один раз, иначе вектор растёт как при PushBack
+    template <typename U>
+    void CollectInto(Vector<U>& out) const
+    {
+        const Derived& self = Self();
+        const Optional<size_t> hint = self.SizeHint();
+        if (hint.HasValue())
+        {
+            const size_t needed = out.Size() + *hint;
+            if (needed > out.Capacity())
+            {
+                out.Reserve(std::max(needed, 2 * out.Capacity()));
+            }
+        }
+        for (auto&& value : self)
+        {
+            out.EmplaceBack(std::forward<decltype(value)>(value));
+        }
+    }
+
+    template <typename U = void>
+    auto Collect() const
+    {
+        using Element = typename std::iterator_traits<detail::ViewIterator<Derived>>::value_type;
+        using Value = std::conditional_t<std::is_void_v<U>, Element, U>;
+        Vector<Value> out;
+        CollectInto(out);
+        return out;
+    }
+
+private:
+    const Derived& Self() const noexcept
+    {
+        return static_cast<const Derived&>(*this);
+    }
+};
+
+// Пара итераторов источника
+template <typename It>
+class RangeView : public ViewBase<RangeView<It>> {
+public:
+    using iterator = It;
+
+    RangeView() = default;
+
+    RangeView(It first, It last)
+        : first_(first)
+        , last_(last)
+    {}
+
+    It begin() const
+    {
+        return first_;
+    }
+
+    It end() const
+    {
+        return last_;
+    }
+
+    Optional<size_t> SizeHint() const
+    {
+        using Category = typename std::iterator_traits<It>::iterator_category;
+        if constexpr (std::is_base_of_v<std::random_access_iterator_tag, Category>)
+        {
+            return static_cast<size_t>(last_ - first_);
+        }
+        else
+        {
+            return {};
+        }
+    }
+
+private:
+    It first_{};
+    It last_{};
+};
+
+// f(x) для каждого элемента x
+template <typename View, typename F>
+class MapView : public ViewBase<MapView<View, F>> {
+    using Inner = detail::ViewIterator<View>;
+
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using reference = decltype(std::declval<const F&>()(std::declval<detail::IteratorReference<Inner>>()));
+        using value_type = detail::RemoveCvRef<reference>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+
+        iterator() = default;
+
+        iterator(Inner it, const F* f)
+            : it_(it)
+            , f_(f)
+        {}
+
+        reference operator*() const
+        {
+            return (*f_)(*it_);
+        }
+
+        iterator& operator++()
+        {
+            ++it_;
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator old(*this);
+            ++it_;
+            return old;
+        }
+
+        friend bool operator==(const iterator& lhs, const iterator& rhs)
+        {
+            return lhs.it_ == rhs.it_;
+        }
+
+        friend bool operator!=(const iterator& lhs, const iterator& rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        Inner it_{};
+        const F* f_ = nullptr;
+    };
+
+    MapView(View view, F f)
+        : view_(std::move(view))
+        , f_(std::move(f))
+    {}
+
+    iterator begin() const
+    {
+        return {view_.begin(), &f_};
+    }
+
+    iterator end() const
+    {
+        return {view_.end(), &f_};
+    }
+
+    Optional<size_t> SizeHint() const
+    {
+        return view_.SizeHint();
+    }
+
+private:
+    View view_;
+    F f_;
+};
+
+// Элементы, для которых predicate(x) истинно. Элемент, прошедший фильтр, читается из
+// источника дважды: для проверки и при разыменовании
+template <typename View, typename Predicate>
+class FilterView : public ViewBase<FilterView<View, Predicate>> {
+    using Inner = detail::ViewIterator<View>;
+
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using reference = detail::IteratorReference<Inner>;
+        using value_type = detail::RemoveCvRef<reference>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+
+        iterator() = default;
+
+        iterator(Inner it, Inner last, const Predicate* predicate)
+            : it_(it)
+            , last_(last)
+            , predicate_(predicate)
+        {
+            SkipRejected();
+        }
+
+        reference operator*() const
+        {
+            return *it_;
+        }
+
+        iterator& operator++()
+        {
+            ++it_;
+            SkipRejected();
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator old(*this);
+            ++*this;
+            return old;
+        }
+
+        friend bool operator==(const iterator& lhs, const iterator& rhs)
+        {
+            return lhs.it_ == rhs.it_;
+        }
+
+        friend bool operator!=(const iterator& lhs, const iterator& rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        void SkipRejected()
+        {
+            while (it_ != last_ && !(*predicate_)(*it_))
+            {
+                ++it_;
+            }
+        }
+
+        Inner it_{};
+        Inner last_{};
+        const Predicate* predicate_ = nullptr;
+    };
+
+    FilterView(View view, Predicate predicate)
+        : view_(std::move(view))
+        , predicate_(std::move(predicate))
+    {}
+
+    iterator begin() const
+    {
+        return {view_.begin(), view_.end(), &predicate_};
+    }
+
+    iterator end() const
+    {
+        return {view_.end(), view_.end(), &predicate_};
+    }
+
+    // Число элементов неизвестно до обхода
+    Optional<size_t> SizeHint() const
+    {
+        return {};
+    }
+
+private:
+    View view_;
+    Predicate predicate_;
+};
+
+// Пары соответствующих элементов двух диапазонов. Заканчивается вместе с более коротким
+template <typename View1, typename View2>
+class ZipView : public ViewBase<ZipView<View1, View2>> {
+    using Inner1 = detail::ViewIterator<View1>;
+    using Inner2 = detail::ViewIterator<View2>;
+
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using reference = std::pair<detail::IteratorReference<Inner1>, detail::IteratorReference<Inner2>>;
+        using value_type = std::pair<detail::RemoveCvRef<detail::IteratorReference<Inner1>>,
+                                     detail::RemoveCvRef<detail::IteratorReference<Inner2>>>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+
+        iterator() = default;
+
+        iterator(Inner1 it1, Inner2 it2)
+            : it1_(it1)
+            , it2_(it2)
+        {}
+
+        reference operator*() const
+        {
+            return reference(*it1_, *it2_);
+        }
+
+        iterator& operator++()
+        {
+            ++it1_;
+            ++it2_;
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator old(*this);
+            ++*this;
+            return old;
+        }
+
+        // Итератор равен концу, как только закончился любой из диапазонов
+        friend bool operator==(const iterator& lhs, const iterator& rhs)
+        {
+            return lhs.it1_ == rhs.it1_ || lhs.it2_ == rhs.it2_;
+        }
+
+        friend bool operator!=(const iterator& lhs, const iterator& rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        Inner1 it1_{};
+        Inner2 it2_{};
+    };
+
+    ZipView(View1 view1, View2 view2)
+        : view1_(std::move(view1))
+        , view2_(std::move(view2))
+    {}
+
+    iterator begin() const
+    {
+        return {view1_.begin(), view2_.begin()};
+    }
+
+    iterator end() const
+    {
+        return {view1_.end(), view2_.end()};
+    }
+
+    Optional<size_t> SizeHint() const
+    {
+        const Optional<size_t> size1 = view1_.SizeHint();
+        const Optional<size_t> size2 = view2_.SizeHint();
+        if (!size1.HasValue() || !size2.HasValue())
+        {
+            return {};
+        }
+        return std::min(*size1, *size2);
+    }
+
+private:
+    View1 view1_;
+    View2 view2_;
+};
+
+// Пары (индекс, элемент)
+template <typename View>
+class EnumerateView : public ViewBase<EnumerateView<View>> {
+    using Inner = detail::ViewIterator<View>;
+
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using reference = std::pair<size_t, detail::IteratorReference<Inner>>;
+        using value_type = std::pair<size_t, detail::RemoveCvRef<detail::IteratorReference<Inner>>>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+
+        iterator() = default;
+
+        iterator(Inner it, size_t index)
+            : it_(it)
+            , index_(index)
+        {}
+
+        reference operator*() const
+        {
+            return reference(index_, *it_);
+        }
+
+        iterator& operator++()
+        {
+            ++it_;
+            ++index_;
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator old(*this);
+            ++*this;
+            return old;
+        }
+
+        friend bool operator==(const iterator& lhs, const iterator& rhs)
+        {
+            return lhs.it_ == rhs.it_;
+        }
+
+        friend bool operator!=(const iterator& lhs, const iterator& rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        Inner it_{};
+        size_t index_ = 0;
+    };
+
+    explicit EnumerateView(View view)
+        : view_(std::move(view))
+    {}
+
+    iterator begin() const
+    {
+        return {view_.begin(), 0};
+    }
+
+    iterator end() const
+    {
+        return {view_.end(), 0};
+    }
+
+    Optional<size_t> SizeHint() const
+    {
+        return view_.SizeHint();
+    }
+
+private:
+    View view_;
+};
+
+// Не больше count первых элементов. Источник после count-го элемента не читается
+template <typename View>
+class TakeView : public ViewBase<TakeView<View>> {
+    using Inner = detail::ViewIterator<View>;
+
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using reference = detail::IteratorReference<Inner>;
+        using value_type = detail::RemoveCvRef<reference>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+
+        iterator() = default;
+
+        iterator(Inner it, Inner last, size_t remaining)
+            : it_(it)
+            , last_(last)
+            , remaining_(remaining)
+        {}
+
+        reference operator*() const
+        {
+            return *it_;
+        }
+
+        // После последнего элемента источник не сдвигается: для Filter это лишний поиск
+        iterator& operator++()
+        {
+            if (--remaining_ != 0)
+            {
+                ++it_;
+            }
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator old(*this);
+            ++*this;
+            return old;
+        }
+
+        // Итератор в конце, если взято count элементов или закончился источник.
+        // После count-го элемента it_ стоит на нём, поэтому it_ сравнивается только вне конца
+        friend bool operator==(const iterator& lhs, const iterator& rhs)
+        {
+            const bool lhs_at_end = lhs.AtEnd();
+            return lhs_at_end == rhs.AtEnd() && (lhs_at_end || lhs.it_ == rhs.it_);
+        }
+
+        friend bool operator!=(const iterator& lhs, const iterator& rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        bool AtEnd() const
+        {
+            return remaining_ == 0 || it_ == last_;
+        }
+
+        Inner it_{};
+        Inner last_{};
+        size_t remaining_ = 0;
+    };
+
+    TakeView(View view, size_t count)
+        : view_(std::move(view))
+        , count_(count)
+    {}
+
+    iterator begin() const
+    {
+        return {view_.begin(), view_.end(), count_};
+    }
+
+    iterator end() const
+    {
+        return {view_.end(), view_.end(), 0};
+    }
+
+    Optional<size_t> SizeHint() const
+    {
+        const Optional<size_t> size = view_.SizeHint();
+        if (!size.HasValue())
+        {
+            return {};
+        }
+        return std::min(*size, count_);
+    }
+
+private:
+    View view_;
+    size_t count_;
+};
+
+// Последовательные части по chunk_size элементов, последняя может быть короче.
+// Каждая часть - RangeView над итераторами источника, её элементы не копируются
+template <typename View>
+class ChunkView : public ViewBase<ChunkView<View>> {
+    using Inner = detail::ViewIterator<View>;
+
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using reference = RangeView<Inner>;
+        using value_type = RangeView<Inner>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+
+        iterator() = default;
+
+        iterator(Inner it, Inner last, size_t chunk_size)
+            : first_(it)
+            , chunk_end_(it)
+            , last_(last)
+            , chunk_size_(chunk_size)
+        {
+            FindChunkEnd();
+        }
+
+        reference operator*() const
+        {
+            return {first_, chunk_end_};
+        }
+
+        iterator& operator++()
+        {
+            first_ = chunk_end_;
+            FindChunkEnd();
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator old(*this);
+            ++*this;
+            return old;
+        }
+
+        friend bool operator==(const iterator& lhs, const iterator& rhs)
+        {
+            return lhs.first_ == rhs.first_;
+        }
+
+        friend bool operator!=(const iterator& lhs, const iterator& rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        void FindChunkEnd()
+        {
+            using Category = typename std::iterator_traits<Inner>::iterator_category;
+            if constexpr (std::is_base_of_v<std::random_access_iterator_tag, Category>)
+            {
+                chunk_end_ = first_ + std::min<std::ptrdiff_t>(chunk_size_, last_ - first_);
+            }
+            else
+            {
+                chunk_end_ = first_;
+                for (size_t i = 0; i < chunk_size_ && chunk_end_ != last_; ++i)
+                {
+                    ++chunk_end_;
+                }
+            }
+        }
+
+        Inner first_{};
+        Inner chunk_end_{};
+        Inner last_{};
+        size_t chunk_size_ = 1;
+    };
+
+    ChunkView(View view, size_t chunk_size)
+        : view_(std::move(view))
+        , chunk_size_(chunk_size)
+    {
+        assert(chunk_size > 0);
+    }
+
+    iterator begin() const
+    {
+        return {view_.begin(), view_.end(), chunk_size_};
+    }
+
+    iterator end() const
+    {
+        return {view_.end(), view_.end(), chunk_size_};
+    }
+
+    Optional<size_t> SizeHint() const
+    {
+        const Optional<size_t> size = view_.SizeHint();
+        if (!size.HasValue())
+        {
+            return {};
+        }
+        return (*size + chunk_size_ - 1) / chunk_size_;
+    }
+
+private:
+    View view_;
+    size_t chunk_size_;
+};
+
+// Начала цепочек для Vector, Span и других представлений
+
+template <typename Range>
+auto View(Range&& range)
+{
+    return detail::AsView(std::forward<Range>(range));
+}
+
+template <typename Range, typename F>
+auto Map(Range&& range, F f)
+{
+    return View(std::forward<Range>(range)).Map(std::move(f));
+}
+
+template <typename Range, typename Predicate>
+auto Filter(Range&& range, Predicate predicate)
+{
+    return View(std::forward<Range>(range)).Filter(std::move(predicate));
+}
+
+template <typename Range1, typename Range2>
+auto Zip(Range1&& range1, Range2&& range2)
+{
+    return View(std::forward<Range1>(range1)).Zip(std::forward<Range2>(range2));
+}
+
+template <typename Range>
+auto Enumerate(Range&& range)
+{
+    return View(std::forward<Range>(range)).Enumerate();
+}
+
+template <typename Range>
+auto Take(Range&& range, size_t count)
+{
+    return View(std::forward<Range>(range)).Take(count);
+}
+
+template <typename Range>
+auto Chunk(Range&& range, size_t chunk_size)
+{
+    return View(std::forward<Range>(range)).Chunk(chunk_size);
+}